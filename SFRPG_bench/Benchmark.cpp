@@ -0,0 +1,86 @@
+/////////////////////////////////////////////////////////////////////
+//
+// SFGE - Simple and Fast Game Engine
+//
+// Copyright (c) 2016-2017 DonRumata710 
+// 
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation
+// files (the "Software"), to deal in the Software without
+// restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+// WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+// 
+/////////////////////////////////////////////////////////////////////
+
+
+#include "Benchmark.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+
+void Benchmark::setParameter (const std::string& name, double value)
+{
+    m_parameters.emplace_back (name, value);
+}
+
+const std::vector<Benchmark::Result>& Benchmark::getResults () const
+{
+    return m_results;
+}
+
+void Benchmark::write (std::ostream& stream) const
+{
+    stream << "{\n    \"parameters\": {";
+    for (size_t i = 0; i < m_parameters.size (); ++i)
+        stream << (i ? ",\n" : "\n") << "        \"" << m_parameters[i].first << "\": " << m_parameters[i].second;
+    stream << "\n    },\n    \"results\": [";
+
+    for (size_t i = 0; i < m_results.size (); ++i)
+    {
+        const Result& result (m_results[i]);
+
+        std::vector<double> sorted (result.samples);
+        std::sort (sorted.begin (), sorted.end ());
+        double mean (sorted.empty () ? 0.0 : std::accumulate (sorted.begin (), sorted.end (), 0.0) / sorted.size ());
+
+        stream << (i ? ",\n" : "\n") << "        {"
+            << " \"name\": \"" << result.name << "\","
+            << " \"size\": " << result.size << ","
+            << " \"unit\": \"ns\","
+            << " \"samples\": " << sorted.size () << ","
+            << " \"min\": " << getPercentile (sorted, 0.0) << ","
+            << " \"mean\": " << mean << ","
+            << " \"p50\": " << getPercentile (sorted, 50.0) << ","
+            << " \"p90\": " << getPercentile (sorted, 90.0) << ","
+            << " \"p99\": " << getPercentile (sorted, 99.0) << ","
+            << " \"max\": " << getPercentile (sorted, 100.0) << " }";
+    }
+
+    stream << "\n    ]\n}\n";
+}
+
+double Benchmark::getPercentile (const std::vector<double>& sorted, double percent)
+{
+    if (sorted.empty ())
+        return 0.0;
+
+    // Nearest rank, so every reported value is a real sample
+    size_t rank (static_cast<size_t> (std::ceil (percent / 100.0 * sorted.size ())));
+    return sorted[std::min (std::max<size_t> (rank, 1), sorted.size ()) - 1];
+}
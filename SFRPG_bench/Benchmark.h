@@ -0,0 +1,113 @@
+/////////////////////////////////////////////////////////////////////
+//
+// SFGE - Simple and Fast Game Engine
+//
+// Copyright (c) 2016-2017 DonRumata710 
+// 
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation
+// files (the "Software"), to deal in the Software without
+// restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+// WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+// 
+/////////////////////////////////////////////////////////////////////
+
+
+#pragma once
+
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+/////////////////////////////////////////////////////////////////////
+/// Benchmark - collect timings of operations and write them as JSON
+///
+/// Every sample is time of one call of measured function divided by
+/// number of operations made by this call, so results are stored in
+/// nanoseconds per operation.
+/////////////////////////////////////////////////////////////////////
+class Benchmark
+{
+public:
+    struct Result
+    {
+        std::string name;
+        uint32_t size;
+        std::vector<double> samples;
+    };
+
+    /////////////////////////////////////////////////////////////////////
+    /// setParameter - add parameter of run to output
+    ///
+    /// @param name - name of parameter
+    /// @param value - value of parameter
+    /////////////////////////////////////////////////////////////////////
+    void setParameter (const std::string& name, double value);
+
+    /////////////////////////////////////////////////////////////////////
+    /// measure - time function
+    ///
+    /// Function is called once without timing to warm caches up.
+    ///
+    /// @param name - name of benchmark
+    /// @param size - size of synthetic sector
+    /// @param samples - number of timed calls
+    /// @param operations - number of operations made by one call
+    /// @param function - measured function
+    /////////////////////////////////////////////////////////////////////
+    template<typename Function> void measure (const std::string& name, uint32_t size, size_t samples, size_t operations, Function function)
+    {
+        Result result { name, size, {} };
+        result.samples.reserve (samples);
+
+        function ();
+
+        for (size_t i = 0; i < samples; ++i)
+        {
+            auto start (std::chrono::steady_clock::now ());
+            function ();
+            auto end (std::chrono::steady_clock::now ());
+
+            double time (std::chrono::duration<double, std::nano> (end - start).count ());
+            result.samples.push_back (time / std::max<size_t> (operations, 1));
+        }
+
+        m_results.push_back (std::move (result));
+    }
+
+    const std::vector<Result>& getResults () const;
+
+    /////////////////////////////////////////////////////////////////////
+    /// write - write parameters and percentiles of all results as JSON
+    ///
+    /// @param stream - output stream
+    /////////////////////////////////////////////////////////////////////
+    void write (std::ostream& stream) const;
+
+private:
+    static double getPercentile (const std::vector<double>& sorted, double percent);
+
+private:
+    std::vector<std::pair<std::string, double>> m_parameters;
+    std::vector<Result> m_results;
+};
@@ -0,0 +1,242 @@
+/////////////////////////////////////////////////////////////////////
+//
+// SFGE - Simple and Fast Game Engine
+//
+// Copyright (c) 2016-2017 DonRumata710 
+// 
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation
+// files (the "Software"), to deal in the Software without
+// restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+// WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+// 
+/////////////////////////////////////////////////////////////////////
+
+
+#include "Benchmark.h"
+#include "SyntheticMap.h"
+
+#include <SFRPG/MapManager.h>
+#include <SFRPG/Way.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+
+using namespace sfge;
+
+
+namespace
+{
+
+    struct Options
+    {
+        std::vector<uint32_t> sizes { 64, 128, 256 };
+        float way_point_density = 0.01f;
+        float obstacle_density = 0.005f;
+        size_t samples = 30;
+        size_t queries = 200;
+        uint32_t seed = 1;
+        std::string output;
+    };
+
+    const size_t COLLISION_PAIRS = 1024;
+
+    const size_t POINT_QUERIES = 1024;
+
+    void printUsage ()
+    {
+        std::cerr <<
+            "Usage: SFRPG_bench [options]\n"
+            "  --sizes 64,128,256         sizes of synthetic sector side\n"
+            "  --waypoint-density 0.01    way points per square unit\n"
+            "  --obstacle-density 0.005   obstacles per square unit\n"
+            "  --samples 30               timed runs of every benchmark\n"
+            "  --queries 200              searched ways for every size\n"
+            "  --seed 1                   seed of synthetic maps\n"
+            "  --output file.json         write results to file instead of stdout\n";
+    }
+
+    bool parseOptions (int argc, char* argv[], Options& options)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            std::string name (argv[i]);
+            if (name == "--help" || i + 1 >= argc)
+                return false;
+
+            std::string value (argv[++i]);
+            try
+            {
+                if (name == "--sizes")
+                {
+                    options.sizes.clear ();
+                    std::istringstream stream (value);
+                    std::string size;
+                    while (std::getline (stream, size, ','))
+                        options.sizes.push_back (std::stoul (size));
+                }
+                else if (name == "--waypoint-density")
+                    options.way_point_density = std::stof (value);
+                else if (name == "--obstacle-density")
+                    options.obstacle_density = std::stof (value);
+                else if (name == "--samples")
+                    options.samples = std::stoul (value);
+                else if (name == "--queries")
+                    options.queries = std::stoul (value);
+                else if (name == "--seed")
+                    options.seed = std::stoul (value);
+                else if (name == "--output")
+                    options.output = value;
+                else
+                    return false;
+            }
+            catch (const std::logic_error&)
+            {
+                return false;
+            }
+        }
+
+        return !options.sizes.empty () && options.samples > 0;
+    }
+
+    void benchmarkCollision (Benchmark& benchmark, SyntheticMap& generator, uint32_t size, size_t samples)
+    {
+        // Pairs are placed near each other, so every kind of rejection and
+        // precise check is met
+        std::vector<std::pair<Collision, Collision>> pairs;
+        for (size_t i = 0; i < COLLISION_PAIRS; ++i)
+        {
+            Vector2f center (generator.getPoint (float (size), float (size)));
+            Vector2f shift (generator.getPoint (8.0f, 8.0f) - Vector2f (4.0f, 4.0f));
+            pairs.emplace_back (generator.createObstacle (center), generator.createObstacle (center + shift));
+        }
+
+        size_t overlaps (0);
+        benchmark.measure ("Collision::check", size, samples, pairs.size (), [&]()
+        {
+            for (const auto& pair : pairs)
+            {
+                if (pair.first.check (pair.second) != Collision::State::OUTSIDE)
+                    ++overlaps;
+            }
+        });
+
+        // Result is used, so checks aren't removed by optimizer
+        if (overlaps == SIZE_MAX)
+            std::cerr << overlaps;
+    }
+
+    void benchmarkSector (Benchmark& benchmark, SyntheticMap& generator, uint32_t size, size_t samples)
+    {
+        std::unique_ptr<MapSector> sector (generator.createSector (size));
+
+        benchmark.measure ("MapSector::connectWayPoints", size, samples, 1, [&]()
+        {
+            sector->connectWayPoints ();
+        });
+
+        std::vector<Vector2f> points;
+        for (size_t i = 0; i < POINT_QUERIES; ++i)
+            points.push_back (generator.getPoint (float (size), float (size)));
+
+        uint64_t sum (0);
+        benchmark.measure ("MapSector::getNearestWayPoint", size, samples, points.size (), [&]()
+        {
+            for (Vector2f point : points)
+                sum += sector->getNearestWayPoint (point);
+        });
+
+        if (sum == UINT64_MAX)
+            std::cerr << sum;
+    }
+
+    void benchmarkWay (Benchmark& benchmark, SyntheticMap& generator, uint32_t size, size_t queries)
+    {
+        if (queries == 0)
+            return;
+
+        // Map of 2x2 sectors, so ways cross borders of sectors
+        MapManager map;
+        map.setMapDescription (generator.createMap (size, 2, 2));
+        map.getPathCache ().setCapacity (0);
+
+        std::vector<std::pair<Vector2f, Vector2f>> pairs;
+        for (size_t i = 0; i < queries; ++i)
+            pairs.emplace_back (generator.getPoint (2.0f * size, 2.0f * size), generator.getPoint (2.0f * size, 2.0f * size));
+
+        // Every sample is one query, so percentiles show spread of queries
+        size_t query (0);
+        std::vector<bool> found (pairs.size ());
+        benchmark.measure ("MapManager::getWay", size, queries, 1, [&]()
+        {
+            size_t id (query++ % pairs.size ());
+            found[id] = map.getWay (pairs[id].first, pairs[id].second).getPoints () != 0;
+        });
+
+        benchmark.setParameter ("found_ways_" + std::to_string (size), double (std::count (found.begin (), found.end (), true)));
+    }
+
+}
+
+
+int main (int argc, char* argv[])
+{
+    Options options;
+    if (!parseOptions (argc, argv, options))
+    {
+        printUsage ();
+        return 1;
+    }
+
+    Benchmark benchmark;
+    benchmark.setParameter ("waypoint_density", options.way_point_density);
+    benchmark.setParameter ("obstacle_density", options.obstacle_density);
+    benchmark.setParameter ("samples", double (options.samples));
+    benchmark.setParameter ("queries", double (options.queries));
+    benchmark.setParameter ("seed", double (options.seed));
+
+    for (uint32_t size : options.sizes)
+    {
+        std::cerr << "Size " << size << std::endl;
+
+        SyntheticMap generator (options.way_point_density, options.obstacle_density, options.seed);
+        benchmarkCollision (benchmark, generator, size, options.samples);
+        benchmarkSector (benchmark, generator, size, options.samples);
+        benchmarkWay (benchmark, generator, size, options.queries);
+    }
+
+    if (options.output.empty ())
+    {
+        benchmark.write (std::cout);
+    }
+    else
+    {
+        std::ofstream file (options.output);
+        if (!file)
+        {
+            std::cerr << "Can't open " << options.output << std::endl;
+            return 1;
+        }
+        benchmark.write (file);
+    }
+
+    return 0;
+}
@@ -0,0 +1,149 @@
+/////////////////////////////////////////////////////////////////////
+//
+// SFGE - Simple and Fast Game Engine
+//
+// Copyright (c) 2016-2017 DonRumata710 
+// 
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation
+// files (the "Software"), to deal in the Software without
+// restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+// WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+// 
+/////////////////////////////////////////////////////////////////////
+
+
+#include "SyntheticMap.h"
+
+#include <SFRPG/StaticObject.h>
+
+#include <algorithm>
+#include <cmath>
+
+
+using namespace sfge;
+
+
+namespace
+{
+
+    const float PI = 3.14159265f;
+
+    const float MIN_OBSTACLE_RADIUS = 0.5f;
+
+    const float MAX_OBSTACLE_RADIUS = 2.0f;
+
+}
+
+
+SyntheticMap::SyntheticMap (float way_point_density, float obstacle_density, uint32_t seed) :
+    m_way_point_density (way_point_density),
+    m_obstacle_density (obstacle_density),
+    m_random (seed)
+{}
+
+std::unique_ptr<MapSector> SyntheticMap::createSector (uint32_t size)
+{
+    std::unique_ptr<MapSector> sector (new MapSector (Vector2u (size, size)));
+
+    size_t obstacles (static_cast<size_t> (m_obstacle_density * size * size));
+    std::vector<Collision> collisions;
+    collisions.reserve (obstacles);
+
+    for (size_t i = 0; i < obstacles; ++i)
+    {
+        std::shared_ptr<MapObject> object (new StaticObject ());
+        collisions.push_back (createObstacle (getPoint (float (size), float (size))));
+        object->setCollision (collisions.back ());
+        sector->attachObject (object);
+    }
+
+    // Radius of way point covers the whole cell of grid
+    std::vector<WayPoint> way_points;
+    if (m_way_point_density > 0.0f)
+    {
+        float spacing (1.0f / std::sqrt (m_way_point_density));
+        for (float y = spacing / 2; y < size; y += spacing)
+        {
+            for (float x = spacing / 2; x < size; x += spacing)
+            {
+                Vector2f position (
+                    std::min (std::max (x + getUniform (-0.25f, 0.25f) * spacing, 0.0f), float (size)),
+                    std::min (std::max (y + getUniform (-0.25f, 0.25f) * spacing, 0.0f), float (size))
+                );
+
+                auto is_inside = [&position](const Collision& collision) { return collision.check (position) == Collision::State::INSIDE; };
+                if (std::any_of (collisions.begin (), collisions.end (), is_inside))
+                    continue;
+
+                way_points.emplace_back ();
+                way_points.back ().setPosition (position);
+                way_points.back ().setRadius (spacing);
+            }
+        }
+    }
+
+    sector->setWayPoints (std::move (way_points));
+    return sector;
+}
+
+std::unordered_map<uint32_t, MapSectorDesc> SyntheticMap::createMap (uint32_t size, uint32_t columns, uint32_t rows)
+{
+    std::unordered_map<uint32_t, MapSectorDesc> sectors;
+
+    for (uint32_t row = 0; row < rows; ++row)
+    {
+        for (uint32_t column = 0; column < columns; ++column)
+        {
+            MapSectorDesc& desc (sectors[row * columns + column]);
+            desc.pos = { column * size, row * size };
+            desc.size = { size, size };
+            desc.sector = createSector (size);
+        }
+    }
+
+    return sectors;
+}
+
+Collision SyntheticMap::createObstacle (Vector2f center)
+{
+    // Points on circle in order of angles always form convex polygon
+    std::uniform_int_distribution<size_t> vertices (3, 8);
+    std::vector<float> angles (vertices (m_random));
+    for (float& angle : angles)
+        angle = getUniform (0.0f, 2 * PI);
+    std::sort (angles.begin (), angles.end ());
+
+    float radius (getUniform (MIN_OBSTACLE_RADIUS, MAX_OBSTACLE_RADIUS));
+    Circuit points;
+    for (float angle : angles)
+        points.emplace_back (radius * std::cos (angle), radius * std::sin (angle));
+
+    Collision collision (points);
+    collision.setPosition (center);
+    return collision;
+}
+
+Vector2f SyntheticMap::getPoint (float width, float height)
+{
+    return Vector2f (getUniform (0.0f, width), getUniform (0.0f, height));
+}
+
+float SyntheticMap::getUniform (float min, float max)
+{
+    return std::uniform_real_distribution<float> (min, max) (m_random);
+}
@@ -0,0 +1,108 @@
+/////////////////////////////////////////////////////////////////////
+//
+// SFGE - Simple and Fast Game Engine
+//
+// Copyright (c) 2016-2017 DonRumata710 
+// 
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation
+// files (the "Software"), to deal in the Software without
+// restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+// WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+// 
+/////////////////////////////////////////////////////////////////////
+
+
+#pragma once
+
+
+#include <SFRPG/Collision.h>
+#include <SFRPG/MapSectorDesc.h>
+
+#include <memory>
+#include <random>
+#include <unordered_map>
+
+
+/////////////////////////////////////////////////////////////////////
+/// SyntheticMap - generator of random sectors for benchmarks
+///
+/// Obstacles are random convex polygons. Way points are placed on
+/// jittered grid outside of obstacles, so their areas cover the sector.
+/// The same seed always gives the same map.
+/////////////////////////////////////////////////////////////////////
+class SyntheticMap
+{
+public:
+    /////////////////////////////////////////////////////////////////////
+    /// Constructor
+    ///
+    /// @param way_point_density - way points per square unit
+    /// @param obstacle_density - obstacles per square unit
+    /// @param seed - seed of random generator
+    /////////////////////////////////////////////////////////////////////
+    SyntheticMap (float way_point_density, float obstacle_density, uint32_t seed);
+
+    /////////////////////////////////////////////////////////////////////
+    /// createSector - generate sector with obstacles and way points
+    ///
+    /// Way points aren't connected.
+    ///
+    /// @param size - size of sector side
+    ///
+    /// @return - sector in local coordinates
+    /////////////////////////////////////////////////////////////////////
+    std::unique_ptr<sfge::MapSector> createSector (uint32_t size);
+
+    /////////////////////////////////////////////////////////////////////
+    /// createMap - generate grid of sectors
+    ///
+    /// @param size - size of sector side
+    /// @param columns - number of sectors along x
+    /// @param rows - number of sectors along y
+    ///
+    /// @return - description of map for map manager
+    /////////////////////////////////////////////////////////////////////
+    std::unordered_map<uint32_t, sfge::MapSectorDesc> createMap (uint32_t size, uint32_t columns, uint32_t rows);
+
+    /////////////////////////////////////////////////////////////////////
+    /// createObstacle - generate convex polygon
+    ///
+    /// @param center - center of polygon
+    ///
+    /// @return - polygon with 3 to 8 vertices
+    /////////////////////////////////////////////////////////////////////
+    sfge::Collision createObstacle (sfge::Vector2f center);
+
+    /////////////////////////////////////////////////////////////////////
+    /// getPoint - get random point in rectangle
+    ///
+    /// @param width - width of rectangle at origin
+    /// @param height - height of rectangle at origin
+    ///
+    /// @return - point
+    /////////////////////////////////////////////////////////////////////
+    sfge::Vector2f getPoint (float width, float height);
+
+private:
+    float getUniform (float min, float max);
+
+private:
+    float m_way_point_density;
+    float m_obstacle_density;
+    std::mt19937 m_random;
+};
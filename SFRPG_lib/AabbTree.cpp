@@ -0,0 +1,460 @@
+/////////////////////////////////////////////////////////////////////
+//
+// SFGE - Simple and Fast Game Engine
+//
+// Copyright (c) 2016-2017 DonRumata710 
+// 
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation
+// files (the "Software"), to deal in the Software without
+// restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+// WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+// 
+/////////////////////////////////////////////////////////////////////
+
+
+#include "AabbTree.h"
+
+#include <SFGE/Err.h>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+
+using namespace sfge;
+
+
+const uint32_t AabbTree::NULL_NODE;
+
+
+AabbTree::AabbTree (float margin, float prediction) :
+    m_margin (margin),
+    m_prediction (prediction)
+{}
+
+void AabbTree::clear ()
+{
+    m_nodes.clear ();
+    m_root = NULL_NODE;
+    m_free = NULL_NODE;
+    m_size = 0;
+}
+
+uint32_t AabbTree::insert (const FloatRect& bounds, void* data)
+{
+    uint32_t proxy (allocateNode ());
+    Node& node (m_nodes[proxy]);
+    node.bounds = bounds;
+    node.fat_bounds = getFatBounds (bounds, Vector2f ());
+    node.data = data;
+    node.height = 0;
+
+    insertLeaf (proxy);
+    ++m_size;
+
+    return proxy;
+}
+
+void AabbTree::remove (uint32_t proxy)
+{
+    if (proxy >= m_nodes.size () || !m_nodes[proxy].isLeaf () || m_nodes[proxy].height < 0)
+        critical_error ("Wrong proxy of AABB tree", std::out_of_range);
+
+    removeLeaf (proxy);
+    freeNode (proxy);
+    --m_size;
+}
+
+bool AabbTree::move (uint32_t proxy, const FloatRect& bounds)
+{
+    Node& node (m_nodes[proxy]);
+
+    Vector2f displacement (
+        bounds.left + bounds.width / 2 - node.bounds.left - node.bounds.width / 2,
+        bounds.top + bounds.height / 2 - node.bounds.top - node.bounds.height / 2
+    );
+    node.bounds = bounds;
+
+    if (contains (node.fat_bounds, bounds))
+        return false;
+
+    removeLeaf (proxy);
+    m_nodes[proxy].fat_bounds = getFatBounds (bounds, displacement);
+    insertLeaf (proxy);
+
+    return true;
+}
+
+void* AabbTree::getData (uint32_t proxy) const
+{
+    return m_nodes[proxy].data;
+}
+
+const FloatRect& AabbTree::getFatBounds (uint32_t proxy) const
+{
+    return m_nodes[proxy].fat_bounds;
+}
+
+const FloatRect& AabbTree::getBounds (uint32_t proxy) const
+{
+    return m_nodes[proxy].bounds;
+}
+
+size_t AabbTree::getSize () const
+{
+    return m_size;
+}
+
+uint32_t AabbTree::getHeight () const
+{
+    return m_root == NULL_NODE ? 0 : uint32_t (m_nodes[m_root].height);
+}
+
+void AabbTree::query (const FloatRect& rect, std::vector<uint32_t>& proxies) const
+{
+    proxies.clear ();
+    if (m_root == NULL_NODE)
+        return;
+
+    std::vector<uint32_t> stack;
+    stack.reserve (64);
+    stack.push_back (m_root);
+
+    while (!stack.empty ())
+    {
+        uint32_t id (stack.back ());
+        const Node& node (m_nodes[id]);
+        stack.pop_back ();
+
+        if (!overlap (node.fat_bounds, rect))
+            continue;
+
+        if (node.isLeaf ())
+        {
+            proxies.push_back (id);
+        }
+        else
+        {
+            stack.push_back (node.left);
+            stack.push_back (node.right);
+        }
+    }
+}
+
+void AabbTree::raycast (Vector2f p1, Vector2f p2, const std::function<float (uint32_t, float)>& callback) const
+{
+    if (m_root == NULL_NODE)
+        return;
+
+    Vector2f segment (p2 - p1);
+    float max_fraction (1.0f);
+
+    // Slab test of segment from p1 to p1 + segment * max_fraction
+    auto is_crossed = [&](const FloatRect& rect)
+    {
+        float t_min (0.0f);
+        float t_max (max_fraction);
+
+        const float starts[] = { p1.x, p1.y };
+        const float directions[] = { segment.x, segment.y };
+        const float mins[] = { rect.left, rect.top };
+        const float maxs[] = { rect.left + rect.width, rect.top + rect.height };
+
+        for (int axis = 0; axis < 2; ++axis)
+        {
+            if (directions[axis] == 0.0f)
+            {
+                if (starts[axis] < mins[axis] || starts[axis] > maxs[axis])
+                    return false;
+                continue;
+            }
+
+            float t1 ((mins[axis] - starts[axis]) / directions[axis]);
+            float t2 ((maxs[axis] - starts[axis]) / directions[axis]);
+            if (t1 > t2)
+                std::swap (t1, t2);
+
+            t_min = std::max (t_min, t1);
+            t_max = std::min (t_max, t2);
+            if (t_min > t_max)
+                return false;
+        }
+
+        return true;
+    };
+
+    std::vector<uint32_t> stack;
+    stack.reserve (64);
+    stack.push_back (m_root);
+
+    while (!stack.empty ())
+    {
+        uint32_t id (stack.back ());
+        const Node& node (m_nodes[id]);
+        stack.pop_back ();
+
+        if (!is_crossed (node.fat_bounds))
+            continue;
+
+        if (node.isLeaf ())
+        {
+            float fraction (callback (id, max_fraction));
+            if (fraction <= 0.0f)
+                return;
+
+            max_fraction = std::min (max_fraction, fraction);
+        }
+        else
+        {
+            stack.push_back (node.left);
+            stack.push_back (node.right);
+        }
+    }
+}
+
+uint32_t AabbTree::allocateNode ()
+{
+    if (m_free == NULL_NODE)
+    {
+        m_nodes.emplace_back ();
+        return uint32_t (m_nodes.size () - 1);
+    }
+
+    uint32_t id (m_free);
+    m_free = m_nodes[id].parent;
+    m_nodes[id] = Node ();
+    return id;
+}
+
+void AabbTree::freeNode (uint32_t id)
+{
+    m_nodes[id] = Node ();
+    m_nodes[id].parent = m_free;
+    m_free = id;
+}
+
+void AabbTree::insertLeaf (uint32_t leaf)
+{
+    if (m_root == NULL_NODE)
+    {
+        m_root = leaf;
+        m_nodes[leaf].parent = NULL_NODE;
+        return;
+    }
+
+    // Find the best sibling: descend while cost of pushing leaf down is
+    // smaller than cost of new parent at the current level
+    FloatRect leaf_bounds (m_nodes[leaf].fat_bounds);
+    uint32_t index (m_root);
+    while (!m_nodes[index].isLeaf ())
+    {
+        const Node& node (m_nodes[index]);
+
+        float area (getPerimeter (node.fat_bounds));
+        float combined_area (getPerimeter (combine (node.fat_bounds, leaf_bounds)));
+
+        float cost (2.0f * combined_area);
+        float inheritance_cost (2.0f * (combined_area - area));
+
+        auto get_child_cost = [&](uint32_t child)
+        {
+            const Node& child_node (m_nodes[child]);
+            float child_area (getPerimeter (combine (leaf_bounds, child_node.fat_bounds)));
+            if (!child_node.isLeaf ())
+                child_area -= getPerimeter (child_node.fat_bounds);
+            return child_area + inheritance_cost;
+        };
+
+        float left_cost (get_child_cost (node.left));
+        float right_cost (get_child_cost (node.right));
+
+        if (cost < left_cost && cost < right_cost)
+            break;
+
+        index = left_cost < right_cost ? node.left : node.right;
+    }
+
+    uint32_t sibling (index);
+    uint32_t old_parent (m_nodes[sibling].parent);
+    uint32_t new_parent (allocateNode ());
+
+    m_nodes[new_parent].parent = old_parent;
+    m_nodes[new_parent].fat_bounds = combine (leaf_bounds, m_nodes[sibling].fat_bounds);
+    m_nodes[new_parent].height = m_nodes[sibling].height + 1;
+    m_nodes[new_parent].left = sibling;
+    m_nodes[new_parent].right = leaf;
+    m_nodes[sibling].parent = new_parent;
+    m_nodes[leaf].parent = new_parent;
+
+    if (old_parent == NULL_NODE)
+    {
+        m_root = new_parent;
+    }
+    else
+    {
+        if (m_nodes[old_parent].left == sibling)
+            m_nodes[old_parent].left = new_parent;
+        else
+            m_nodes[old_parent].right = new_parent;
+    }
+
+    refit (m_nodes[leaf].parent);
+}
+
+void AabbTree::removeLeaf (uint32_t leaf)
+{
+    if (leaf == m_root)
+    {
+        m_root = NULL_NODE;
+        return;
+    }
+
+    uint32_t parent (m_nodes[leaf].parent);
+    uint32_t grand_parent (m_nodes[parent].parent);
+    uint32_t sibling (m_nodes[parent].left == leaf ? m_nodes[parent].right : m_nodes[parent].left);
+
+    freeNode (parent);
+
+    if (grand_parent == NULL_NODE)
+    {
+        m_root = sibling;
+        m_nodes[sibling].parent = NULL_NODE;
+        return;
+    }
+
+    if (m_nodes[grand_parent].left == parent)
+        m_nodes[grand_parent].left = sibling;
+    else
+        m_nodes[grand_parent].right = sibling;
+    m_nodes[sibling].parent = grand_parent;
+
+    refit (grand_parent);
+}
+
+void AabbTree::refit (uint32_t id)
+{
+    // Bounds and heights of ancestors are fixed up to the root
+    while (id != NULL_NODE)
+    {
+        id = balance (id);
+
+        Node& node (m_nodes[id]);
+        const Node& left (m_nodes[node.left]);
+        const Node& right (m_nodes[node.right]);
+
+        node.height = 1 + std::max (left.height, right.height);
+        node.fat_bounds = combine (left.fat_bounds, right.fat_bounds);
+
+        id = node.parent;
+    }
+}
+
+uint32_t AabbTree::balance (uint32_t a)
+{
+    Node& node_a (m_nodes[a]);
+    if (node_a.isLeaf () || node_a.height < 2)
+        return a;
+
+    uint32_t b (node_a.left);
+    uint32_t c (node_a.right);
+    int32_t difference (m_nodes[c].height - m_nodes[b].height);
+
+    if (difference >= -1 && difference <= 1)
+        return a;
+
+    // Higher child is rotated up and takes place of node
+    uint32_t up (difference > 1 ? c : b);
+    uint32_t down (difference > 1 ? b : c);
+
+    Node& node_up (m_nodes[up]);
+    uint32_t f (node_up.left);
+    uint32_t g (node_up.right);
+
+    node_up.left = a;
+    node_up.parent = node_a.parent;
+    node_a.parent = up;
+
+    if (node_up.parent == NULL_NODE)
+        m_root = up;
+    else if (m_nodes[node_up.parent].left == a)
+        m_nodes[node_up.parent].left = up;
+    else
+        m_nodes[node_up.parent].right = up;
+
+    // The higher grandchild stays in rotated node, the lower one goes to node
+    uint32_t high (m_nodes[f].height > m_nodes[g].height ? f : g);
+    uint32_t low (high == f ? g : f);
+
+    node_up.right = high;
+    node_a.left = down;
+    node_a.right = low;
+    m_nodes[low].parent = a;
+
+    node_a.fat_bounds = combine (m_nodes[down].fat_bounds, m_nodes[low].fat_bounds);
+    node_a.height = 1 + std::max (m_nodes[down].height, m_nodes[low].height);
+
+    node_up.fat_bounds = combine (node_a.fat_bounds, m_nodes[high].fat_bounds);
+    node_up.height = 1 + std::max (node_a.height, m_nodes[high].height);
+
+    return up;
+}
+
+FloatRect AabbTree::getFatBounds (const FloatRect& bounds, Vector2f displacement) const
+{
+    FloatRect fat (bounds.left - m_margin, bounds.top - m_margin, bounds.width + 2 * m_margin, bounds.height + 2 * m_margin);
+
+    Vector2f prediction (displacement * m_prediction);
+    if (prediction.x < 0.0f)
+        fat.left += prediction.x;
+    fat.width += std::abs (prediction.x);
+
+    if (prediction.y < 0.0f)
+        fat.top += prediction.y;
+    fat.height += std::abs (prediction.y);
+
+    return fat;
+}
+
+FloatRect AabbTree::combine (const FloatRect& first, const FloatRect& second)
+{
+    float left (std::min (first.left, second.left));
+    float top (std::min (first.top, second.top));
+    float right (std::max (first.left + first.width, second.left + second.width));
+    float bottom (std::max (first.top + first.height, second.top + second.height));
+
+    return FloatRect (left, top, right - left, bottom - top);
+}
+
+float AabbTree::getPerimeter (const FloatRect& rect)
+{
+    return 2.0f * (rect.width + rect.height);
+}
+
+bool AabbTree::contains (const FloatRect& outer, const FloatRect& inner)
+{
+    return outer.left <= inner.left && outer.top <= inner.top &&
+        inner.left + inner.width <= outer.left + outer.width &&
+        inner.top + inner.height <= outer.top + outer.height;
+}
+
+bool AabbTree::overlap (const FloatRect& first, const FloatRect& second)
+{
+    // Touching rectangles overlap, so objects with zero size are found too
+    return first.left <= second.left + second.width && second.left <= first.left + first.width &&
+        first.top <= second.top + second.height && second.top <= first.top + first.height;
+}
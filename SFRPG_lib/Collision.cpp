@@ -27,20 +27,182 @@
 /////////////////////////////////////////////////////////////////////
 
 
+
 #include "Collision.h"
+#include "CollisionKernels.h"
 
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
 #include <cstring>
+#include <cstdint>
 
 
 using namespace sfge;
 
 
-const float EPSILON = 1e-4f;
+namespace
+{
+
+    float cross (Point o, Point a, Point b)
+    {
+        return (a.x - o.x) * (b.y - o.y) - (a.y - o.y) * (b.x - o.x);
+    }
+
+    float getArea (const Circuit& points)
+    {
+        float area (0.0f);
+        for (size_t i = 0; i < points.size (); ++i)
+        {
+            const Point& a (points[i]);
+            const Point& b (points[(i + 1) % points.size ()]);
+            area += a.x * b.y - b.x * a.y;
+        }
+        return area / 2.0f;
+    }
+
+    bool isConvex (const Circuit& points)
+    {
+        bool positive (false);
+        bool negative (false);
+
+        for (size_t i = 0; i < points.size (); ++i)
+        {
+            float turn (cross (points[i], points[(i + 1) % points.size ()], points[(i + 2) % points.size ()]));
+            positive = positive || turn > 0.0f;
+            negative = negative || turn < 0.0f;
+        }
+
+        return !(positive && negative);
+    }
+
+    bool isConvex (const Circuit& points, const std::vector<uint32_t>& polygon)
+    {
+        for (size_t i = 0; i < polygon.size (); ++i)
+        {
+            Point a (points[polygon[i]]);
+            Point b (points[polygon[(i + 1) % polygon.size ()]]);
+            Point c (points[polygon[(i + 2) % polygon.size ()]]);
+
+            if (cross (a, b, c) < 0.0f)
+                return false;
+        }
+
+        return true;
+    }
+
+    bool isInsideTriangle (Point p, Point a, Point b, Point c)
+    {
+        return cross (a, b, p) >= 0.0f && cross (b, c, p) >= 0.0f && cross (c, a, p) >= 0.0f;
+    }
+
+    // Split counter-clockwise polygon into triangles by ear clipping
+    void triangulate (const Circuit& points, std::vector<std::vector<uint32_t>>& polygons)
+    {
+        std::vector<uint32_t> indices (points.size ());
+        for (uint32_t i = 0; i < indices.size (); ++i)
+            indices[i] = i;
+
+        while (indices.size () > 3)
+        {
+            size_t ear (0);
+            bool found (false);
+
+            for (size_t i = 0; i < indices.size () && !found; ++i)
+            {
+                uint32_t prev (indices[(i + indices.size () - 1) % indices.size ()]);
+                uint32_t cur (indices[i]);
+                uint32_t next (indices[(i + 1) % indices.size ()]);
+
+                if (cross (points[prev], points[cur], points[next]) <= 0.0f)
+                    continue;
+
+                found = true;
+                for (uint32_t other : indices)
+                {
+                    if (other == prev || other == cur || other == next)
+                        continue;
+
+                    if (isInsideTriangle (points[other], points[prev], points[cur], points[next]))
+                    {
+                        found = false;
+                        break;
+                    }
+                }
+
+                ear = i;
+            }
+
+            // Self-intersecting polygon may have no ears, then any vertex is clipped
+            if (!found)
+                ear = 0;
+
+            polygons.push_back ({
+                indices[(ear + indices.size () - 1) % indices.size ()],
+                indices[ear],
+                indices[(ear + 1) % indices.size ()]
+            });
+            indices.erase (indices.begin () + ear);
+        }
+
+        polygons.push_back (indices);
+    }
+
+    // Merge neighbour parts while result stays convex (Hertel-Mehlhorn)
+    void mergeParts (const Circuit& points, std::vector<std::vector<uint32_t>>& polygons)
+    {
+        bool merged (true);
+        while (merged)
+        {
+            merged = false;
+
+            for (size_t i = 0; i < polygons.size () && !merged; ++i)
+            {
+                for (size_t j = i + 1; j < polygons.size () && !merged; ++j)
+                {
+                    const std::vector<uint32_t>& first (polygons[i]);
+                    const std::vector<uint32_t>& second (polygons[j]);
+
+                    // Find edge (u, v) of the first part which is edge (v, u) of the second one
+                    for (size_t k = 0; k < first.size () && !merged; ++k)
+                    {
+                        uint32_t u (first[k]);
+                        uint32_t v (first[(k + 1) % first.size ()]);
+
+                        for (size_t l = 0; l < second.size (); ++l)
+                        {
+                            if (second[l] != v || second[(l + 1) % second.size ()] != u)
+                                continue;
+
+                            std::vector<uint32_t> polygon;
+                            for (size_t m = 0; m < first.size (); ++m)
+                                polygon.push_back (first[(k + 1 + m) % first.size ()]);
+                            for (size_t m = 2; m < second.size (); ++m)
+                                polygon.push_back (second[(l + m) % second.size ()]);
+
+                            if (isConvex (points, polygon))
+                            {
+                                polygons[i].swap (polygon);
+                                polygons.erase (polygons.begin () + j);
+                                merged = true;
+                            }
+                            break;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+}
 
 
 Collision::Collision (const Circuit& _points) :
     m_points (_points)
-{}
+{
+    updateBounds ();
+    updatePolygons ();
+}
 
 Collision::~Collision ()
 {}
@@ -63,23 +225,43 @@ Point sfge::Collision::getPosition () const
 void Collision::setPoints (const Circuit& new_points)
 {
     m_points.assign (new_points.begin (), new_points.end ());
+    updateBounds ();
+    updatePolygons ();
+}
+
+const Circuit& Collision::getPoints () const
+{
+    return m_points;
+}
+
+FloatRect Collision::getBounds () const
+{
+    return FloatRect (m_min.x + m_position.x, m_min.y + m_position.y, m_max.x - m_min.x, m_max.y - m_min.y);
+}
+
+Point Collision::getCenter () const
+{
+    return m_center + m_position;
+}
+
+float Collision::getRadius () const
+{
+    return m_radius;
 }
 
 Collision::State Collision::check (const Collision& collision) const
 {
-    for (int i = 0; i < m_points.size (); ++i)
-    {
-        auto a_point (m_points[i] + m_position);
-        auto b_point ((i == 0 ? *m_points.rbegin () : m_points[i - 1]) + m_position);
+    if (m_points.empty () || collision.m_points.empty () || !overlapBounds (collision) || !overlapParts (collision))
+        return State::OUTSIDE;
 
-        for (int i = 0; i < collision.m_points.size (); ++i)
-        {
-            auto c_point (collision.m_points[i] + collision.m_position);
-            auto d_point ((i == 0 ? *collision.m_points.rbegin () : collision.m_points[i - 1]) + collision.m_position);
+    const Polygon& boundary (collision.m_boundary);
+    for (size_t i = 0; i + 1 < boundary.xs.size (); ++i)
+    {
+        Point c (boundary.xs[i] + collision.m_position.x, boundary.ys[i] + collision.m_position.y);
+        Point d (boundary.xs[i + 1] + collision.m_position.x, boundary.ys[i + 1] + collision.m_position.y);
 
-            if (!segmentCollision (a_point, b_point, c_point, d_point))
-                return State::INTERSECTION;
-        }
+        if (crossEdges (c, d))
+            return State::INTERSECTION;
     }
 
     return isPointInside (collision.m_points[0] + collision.m_position) ? State::INSIDE : State::OUTSIDE;
@@ -87,50 +269,411 @@ Collision::State Collision::check (const Collision& collision) const
 
 Collision::State Collision::check (const Point p1, const Point p2) const
 {
-    for (int i = 0; i < m_points.size (); ++i)
-    {
-        if (!segmentCollision (m_points[i], (i == m_points.size () - 1) ? m_points[0] : m_points[i + 1], p1, p2))
-            return State::INTERSECTION;
-    }
+    if (m_points.empty ())
+        return State::OUTSIDE;
+
+    Point min (m_min + m_position);
+    Point max (m_max + m_position);
+
+    if (std::max (p1.x, p2.x) < min.x || std::min (p1.x, p2.x) > max.x ||
+        std::max (p1.y, p2.y) < min.y || std::min (p1.y, p2.y) > max.y)
+        return State::OUTSIDE;
+
+    // Distance from center of bounding circle to the closest point of segment
+    Point center (getCenter ());
+    Vector2f segment (p2 - p1);
+    float length (segment.x * segment.x + segment.y * segment.y);
+    float t (length > 0.0f ? ((center.x - p1.x) * segment.x + (center.y - p1.y) * segment.y) / length : 0.0f);
+    Vector2f dist (p1 + segment * std::min (std::max (t, 0.0f), 1.0f) - center);
+    float radius (m_radius + COLLISION_EPSILON);
 
-    return State::OUTSIDE;
+    if (dist.x * dist.x + dist.y * dist.y > radius * radius)
+        return State::OUTSIDE;
+
+    return crossEdges (p1, p2) ? State::INTERSECTION : State::OUTSIDE;
 }
 
 Collision::State Collision::check (const Point point) const
 {
+    if (m_points.empty ())
+        return State::OUTSIDE;
+
+    Point min (m_min + m_position);
+    Point max (m_max + m_position);
+
+    if (point.x < min.x || point.x > max.x || point.y < min.y || point.y > max.y)
+        return State::OUTSIDE;
+
     return isPointInside (point) ? State::INSIDE : State::OUTSIDE;
 }
 
-bool Collision::segmentCollision (const Point a, const Point b, const Point c, const Point d) const
+float Collision::getDistance (const Point point) const
+{
+    if (m_points.empty ())
+        return FLT_MAX;
+
+    if (check (point) == State::INSIDE)
+        return 0.0f;
+
+    Point local (point - m_position);
+    float min_distance (FLT_MAX);
+
+    for (size_t i = 0; i + 1 < m_boundary.xs.size (); ++i)
+    {
+        Point a (m_boundary.xs[i], m_boundary.ys[i]);
+        Vector2f edge (m_boundary.xs[i + 1] - a.x, m_boundary.ys[i + 1] - a.y);
+
+        float length (edge.x * edge.x + edge.y * edge.y);
+        float t (length > 0.0f ? ((local.x - a.x) * edge.x + (local.y - a.y) * edge.y) / length : 0.0f);
+        Vector2f dist (a + edge * std::min (std::max (t, 0.0f), 1.0f) - local);
+
+        min_distance = std::min (min_distance, dist.x * dist.x + dist.y * dist.y);
+    }
+
+    return std::sqrt (min_distance);
+}
+
+bool Collision::raycast (const Point p1, const Point p2, float& fraction) const
 {
-    float side_a (sign (a, c, d));
-    float side_b (sign (b, c, d));
+    if (m_points.empty ())
+        return false;
 
-    float side_c (sign (c, a, b));
-    float side_d (sign (d, a, b));
+    Point min (m_min + m_position);
+    Point max (m_max + m_position);
 
-    if (((side_a < -EPSILON && side_b > EPSILON) || (side_a > EPSILON && side_b < -EPSILON)) &&
-        ((side_c < -EPSILON && side_d > EPSILON) || (side_c > EPSILON && side_d < -EPSILON))
-    )
+    if (std::max (p1.x, p2.x) < min.x || std::min (p1.x, p2.x) > max.x ||
+        std::max (p1.y, p2.y) < min.y || std::min (p1.y, p2.y) > max.y)
         return false;
-    
+
+    if (isPointInside (p1))
+    {
+        fraction = 0.0f;
+        return true;
+    }
+
+    Point start (p1 - m_position);
+    Vector2f direction (p2 - p1);
+    float min_fraction (FLT_MAX);
+
+    for (size_t i = 0; i + 1 < m_boundary.xs.size (); ++i)
+    {
+        Point a (m_boundary.xs[i], m_boundary.ys[i]);
+        Vector2f edge (m_boundary.xs[i + 1] - a.x, m_boundary.ys[i + 1] - a.y);
+
+        // Parallel edges are touched at their ends by neighbour edges
+        float denominator (direction.x * edge.y - direction.y * edge.x);
+        if (std::abs (denominator) < COLLISION_EPSILON * COLLISION_EPSILON)
+            continue;
+
+        Vector2f to_edge (a - start);
+        float t ((to_edge.x * edge.y - to_edge.y * edge.x) / denominator);
+        float u ((to_edge.x * direction.y - to_edge.y * direction.x) / denominator);
+
+        if (t >= 0.0f && t <= 1.0f && u >= 0.0f && u <= 1.0f)
+            min_fraction = std::min (min_fraction, t);
+    }
+
+    if (min_fraction == FLT_MAX)
+        return false;
+
+    fraction = min_fraction;
     return true;
 }
 
-bool sfge::Collision::isPointInside (Point p) const
+bool Collision::sweep (const Collision& collision, Vector2f vector, float& time, Vector2f& normal) const
+{
+    if (m_points.empty () || collision.m_points.empty ())
+        return false;
+
+    // Swept bounds are rejected first
+    Point min (m_min + m_position + Vector2f (std::min (vector.x, 0.0f), std::min (vector.y, 0.0f)));
+    Point max (m_max + m_position + Vector2f (std::max (vector.x, 0.0f), std::max (vector.y, 0.0f)));
+    Point other_min (collision.m_min + collision.m_position);
+    Point other_max (collision.m_max + collision.m_position);
+
+    if (max.x + COLLISION_SKIN < other_min.x || min.x - COLLISION_SKIN > other_max.x ||
+        max.y + COLLISION_SKIN < other_min.y || min.y - COLLISION_SKIN > other_max.y)
+        return false;
+
+    Vector2f offset (collision.m_position - m_position);
+    bool hit (false);
+    time = 1.0f;
+
+    for (const Polygon& part : m_parts)
+    {
+        for (const Polygon& other : collision.m_parts)
+        {
+            float part_time;
+            Vector2f part_normal;
+            if (sweepPart (part, other, offset, vector, part_time, part_normal) && part_time <= time)
+            {
+                time = part_time;
+                normal = part_normal;
+                hit = true;
+            }
+        }
+    }
+
+    return hit;
+}
+
+void Collision::updateBounds ()
+{
+    m_min = Point ();
+    m_max = Point ();
+    m_center = Point ();
+    m_radius = 0.0f;
+
+    if (m_points.empty ())
+        return;
+
+    m_min = m_points[0];
+    m_max = m_points[0];
+
+    for (const Point& point : m_points)
+    {
+        m_min.x = std::min (m_min.x, point.x);
+        m_min.y = std::min (m_min.y, point.y);
+        m_max.x = std::max (m_max.x, point.x);
+        m_max.y = std::max (m_max.y, point.y);
+    }
+
+    m_center = (m_min + m_max) / 2.0f;
+
+    for (const Point& point : m_points)
+    {
+        Vector2f dist (point - m_center);
+        m_radius = std::max (m_radius, std::sqrt (dist.x * dist.x + dist.y * dist.y));
+    }
+}
+
+void Collision::updatePolygons ()
+{
+    m_parts.clear ();
+    setPolygon (m_points, m_boundary);
+
+    if (m_points.empty ())
+        return;
+
+    if (m_points.size () < 4 || isConvex (m_points))
+    {
+        m_parts.push_back (m_boundary);
+        return;
+    }
+
+    Circuit points (m_points);
+    if (getArea (points) < 0.0f)
+        std::reverse (points.begin (), points.end ());
+
+    std::vector<std::vector<uint32_t>> polygons;
+    triangulate (points, polygons);
+    mergeParts (points, polygons);
+
+    m_parts.resize (polygons.size ());
+    for (size_t i = 0; i < polygons.size (); ++i)
+    {
+        Circuit part;
+        for (uint32_t index : polygons[i])
+            part.push_back (points[index]);
+        setPolygon (part, m_parts[i]);
+    }
+}
+
+void Collision::setPolygon (const Circuit& points, Polygon& polygon)
+{
+    polygon.xs.clear ();
+    polygon.ys.clear ();
+    polygon.normal_xs.clear ();
+    polygon.normal_ys.clear ();
+
+    for (size_t i = 0; i < points.size (); ++i)
+    {
+        const Point& a (points[i]);
+        const Point& b (points[(i + 1) % points.size ()]);
+
+        polygon.xs.push_back (a.x);
+        polygon.ys.push_back (a.y);
+        polygon.normal_xs.push_back (a.y - b.y);
+        polygon.normal_ys.push_back (b.x - a.x);
+    }
+
+    if (!points.empty ())
+    {
+        polygon.xs.push_back (points[0].x);
+        polygon.ys.push_back (points[0].y);
+    }
+}
+
+bool Collision::overlapBounds (const Collision& collision) const
+{
+    // Touching shapes are passed to precise check
+    Point min (m_min + m_position);
+    Point max (m_max + m_position);
+    Point other_min (collision.m_min + collision.m_position);
+    Point other_max (collision.m_max + collision.m_position);
+
+    if (max.x < other_min.x || min.x > other_max.x || max.y < other_min.y || min.y > other_max.y)
+        return false;
+
+    Vector2f dist (getCenter () - collision.getCenter ());
+    float radius (m_radius + collision.m_radius + COLLISION_EPSILON);
+
+    return dist.x * dist.x + dist.y * dist.y <= radius * radius;
+}
+
+bool Collision::overlapParts (const Collision& collision) const
+{
+    // Parts of other polygon are projected in local coordinates of this one
+    Vector2f offset (collision.m_position - m_position);
+
+    auto is_separated = [&offset](const Polygon& first, const Polygon& second, const Polygon& axes)
+    {
+        size_t first_count (first.normal_xs.size ());
+        size_t second_count (second.normal_xs.size ());
+
+        for (size_t i = 0; i < axes.normal_xs.size (); ++i)
+        {
+            float axis_x (axes.normal_xs[i]);
+            float axis_y (axes.normal_ys[i]);
+            float shift (offset.x * axis_x + offset.y * axis_y);
+
+            float first_min, first_max;
+            float second_min, second_max;
+            project (first.xs.data (), first.ys.data (), first_count, axis_x, axis_y, first_min, first_max);
+            project (second.xs.data (), second.ys.data (), second_count, axis_x, axis_y, second_min, second_max);
+
+            if (first_max < second_min + shift || second_max + shift < first_min)
+                return true;
+        }
+
+        return false;
+    };
+
+    for (const Polygon& part : m_parts)
+    {
+        for (const Polygon& other : collision.m_parts)
+        {
+            if (!is_separated (part, other, part) && !is_separated (part, other, other))
+                return true;
+        }
+    }
+
+    return false;
+}
+
+bool Collision::sweepPart (const Polygon& part, const Polygon& other, Vector2f offset, Vector2f vector, float& time, Vector2f& normal) const
 {
-    bool flag (sign (p, *m_points.rbegin () + m_position, m_points[0] + m_position) < 0.0f);
+    // Minkowski difference of convex parts is bounded by edges of both of
+    // them, so intervals of overlap along their normals give exact time
+    // of impact
+    float enter_time (-FLT_MAX);
+    float exit_time (FLT_MAX);
+    Vector2f enter_normal;
+
+    float min_depth (FLT_MAX);
+    Vector2f depth_normal;
+
+    auto test_axes = [&](const Polygon& axes)
+    {
+        for (size_t i = 0; i < axes.normal_xs.size (); ++i)
+        {
+            float length (std::sqrt (axes.normal_xs[i] * axes.normal_xs[i] + axes.normal_ys[i] * axes.normal_ys[i]));
+            if (length == 0.0f)
+                continue;
+
+            Vector2f axis (axes.normal_xs[i] / length, axes.normal_ys[i] / length);
+
+            float part_min, part_max;
+            float other_min, other_max;
+            project (part.xs.data (), part.ys.data (), part.normal_xs.size (), axis.x, axis.y, part_min, part_max);
+            project (other.xs.data (), other.ys.data (), other.normal_xs.size (), axis.x, axis.y, other_min, other_max);
+
+            float shift (offset.x * axis.x + offset.y * axis.y);
+            other_min += shift - COLLISION_SKIN;
+            other_max += shift + COLLISION_SKIN;
+
+            // Projections overlap while low < speed * t < high
+            float low (other_min - part_max);
+            float high (other_max - part_min);
+            float speed (vector.x * axis.x + vector.y * axis.y);
+
+            if (high <= 0.0f || low >= 0.0f)
+            {
+                if (std::abs (speed) < FLT_EPSILON)
+                    return false;
+            }
+            else
+            {
+                // Polygons which overlap now are pushed out along the axis
+                // of the smallest depth
+                float depth (std::min (-low, high));
+                if (depth < min_depth)
+                {
+                    min_depth = depth;
+                    depth_normal = -low < high ? -axis : axis;
+                }
+
+                if (std::abs (speed) < FLT_EPSILON)
+                    continue;
+            }
+
+            float t1 (low / speed);
+            float t2 (high / speed);
+            if (t1 > t2)
+                std::swap (t1, t2);
+
+            if (t1 > enter_time)
+            {
+                enter_time = t1;
+                enter_normal = speed > 0.0f ? -axis : axis;
+            }
+
+            exit_time = std::min (exit_time, t2);
+            if (enter_time >= exit_time)
+                return false;
+        }
+
+        return true;
+    };
 
-    for (size_t i = 0; i < m_points.size () - 1; ++i)
+    if (!test_axes (part) || !test_axes (other))
+        return false;
+
+    if (enter_time > 1.0f || exit_time <= 0.0f)
+        return false;
+
+    if (enter_time >= 0.0f)
     {
-        if (flag != sign (p, m_points[i] + m_position, m_points[i + 1] + m_position) < 0.0f)
-            return false;
+        time = enter_time;
+        normal = enter_normal;
+        return true;
     }
 
+    // Parts overlap before movement: only movement to deeper position is
+    // blocked, so sliding along obstacle and leaving it are allowed
+    float length (std::sqrt (vector.x * vector.x + vector.y * vector.y));
+    if (vector.x * depth_normal.x + vector.y * depth_normal.y >= -COLLISION_EPSILON * length)
+        return false;
+
+    time = 0.0f;
+    normal = depth_normal;
     return true;
 }
 
-float Collision::sign (Point p1, Point p2, Point p3)
+bool Collision::crossEdges (Point p1, Point p2) const
 {
-    return (p1.x - p3.x) * (p2.y - p3.y) - (p1.y - p3.y) * (p2.x - p3.x);
+    return crossSegment (m_boundary.xs.data (), m_boundary.ys.data (), m_boundary.normal_xs.size (), m_position, p1, p2);
+}
+
+bool Collision::isPointInside (Point p) const
+{
+    Point local (p - m_position);
+
+    for (const Polygon& part : m_parts)
+    {
+        if (isInsideConvex (part.xs.data (), part.ys.data (), part.normal_xs.data (), part.normal_ys.data (), part.normal_xs.size (), local))
+            return true;
+    }
+
+    return false;
 }
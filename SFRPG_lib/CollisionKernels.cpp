@@ -0,0 +1,194 @@
+/////////////////////////////////////////////////////////////////////
+//
+// SFGE - Simple and Fast Game Engine
+//
+// Copyright (c) 2016-2017 DonRumata710 
+// 
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation
+// files (the "Software"), to deal in the Software without
+// restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+// WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+// 
+/////////////////////////////////////////////////////////////////////
+
+
+#include "CollisionKernels.h"
+
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SFRPG_COLLISION_SSE
+#include <emmintrin.h>
+#endif
+
+
+using namespace sfge;
+
+
+namespace
+{
+
+    // SSE versions do the same float operations as scalar tails, so
+    // results don't depend on the number of edges
+
+    inline bool isProperCrossing (float side_a, float side_b, float side_c, float side_d)
+    {
+        return ((side_a < -COLLISION_EPSILON && side_b > COLLISION_EPSILON) || (side_a > COLLISION_EPSILON && side_b < -COLLISION_EPSILON)) &&
+            ((side_c < -COLLISION_EPSILON && side_d > COLLISION_EPSILON) || (side_c > COLLISION_EPSILON && side_d < -COLLISION_EPSILON));
+    }
+
+}
+
+
+bool sfge::crossSegment (const float* xs, const float* ys, size_t count, Vector2f offset, Vector2f c, Vector2f d)
+{
+    float cdx (c.x - d.x);
+    float cdy (c.y - d.y);
+    size_t i (0);
+
+#ifdef SFRPG_COLLISION_SSE
+    const __m128 eps (_mm_set1_ps (COLLISION_EPSILON));
+    const __m128 neg_eps (_mm_set1_ps (-COLLISION_EPSILON));
+    const __m128 ox (_mm_set1_ps (offset.x));
+    const __m128 oy (_mm_set1_ps (offset.y));
+    const __m128 cx (_mm_set1_ps (c.x));
+    const __m128 cy (_mm_set1_ps (c.y));
+    const __m128 dx (_mm_set1_ps (d.x));
+    const __m128 dy (_mm_set1_ps (d.y));
+    const __m128 cd_x (_mm_set1_ps (cdx));
+    const __m128 cd_y (_mm_set1_ps (cdy));
+
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 ax (_mm_add_ps (_mm_loadu_ps (xs + i), ox));
+        __m128 ay (_mm_add_ps (_mm_loadu_ps (ys + i), oy));
+        __m128 bx (_mm_add_ps (_mm_loadu_ps (xs + i + 1), ox));
+        __m128 by (_mm_add_ps (_mm_loadu_ps (ys + i + 1), oy));
+        __m128 ab_x (_mm_sub_ps (ax, bx));
+        __m128 ab_y (_mm_sub_ps (ay, by));
+
+        __m128 side_a (_mm_sub_ps (_mm_mul_ps (_mm_sub_ps (ax, dx), cd_y), _mm_mul_ps (_mm_sub_ps (ay, dy), cd_x)));
+        __m128 side_b (_mm_sub_ps (_mm_mul_ps (_mm_sub_ps (bx, dx), cd_y), _mm_mul_ps (_mm_sub_ps (by, dy), cd_x)));
+        __m128 side_c (_mm_sub_ps (_mm_mul_ps (_mm_sub_ps (cx, bx), ab_y), _mm_mul_ps (_mm_sub_ps (cy, by), ab_x)));
+        __m128 side_d (_mm_sub_ps (_mm_mul_ps (_mm_sub_ps (dx, bx), ab_y), _mm_mul_ps (_mm_sub_ps (dy, by), ab_x)));
+
+        __m128 cross_cd (_mm_or_ps (
+            _mm_and_ps (_mm_cmplt_ps (side_a, neg_eps), _mm_cmpgt_ps (side_b, eps)),
+            _mm_and_ps (_mm_cmpgt_ps (side_a, eps), _mm_cmplt_ps (side_b, neg_eps))
+        ));
+        __m128 cross_ab (_mm_or_ps (
+            _mm_and_ps (_mm_cmplt_ps (side_c, neg_eps), _mm_cmpgt_ps (side_d, eps)),
+            _mm_and_ps (_mm_cmpgt_ps (side_c, eps), _mm_cmplt_ps (side_d, neg_eps))
+        ));
+
+        if (_mm_movemask_ps (_mm_and_ps (cross_cd, cross_ab)))
+            return true;
+    }
+#endif
+
+    for (; i < count; ++i)
+    {
+        float ax (xs[i] + offset.x);
+        float ay (ys[i] + offset.y);
+        float bx (xs[i + 1] + offset.x);
+        float by (ys[i + 1] + offset.y);
+        float ab_x (ax - bx);
+        float ab_y (ay - by);
+
+        float side_a ((ax - d.x) * cdy - (ay - d.y) * cdx);
+        float side_b ((bx - d.x) * cdy - (by - d.y) * cdx);
+        float side_c ((c.x - bx) * ab_y - (c.y - by) * ab_x);
+        float side_d ((d.x - bx) * ab_y - (d.y - by) * ab_x);
+
+        if (isProperCrossing (side_a, side_b, side_c, side_d))
+            return true;
+    }
+
+    return false;
+}
+
+void sfge::project (const float* xs, const float* ys, size_t count, float axis_x, float axis_y, float& min, float& max)
+{
+    min = xs[0] * axis_x + ys[0] * axis_y;
+    max = min;
+    size_t i (0);
+
+#ifdef SFRPG_COLLISION_SSE
+    if (count >= 4)
+    {
+        const __m128 nx (_mm_set1_ps (axis_x));
+        const __m128 ny (_mm_set1_ps (axis_y));
+        __m128 min_value (_mm_set1_ps (min));
+        __m128 max_value (min_value);
+
+        for (; i + 4 <= count; i += 4)
+        {
+            __m128 value (_mm_add_ps (_mm_mul_ps (_mm_loadu_ps (xs + i), nx), _mm_mul_ps (_mm_loadu_ps (ys + i), ny)));
+            min_value = _mm_min_ps (min_value, value);
+            max_value = _mm_max_ps (max_value, value);
+        }
+
+        float mins[4];
+        float maxs[4];
+        _mm_storeu_ps (mins, min_value);
+        _mm_storeu_ps (maxs, max_value);
+
+        min = std::min (std::min (mins[0], mins[1]), std::min (mins[2], mins[3]));
+        max = std::max (std::max (maxs[0], maxs[1]), std::max (maxs[2], maxs[3]));
+    }
+#endif
+
+    for (; i < count; ++i)
+    {
+        float value (xs[i] * axis_x + ys[i] * axis_y);
+        min = std::min (min, value);
+        max = std::max (max, value);
+    }
+}
+
+bool sfge::isInsideConvex (const float* xs, const float* ys, const float* normal_xs, const float* normal_ys, size_t count, Vector2f p)
+{
+    size_t negative (0);
+    size_t i (0);
+
+#ifdef SFRPG_COLLISION_SSE
+    const __m128 zero (_mm_setzero_ps ());
+    const __m128 px (_mm_set1_ps (p.x));
+    const __m128 py (_mm_set1_ps (p.y));
+
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 side (_mm_add_ps (
+            _mm_mul_ps (_mm_sub_ps (px, _mm_loadu_ps (xs + i)), _mm_loadu_ps (normal_xs + i)),
+            _mm_mul_ps (_mm_sub_ps (py, _mm_loadu_ps (ys + i)), _mm_loadu_ps (normal_ys + i))
+        ));
+
+        int mask (_mm_movemask_ps (_mm_cmplt_ps (side, zero)));
+        negative += (mask & 1) + ((mask >> 1) & 1) + ((mask >> 2) & 1) + ((mask >> 3) & 1);
+    }
+#endif
+
+    for (; i < count; ++i)
+    {
+        float side ((p.x - xs[i]) * normal_xs[i] + (p.y - ys[i]) * normal_ys[i]);
+        if (side < 0.0f)
+            ++negative;
+    }
+
+    return negative == 0 || negative == count;
+}
@@ -0,0 +1,104 @@
+/////////////////////////////////////////////////////////////////////
+//
+// SFGE - Simple and Fast Game Engine
+//
+// Copyright (c) 2016-2017 DonRumata710 
+// 
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation
+// files (the "Software"), to deal in the Software without
+// restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+// WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+// 
+/////////////////////////////////////////////////////////////////////
+
+
+#pragma once
+
+
+#include <SFML/System/Vector2.hpp>
+
+#include <cstddef>
+
+
+namespace sfge
+{
+
+
+    using sf::Vector2f;
+
+
+    // Cross products with smaller absolute value are treated as zero
+    const float COLLISION_EPSILON = 1e-4f;
+
+    // Gap which is kept between polygons after swept movement
+    const float COLLISION_SKIN = 1e-3f;
+
+
+    /////////////////////////////////////////////////////////////////////
+    /// Kernels of collision checks
+    ///
+    /// Polygons are passed in structure-of-arrays form: edge i goes from
+    /// vertex (xs[i], ys[i]) to vertex (xs[i + 1], ys[i + 1]), so arrays
+    /// of closed polygon hold count + 1 vertices. Loops are vectorized
+    /// with SSE2 when compiler targets it.
+    /////////////////////////////////////////////////////////////////////
+
+    /////////////////////////////////////////////////////////////////////
+    /// crossSegment - check if any edge properly crosses segment
+    ///
+    /// @param xs - x coordinates of count + 1 vertices
+    /// @param ys - y coordinates of count + 1 vertices
+    /// @param count - number of edges
+    /// @param offset - offset which is added to every vertex
+    /// @param c - the first point of segment
+    /// @param d - the second point of segment
+    ///
+    /// @return - true if segment crosses at least one edge
+    /////////////////////////////////////////////////////////////////////
+    bool crossSegment (const float* xs, const float* ys, size_t count, Vector2f offset, Vector2f c, Vector2f d);
+
+    /////////////////////////////////////////////////////////////////////
+    /// project - get range of projections of vertices to axis
+    ///
+    /// @param xs - x coordinates of vertices
+    /// @param ys - y coordinates of vertices
+    /// @param count - number of vertices, at least one
+    /// @param axis_x - x coordinate of axis
+    /// @param axis_y - y coordinate of axis
+    /// @param min - the smallest projection
+    /// @param max - the largest projection
+    /////////////////////////////////////////////////////////////////////
+    void project (const float* xs, const float* ys, size_t count, float axis_x, float axis_y, float& min, float& max);
+
+    /////////////////////////////////////////////////////////////////////
+    /// isInsideConvex - check if point is on the same side of all edges
+    /// of convex polygon
+    ///
+    /// @param xs - x coordinates of vertices
+    /// @param ys - y coordinates of vertices
+    /// @param normal_xs - x coordinates of edge normals
+    /// @param normal_ys - y coordinates of edge normals
+    /// @param count - number of edges
+    /// @param p - point
+    ///
+    /// @return - true if point is inside of polygon
+    /////////////////////////////////////////////////////////////////////
+    bool isInsideConvex (const float* xs, const float* ys, const float* normal_xs, const float* normal_ys, size_t count, Vector2f p);
+
+
+}
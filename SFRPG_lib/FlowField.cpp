@@ -0,0 +1,128 @@
+/////////////////////////////////////////////////////////////////////
+//
+// SFGE - Simple and Fast Game Engine
+//
+// Copyright (c) 2016-2017 DonRumata710 
+// 
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation
+// files (the "Software"), to deal in the Software without
+// restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+// WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+// 
+/////////////////////////////////////////////////////////////////////
+
+
+#include "FlowField.h"
+#include "IndexedHeap.h"
+#include "NavigationGraph.h"
+
+#include <cfloat>
+
+
+using namespace sfge;
+
+
+void FlowField::build (const NavigationGraph& graph, uint32_t goal)
+{
+    m_goal = graph.getWayPointID (goal);
+    m_sectors.clear ();
+    m_cells.clear ();
+
+    std::vector<float> distances (graph.getNodeCount (), FLT_MAX);
+    std::vector<uint32_t> next (graph.getNodeCount (), uint32_t (NavigationGraph::INVALID_NODE));
+
+    IndexedHeap opened;
+    opened.reset (graph.getNodeCount ());
+
+    distances[goal] = 0.0f;
+    next[goal] = goal;
+    opened.push (goal, 0.0f);
+
+    while (!opened.empty ())
+    {
+        uint32_t node (opened.pop ());
+
+        for (uint32_t edge = graph.getEdgeBegin (node); edge < graph.getEdgeEnd (node); ++edge)
+        {
+            uint32_t neighbour (graph.getEdgeTarget (edge));
+            float distance (distances[node] + graph.getEdgeCost (edge));
+
+            if (distance < distances[neighbour])
+            {
+                distances[neighbour] = distance;
+                next[neighbour] = node;
+                opened.push (neighbour, distance);
+            }
+        }
+    }
+
+    // Nodes of one sector are placed consecutively
+    for (uint32_t node = 0; node < graph.getNodeCount (); ++node)
+    {
+        if (next[node] == NavigationGraph::INVALID_NODE)
+            continue;
+
+        uint32_t sector_id (graph.getSectorID (node));
+        std::vector<Cell>& cells (m_cells[sector_id]);
+
+        if (cells.empty ())
+        {
+            m_sectors.push_back (sector_id);
+            cells.assign (graph.getSectorEnd (sector_id) - graph.getSectorBegin (sector_id), Cell { FLT_MAX, WayPointID () });
+        }
+
+        cells[node - graph.getSectorBegin (sector_id)] = { distances[node], graph.getWayPointID (next[node]) };
+    }
+}
+
+WayPointID FlowField::getGoal () const
+{
+    return m_goal;
+}
+
+bool FlowField::isReachable (const WayPointID& point) const
+{
+    const Cell* cell (findCell (point));
+    return cell && cell->distance != FLT_MAX;
+}
+
+float FlowField::getDistance (const WayPointID& point) const
+{
+    const Cell* cell (findCell (point));
+    return cell ? cell->distance : FLT_MAX;
+}
+
+WayPointID FlowField::getNext (const WayPointID& point) const
+{
+    const Cell* cell (findCell (point));
+    return cell ? cell->next : WayPointID ();
+}
+
+const std::vector<uint32_t>& FlowField::getSectors () const
+{
+    return m_sectors;
+}
+
+const FlowField::Cell* FlowField::findCell (const WayPointID& point) const
+{
+    auto cells (m_cells.find (point.m_map_id));
+    if (cells == m_cells.end () || point.m_id >= cells->second.size ())
+        return nullptr;
+
+    return &cells->second[point.m_id];
+}
@@ -37,6 +37,16 @@
 using namespace sfge;
 
 
+namespace
+{
+
+    const size_t MAX_SLIDES = 3;
+
+    const float MIN_SLIDE = 1e-4f;
+
+}
+
+
 void InteractiveObject::setAnimation (std::unique_ptr<Animation> animation)
 {
     m_animation.swap (animation);
@@ -62,9 +72,63 @@ void InteractiveObject::doAction (const iAction* action)
         reaction->second->doAction (action->getActor ());
 }
 
+Vector2f InteractiveObject::getMovement (Vector2f vector, bool& hit) const
+{
+    hit = false;
+    if (!m_map)
+        return vector;
+
+    // Object moves to the first contact and the rest of vector slides
+    // along obstacle, every slide may hit one more obstacle. Polygon is
+    // copied only when it has to be moved between sweeps.
+    Collision collision;
+    const Collision* current (&m_collision);
+    Vector2f movement;
+
+    for (size_t i = 0; i < MAX_SLIDES; ++i)
+    {
+        float time;
+        Vector2f normal;
+        if (!m_map->sweepMovement (this, *current, vector, time, normal))
+            return movement + vector;
+
+        if (!hit)
+        {
+            collision = m_collision;
+            current = &collision;
+            hit = true;
+        }
+
+        collision.move (vector * time);
+        movement += vector * time;
+
+        vector *= 1.0f - time;
+        vector -= normal * (vector.x * normal.x + vector.y * normal.y);
+        if (vector.x * vector.x + vector.y * vector.y < MIN_SLIDE * MIN_SLIDE)
+            break;
+    }
+
+    return movement;
+}
+
 void InteractiveObject::move (Vector2f vector)
 {
-    m_collision.move (vector);
-    if (!m_map->checkMovement (this))
-        m_collision.move (-vector);
+    if (!m_map)
+    {
+        m_collision.move (vector);
+        return;
+    }
+
+    bool hit;
+    Point start (m_collision.getPosition ());
+    m_collision.move (getMovement (vector, hit));
+
+    if (hit)
+        runAction<CollisionAction> (nullptr);
+
+    // Object may be passed to another sector, it can't leave loaded sectors
+    if (!m_map->passObject (this))
+        m_collision.setPosition (start);
+
+    m_map->updateObject (this);
 }
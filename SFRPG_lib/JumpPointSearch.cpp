@@ -0,0 +1,273 @@
+/////////////////////////////////////////////////////////////////////
+//
+// SFGE - Simple and Fast Game Engine
+//
+// Copyright (c) 2016-2017 DonRumata710 
+// 
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation
+// files (the "Software"), to deal in the Software without
+// restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+// WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+// 
+/////////////////////////////////////////////////////////////////////
+
+
+#include "JumpPointSearch.h"
+#include "WalkabilityGrid.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+
+using namespace sfge;
+
+
+namespace
+{
+
+    const float DIAGONAL_COST = 1.41421356f;
+
+
+    int32_t sign (int32_t value)
+    {
+        return (value > 0) - (value < 0);
+    }
+
+}
+
+
+bool JumpPointSearch::findPath (const WalkabilityGrid& grid, Vector2i departure, Vector2i target, std::vector<Vector2i>& path)
+{
+    path.clear ();
+
+    if (!grid.isWalkable (departure.x, departure.y) || !grid.isWalkable (target.x, target.y))
+        return false;
+
+    size_t cell_count (size_t (grid.getWidth ()) * grid.getHeight ());
+    if (m_visit_marks.size () < cell_count)
+    {
+        m_costs.resize (cell_count);
+        m_parents.resize (cell_count);
+        m_visit_marks.resize (cell_count, 0);
+        m_close_marks.resize (cell_count, 0);
+    }
+
+    if (++m_generation == 0)
+    {
+        std::fill (m_visit_marks.begin (), m_visit_marks.end (), 0);
+        std::fill (m_close_marks.begin (), m_close_marks.end (), 0);
+        m_generation = 1;
+    }
+
+    m_target = target;
+    m_opened.reset (cell_count);
+
+    uint32_t width (grid.getWidth ());
+    uint32_t departure_id (uint32_t (departure.y) * width + departure.x);
+    uint32_t target_id (uint32_t (target.y) * width + target.x);
+
+    m_costs[departure_id] = 0.0f;
+    m_parents[departure_id] = departure_id;
+    m_visit_marks[departure_id] = m_generation;
+    m_opened.push (departure_id, getDistance (departure, target));
+
+    while (!m_opened.empty ())
+    {
+        uint32_t node (m_opened.pop ());
+        m_close_marks[node] = m_generation;
+
+        if (node == target_id)
+        {
+            for (uint32_t cell = target_id; cell != departure_id; cell = m_parents[cell])
+                path.emplace_back (cell % width, cell / width);
+            path.push_back (departure);
+
+            std::reverse (path.begin (), path.end ());
+            return true;
+        }
+
+        Vector2i cell (node % width, node / width);
+        Vector2i parent (m_parents[node] % width, m_parents[node] / width);
+
+        getDirections (grid, cell, parent, m_directions);
+
+        for (Vector2i direction : m_directions)
+        {
+            Vector2i jump_point;
+            if (!jump (grid, cell + direction, direction, jump_point))
+                continue;
+
+            uint32_t id (uint32_t (jump_point.y) * width + jump_point.x);
+            if (m_close_marks[id] == m_generation)
+                continue;
+
+            float cost (m_costs[node] + getDistance (cell, jump_point));
+            if (m_visit_marks[id] != m_generation || cost < m_costs[id])
+            {
+                m_visit_marks[id] = m_generation;
+                m_costs[id] = cost;
+                m_parents[id] = node;
+                m_opened.push (id, cost + getDistance (jump_point, target));
+            }
+        }
+    }
+
+    return false;
+}
+
+void JumpPointSearch::getDirections (const WalkabilityGrid& grid, Vector2i cell, Vector2i parent, std::vector<Vector2i>& directions) const
+{
+    directions.clear ();
+
+    int32_t dx (sign (cell.x - parent.x));
+    int32_t dy (sign (cell.y - parent.y));
+
+    if (dx == 0 && dy == 0)
+    {
+        // Departure cell: all directions without cutting corners
+        for (int32_t y = -1; y <= 1; ++y)
+        {
+            for (int32_t x = -1; x <= 1; ++x)
+            {
+                if ((x == 0 && y == 0) || !grid.isWalkable (cell.x + x, cell.y + y))
+                    continue;
+
+                if (x != 0 && y != 0 && (!grid.isWalkable (cell.x + x, cell.y) || !grid.isWalkable (cell.x, cell.y + y)))
+                    continue;
+
+                directions.emplace_back (x, y);
+            }
+        }
+    }
+    else if (dx != 0 && dy != 0)
+    {
+        bool walkable_x (grid.isWalkable (cell.x + dx, cell.y));
+        bool walkable_y (grid.isWalkable (cell.x, cell.y + dy));
+
+        if (walkable_x)
+            directions.emplace_back (dx, 0);
+        if (walkable_y)
+            directions.emplace_back (0, dy);
+        if (walkable_x && walkable_y)
+            directions.emplace_back (dx, dy);
+    }
+    else if (dx != 0)
+    {
+        bool walkable_next (grid.isWalkable (cell.x + dx, cell.y));
+        bool walkable_top (grid.isWalkable (cell.x, cell.y - 1));
+        bool walkable_bottom (grid.isWalkable (cell.x, cell.y + 1));
+
+        if (walkable_next)
+        {
+            directions.emplace_back (dx, 0);
+            if (walkable_top)
+                directions.emplace_back (dx, -1);
+            if (walkable_bottom)
+                directions.emplace_back (dx, 1);
+        }
+
+        if (walkable_top)
+            directions.emplace_back (0, -1);
+        if (walkable_bottom)
+            directions.emplace_back (0, 1);
+    }
+    else
+    {
+        bool walkable_next (grid.isWalkable (cell.x, cell.y + dy));
+        bool walkable_left (grid.isWalkable (cell.x - 1, cell.y));
+        bool walkable_right (grid.isWalkable (cell.x + 1, cell.y));
+
+        if (walkable_next)
+        {
+            directions.emplace_back (0, dy);
+            if (walkable_left)
+                directions.emplace_back (-1, dy);
+            if (walkable_right)
+                directions.emplace_back (1, dy);
+        }
+
+        if (walkable_left)
+            directions.emplace_back (-1, 0);
+        if (walkable_right)
+            directions.emplace_back (1, 0);
+    }
+}
+
+bool JumpPointSearch::jump (const WalkabilityGrid& grid, Vector2i cell, Vector2i direction, Vector2i& jump_point) const
+{
+    if (direction.x == 0 || direction.y == 0)
+        return jumpStraight (grid, cell, direction, jump_point);
+
+    Vector2i straight_point;
+
+    while (grid.isWalkable (cell.x, cell.y))
+    {
+        if (cell == m_target ||
+            jumpStraight (grid, { cell.x + direction.x, cell.y }, { direction.x, 0 }, straight_point) ||
+            jumpStraight (grid, { cell.x, cell.y + direction.y }, { 0, direction.y }, straight_point))
+        {
+            jump_point = cell;
+            return true;
+        }
+
+        if (!grid.isWalkable (cell.x + direction.x, cell.y) || !grid.isWalkable (cell.x, cell.y + direction.y))
+            return false;
+
+        cell += direction;
+    }
+
+    return false;
+}
+
+bool JumpPointSearch::jumpStraight (const WalkabilityGrid& grid, Vector2i cell, Vector2i direction, Vector2i& jump_point) const
+{
+    while (grid.isWalkable (cell.x, cell.y))
+    {
+        bool forced (false);
+
+        if (direction.x != 0)
+        {
+            forced = (grid.isWalkable (cell.x, cell.y - 1) && !grid.isWalkable (cell.x - direction.x, cell.y - 1)) ||
+                (grid.isWalkable (cell.x, cell.y + 1) && !grid.isWalkable (cell.x - direction.x, cell.y + 1));
+        }
+        else
+        {
+            forced = (grid.isWalkable (cell.x - 1, cell.y) && !grid.isWalkable (cell.x - 1, cell.y - direction.y)) ||
+                (grid.isWalkable (cell.x + 1, cell.y) && !grid.isWalkable (cell.x + 1, cell.y - direction.y));
+        }
+
+        if (cell == m_target || forced)
+        {
+            jump_point = cell;
+            return true;
+        }
+
+        cell += direction;
+    }
+
+    return false;
+}
+
+float JumpPointSearch::getDistance (Vector2i from, Vector2i to)
+{
+    int32_t dx (std::abs (to.x - from.x));
+    int32_t dy (std::abs (to.y - from.y));
+
+    return std::abs (dx - dy) + DIAGONAL_COST * std::min (dx, dy);
+}
@@ -30,6 +30,7 @@
 #include "MapLoader.h"
 #include "MapSectorDesc.h"
 #include "MapManager.h"
+#include "SectorFormat.h"
 #include "SectorLoader.h"
 
 #include <SFGE/TextParser.h>
@@ -89,7 +90,21 @@ bool MapLoader::loadMap (MapManager* manager, const std::string& path)
 
     manager->setLoader (std::make_unique<SectorLoader> (m_file_stream));
 
-    TextParser* tp = new TextParser (loadScript (path), m_sem_desc);
+    std::vector<char> script;
+    if (!loadScript (path, script))
+    {
+        runtime_message ("Failed loading map description file " + path);
+        return false;
+    }
+
+    // Binary file contains one sector which is the whole map
+    if (SectorFormat::isBinary (script.data (), script.size () - 1))
+    {
+        script.pop_back ();
+        return loadBinarySector (manager, path, script);
+    }
+
+    std::unique_ptr<TextParser> tp (new TextParser (script.data (), m_sem_desc));
 
     std::unordered_map<uint32_t, MapSectorDesc> sectors;
 
@@ -109,7 +124,7 @@ bool MapLoader::loadMap (MapManager* manager, const std::string& path)
     }
 
     if (token == MD_MAP)
-        manager->setName (parseMap (tp, &sectors));
+        manager->setName (parseMap (tp.get (), &sectors));
     else
     {
         sectors[0].path = path;
@@ -151,17 +166,40 @@ bool MapLoader::loadMap (MapManager* manager, const std::string& path)
     return true;
 }
 
-const char* MapLoader::loadScript (const std::string& path)
+bool MapLoader::loadScript (const std::string& path, std::vector<char>& script)
 {
     if (!m_file_stream->open (path))
-        return nullptr;
+        return false;
+
+    int64_t size (m_file_stream->getSize ());
+    if (size <= 0)
+        return false;
+
+    script.resize (size_t (size) + 1);
+    if (m_file_stream->read (script.data (), size) != size)
+        return false;
 
-    uint64_t size (m_file_stream->getSize ());
-    char* data = new char[size];
-    m_file_stream->read (data, size);
-    data[size - 1] = '\0';
+    script[size_t (size)] = '\0';
+    return true;
+}
+
+bool MapLoader::loadBinarySector (MapManager* manager, const std::string& path, const std::vector<char>& data)
+{
+    BinarySector binary;
+    if (!binary.open (data.data (), data.size ()))
+    {
+        runtime_message ("Wrong binary map sector in file " + path);
+        return false;
+    }
+
+    std::unordered_map<uint32_t, MapSectorDesc> sectors;
+    sectors[0].path = path;
+    sectors[0].size = binary.getSize ();
 
-    return data;
+    manager->setName (binary.getName ());
+    manager->setMapDescription (std::move (sectors));
+
+    return true;
 }
 
 std::string MapLoader::parseMap (TextParser* tp, std::unordered_map<uint32_t, MapSectorDesc>* sectors)
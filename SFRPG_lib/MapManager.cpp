@@ -27,39 +27,34 @@
 /////////////////////////////////////////////////////////////////////
 
 
+#include "InteractiveObject.h"
 #include "MapLoader.h"
 #include "SectorLoader.h"
 #include "MapSaver.h"
 #include "MapManager.h"
 #include "Way.h"
+#include "WorkerPool.h"
 
 #include <SFGE/Err.h>
 
+#include <algorithm>
+#include <cfloat>
 #include <cmath>
-#include <map>
+#include <stdexcept>
+#include <unordered_set>
 
 
 using namespace sfge;
 
 
-struct PathDesc
+namespace
 {
-    const WayPoint* point = nullptr;
-    const WayPoint* parent = nullptr;
-    float passed_dist = 0.0f;
 
-    PathDesc (const WayPoint* _point) :
-        point (_point)
-    {}
+    // Movements are found by blocks of requests, so workers don't contend
+    // for every small task
+    const size_t MOVE_BLOCK = 64;
 
-    PathDesc (const WayPoint* _parent, const WayPoint* p) :
-        parent (_parent), point (p)
-    {}
-
-    PathDesc (const WayPoint* _parent, const WayPoint* p, float dist) :
-        parent (_parent), point (p), passed_dist (dist)
-    {}
-};
+}
 
 
 MapManager::MapManager ()
@@ -70,17 +65,48 @@ MapManager::~MapManager ()
 
 void MapManager::setMapDescription (std::unordered_map<uint32_t, MapSectorDesc>&& sectors)
 {
+    // Sectors which are being streamed belong to the old description
+    if (m_loader)
+    {
+        std::vector<SectorLoader::LoadedSector> streamed;
+        m_loader->wait ();
+        m_loader->takeSectors (streamed);
+    }
+
     m_sectors = std::move (sectors);
 
+    // Description of loaded sector may omit size, sector itself knows it
+    for (auto& sector : m_sectors)
+    {
+        if (sector.second.sector && sector.second.size == Vector2u ())
+            sector.second.size = sector.second.sector->getSize ();
+    }
+
+    m_sector_index.build (m_sectors);
+    m_path_cache.clear ();
+    m_flow_fields.clear ();
+    m_object_tree.clear ();
+    m_object_proxies.clear ();
+    m_object_margin = 0.0f;
+    m_pending_moves.clear ();
+    m_pending_ids.clear ();
+    m_sector_uses.clear ();
+    m_evicted_sectors = 0;
+    m_saved_sectors = 0;
+
+    std::vector<uint32_t> loaded;
     for (auto& sector : m_sectors)
     {
         if (sector.second.sector)
         {
             sector.second.sector->setMapManager (this);
-            findWayPointsEdges (sector.second.sector.get ());
+            loaded.push_back (sector.first);
         }
     }
 
+    setOffset (m_offset.x, m_offset.y);
+    findWayPointsEdges (loaded);
+    updateNavigation ();
 }
 
 void MapManager::setName (const std::string& name)
@@ -100,35 +126,185 @@ void MapManager::setLoader (std::unique_ptr<SectorLoader>&& loader)
 
 void MapManager::lookMap (const std::vector<UintRect>& areas)
 {
-    std::vector<MapSectorDesc*> sectors;
+    lookMap (areas, Vector2f ());
+}
+
+void MapManager::lookMap (const std::vector<UintRect>& areas, Vector2f velocity)
+{
+    if (areas.empty ())
+        return;
+
+    ++m_look_count;
+
+    std::vector<uint32_t> sector_ids;
     sf::Vector2<sf::Uint64> offset;
     for (const auto& area : areas)
     {
         offset.x += (Uint64 (area.left) + area.width) / 2;
         offset.y += (area.top + area.height) / 2;
 
-        for (auto& sector : m_sectors)
+        findSectors (area, sector_ids);
+        touchSectors (area);
+    }
+
+    if (velocity != Vector2f ())
+    {
+        for (const auto& area : areas)
         {
-            if (area.left < sector.second.pos.x + sector.second.size.x &&
-                area.top  < sector.second.pos.y + sector.second.size.y &&
-                area.left + area.width > sector.second.pos.x &&
-                area.top + area.height > sector.second.pos.y &&
-                !sector.second.sector
-            )
-            {
-                sectors.push_back (&sector.second);
-            }
+            UintRect prefetch_area (getPrefetchArea (area, velocity));
+            findSectors (prefetch_area, sector_ids);
+            touchSectors (prefetch_area);
         }
     }
 
+    // Loaded sectors are connected with neighbours by their positions
     setOffset (offset.x / areas.size (), offset.y / areas.size ());
 
-    m_loader->loadSectors (sectors);
-    for (auto sector : sectors)
+    std::vector<uint32_t> loaded;
+    if (m_loader && m_streaming)
+    {
+        for (uint32_t id : sector_ids)
+            m_loader->requestSector (id, m_sectors.at (id));
+    }
+    else if (m_loader)
+    {
+        std::vector<MapSectorDesc*> sectors;
+        for (uint32_t id : sector_ids)
+            sectors.push_back (&m_sectors.at (id));
+
+        // Every sector is connected while the next ones are still parsed
+        m_loader->loadSectors (sectors, [this, &sectors, &sector_ids, &loaded](size_t i)
+        {
+            MapSector* sector (sectors[i]->sector.get ());
+            sector->setMapManager (this);
+            sector->setOffset ({ float (sectors[i]->pos.x) - m_offset.x, float (sectors[i]->pos.y) - m_offset.y });
+
+            loaded.push_back (sector_ids[i]);
+            findWayPointsEdges ({ sector_ids[i] });
+        });
+    }
+
+    if (!loaded.empty ())
     {
-        findWayPointsEdges (sector->sector.get ());
-        sector->sector->setMapManager (this);
+        invalidateWays (loaded);
+        updateNavigation ();
     }
+
+    evictSectors ();
+}
+
+void MapManager::setStreaming (bool enable)
+{
+    m_streaming = enable;
+}
+
+bool MapManager::isStreaming () const
+{
+    return m_streaming;
+}
+
+void MapManager::setPrefetchTime (float time)
+{
+    m_prefetch_time = std::max (time, 0.0f);
+}
+
+float MapManager::getPrefetchTime () const
+{
+    return m_prefetch_time;
+}
+
+size_t MapManager::update (bool wait)
+{
+    if (!m_loader)
+        return 0;
+
+    if (wait)
+        m_loader->wait ();
+
+    std::vector<SectorLoader::LoadedSector> sectors;
+    m_loader->takeSectors (sectors);
+
+    std::vector<uint32_t> loaded;
+    for (auto& sector : sectors)
+    {
+        auto desc (m_sectors.find (sector.id));
+        if (!sector.sector || desc == m_sectors.end () || desc->second.sector)
+            continue;
+
+        // Textures are taken from resource manager on this thread only
+        SectorLoader::setTiles (sector);
+        sector.sector->setMapManager (this);
+        sector.sector->setOffset ({ float (desc->second.pos.x) - m_offset.x, float (desc->second.pos.y) - m_offset.y });
+
+        desc->second.sector = std::move (sector.sector);
+        loaded.push_back (sector.id);
+    }
+
+    if (loaded.empty ())
+        return 0;
+
+    findWayPointsEdges (loaded);
+    invalidateWays (loaded);
+    updateNavigation ();
+
+    evictSectors ();
+
+    return loaded.size ();
+}
+
+size_t MapManager::getStreamedSectors () const
+{
+    return m_loader ? m_loader->getRequestCount () : 0;
+}
+
+void MapManager::setSaver (std::unique_ptr<MapSaver>&& saver)
+{
+    m_saver.swap (saver);
+}
+
+void MapManager::setMemoryBudget (size_t bytes)
+{
+    m_memory_budget = bytes;
+    evictSectors ();
+}
+
+size_t MapManager::getMemoryBudget () const
+{
+    return m_memory_budget;
+}
+
+size_t MapManager::getResidentSectors () const
+{
+    size_t count (0);
+    for (const auto& sector : m_sectors)
+    {
+        if (sector.second.sector)
+            ++count;
+    }
+
+    return count;
+}
+
+size_t MapManager::getResidentBytes () const
+{
+    size_t bytes (0);
+    for (const auto& sector : m_sectors)
+    {
+        if (sector.second.sector)
+            bytes += sector.second.sector->getMemoryUsage ();
+    }
+
+    return bytes;
+}
+
+uint64_t MapManager::getEvictedSectors () const
+{
+    return m_evicted_sectors;
+}
+
+uint64_t MapManager::getSavedSectors () const
+{
+    return m_saved_sectors;
 }
 
 bool MapManager::save (MapSaver* saver)
@@ -161,47 +337,473 @@ bool MapManager::saveSectors (MapSaver* saver)
             runtime_message ("Failed saving sector " + sector.second.sector->getName ());
             return false;
         }
+
+        sector.second.sector->setModified (false);
     }
 
     return true;
 }
 
-Way MapManager::getWay (Vector2f departure, Vector2f target) const
+Way MapManager::getWay (Vector2f departure, Vector2f target, bool smooth) const
 {
-    WayPointID departure_point;
-    WayPointID target_point;
+    std::deque<Vector2f> points;
+    if (!findWay (findWayPoint (departure), findWayPoint (target), points))
+        return Way (std::deque<Vector2f> ());
 
-    for (const auto& map : m_sectors)
+    points.push_back (target);
+    if (smooth)
+        smoothWay (departure, points);
+
+    return Way (std::move (points));
+}
+
+std::vector<Way> MapManager::getWays (const std::vector<std::pair<Vector2f, Vector2f>>& queries, bool smooth) const
+{
+    std::vector<std::deque<Vector2f>> points (queries.size ());
+    std::vector<WayPointID> departures (queries.size ());
+    std::vector<WayPointID> targets (queries.size ());
+    std::vector<char> found (queries.size (), 0);
+    std::vector<size_t> pending;
+
+    for (size_t i = 0; i < queries.size (); ++i)
     {
-        if (map.second.sector->isObjectInSector (departure))
+        departures[i] = findWayPoint (queries[i].first);
+        targets[i] = findWayPoint (queries[i].second);
+
+        uint32_t departure_node (m_navigation.getNode (departures[i]));
+        uint32_t target_node (m_navigation.getNode (targets[i]));
+
+        if (departure_node == NavigationGraph::INVALID_NODE ||
+            target_node == NavigationGraph::INVALID_NODE ||
+            !m_navigation.isConnected (departure_node, target_node))
+            continue;
+
+        const PathCache::WayPoints* cached_points (m_path_cache.find (departures[i], targets[i]));
+        if (cached_points)
         {
-            departure_point = { map.first, map.second.sector->getNearestWayPoint (departure - map.second.sector->getOffset ()) };
-            break;
+            points[i] = *cached_points;
+            found[i] = 1;
+        }
+        else
+        {
+            pending.push_back (i);
         }
     }
 
-    for (const auto& map : m_sectors)
+    if (!pending.empty ())
     {
-        if (map.second.sector->isObjectInSector (target))
+        if (!m_workers)
+            m_workers.reset (new WorkerPool ());
+
+        if (m_batch_search.size () < m_workers->getThreadCount ())
+            m_batch_search.resize (m_workers->getThreadCount ());
+
+        std::vector<std::vector<uint32_t>> sectors (pending.size ());
+
+        // Graph is unfrozen even if search throws
+        struct Unfreeze
         {
-            target_point = { map.first, map.second.sector->getNearestWayPoint (target - map.second.sector->getOffset ()) };
-            break;
+            std::atomic<bool>& frozen;
+
+            ~Unfreeze ()
+            {
+                frozen = false;
+            }
+        } unfreeze { m_navigation_frozen };
+
+        m_navigation_frozen = true;
+
+        m_workers->run (pending.size (), [&](size_t index, size_t worker)
+        {
+            size_t query (pending[index]);
+            found[query] = searchWay (
+                m_navigation.getNode (departures[query]),
+                m_navigation.getNode (targets[query]),
+                m_batch_search[worker],
+                points[query],
+                sectors[index]
+            );
+        });
+
+        for (size_t index = 0; index < pending.size (); ++index)
+        {
+            size_t query (pending[index]);
+            if (found[query])
+                m_path_cache.insert (departures[query], targets[query], points[query], sectors[index]);
         }
     }
 
-    Way way (findWay (departure_point, target_point));
+    std::vector<Way> ways;
+    ways.reserve (queries.size ());
+
+    for (size_t i = 0; i < queries.size (); ++i)
+    {
+        if (found[i])
+        {
+            points[i].push_back (queries[i].second);
+            if (smooth)
+                smoothWay (queries[i].first, points[i]);
+        }
+
+        ways.emplace_back (std::move (points[i]));
+    }
+
+    return ways;
+}
+
+Way MapManager::getGridWay (Vector2f departure, Vector2f target) const
+{
+    updateWalkability ();
+
+    std::vector<Vector2i> cells;
+    if (!m_jump_point_search.findPath (m_walkability, m_walkability.getCell (departure), m_walkability.getCell (target), cells))
+        return Way (std::deque<Vector2f> ());
+
+    std::deque<Vector2f> points;
+    for (size_t i = 1; i + 1 < cells.size (); ++i)
+        points.push_back (m_walkability.getCellCenter (cells[i]));
 
+    Way way (std::move (points));
     way.pushPointBack (target);
 
     return way;
 }
 
+bool MapManager::isNavigationFrozen () const
+{
+    return m_navigation_frozen;
+}
+
+void MapManager::setHierarchicalSearch (bool enable)
+{
+    // Ways found in another mode may differ, so they aren't served anymore
+    if (m_hierarchical_search != enable)
+        m_path_cache.clear ();
+
+    m_hierarchical_search = enable;
+    updateNavigation ();
+}
+
+bool MapManager::isHierarchicalSearch () const
+{
+    return m_hierarchical_search;
+}
+
+PathCache& MapManager::getPathCache ()
+{
+    return m_path_cache;
+}
+
+const PathCache& MapManager::getPathCache () const
+{
+    return m_path_cache;
+}
+
+void MapManager::updateSector (MapSector* sector, const FloatRect& area)
+{
+    checkNavigationFrozen ();
+
+    // Corner of sector is shared with neighbours only, so sector is found among a few candidates
+    Vector2f corner (sector->getOffset ());
+    std::vector<uint32_t> ids;
+    m_sector_index.queryPoint ({ corner.x + m_offset.x, corner.y + m_offset.y }, ids);
+
+    auto id (std::find_if (ids.begin (), ids.end (), [this, sector](uint32_t id)
+    {
+        return m_sectors.at (id).sector.get () == sector;
+    }));
+
+    if (id == ids.end ())
+        return;
+
+    uint32_t sector_id (*id);
+    std::vector<const WayPoint*> points;
+    std::vector<uint32_t> sectors { sector_id };
+
+    sector->updateEdges (area, points);
+    invalidateSector (sector_id);
+
+    m_sector_index.queryNeighbours (sector_id, ids);
+    for (uint32_t neighbour_id : ids)
+    {
+        const MapSectorDesc& neighbour (m_sectors.at (neighbour_id));
+        if (!neighbour.sector)
+            continue;
+
+        size_t count (points.size ());
+        sector->updateEdges (neighbour.sector.get (), area, points);
+        invalidateSector (neighbour_id);
+
+        if (points.size () != count)
+            sectors.push_back (neighbour_id);
+    }
+
+    updateNavigation (points, sectors);
+}
+
+bool MapManager::getFlowStep (Vector2f position, Vector2f goal, Vector2f& step) const
+{
+    WayPointID goal_point (findWayPoint (goal));
+    std::shared_ptr<const FlowField> field (findFlowField (goal_point));
+    if (!field)
+        return false;
+
+    WayPointID point (findWayPoint (position));
+    if (!field->isReachable (point))
+        return false;
+
+    if (point.m_map_id == goal_point.m_map_id && point.m_id == goal_point.m_id)
+    {
+        step = goal;
+        return true;
+    }
+
+    WayPointID next (field->getNext (point));
+    step = m_sectors.at (next.m_map_id).sector->getWayPoint (next.m_id)->getPosition ();
+    return true;
+}
+
+std::shared_ptr<const FlowField> MapManager::getFlowField (Vector2f goal) const
+{
+    return findFlowField (findWayPoint (goal));
+}
+
+void MapManager::setFlowFieldCapacity (size_t capacity)
+{
+    m_flow_field_capacity = capacity;
+    evictFlowFields (m_flow_field_capacity);
+}
+
+size_t MapManager::getFlowFieldCapacity () const
+{
+    return m_flow_field_capacity;
+}
+
+bool MapManager::checkPass (Vector2f p1, Vector2f p2) const
+{
+    std::vector<uint32_t> sector_ids;
+    findSegmentSectors (p1, p2, sector_ids);
+
+    std::vector<uint32_t> candidates;
+    for (uint32_t id : sector_ids)
+    {
+        const MapSectorDesc& desc (m_sectors.at (id));
+        if (desc.sector && !desc.sector->checkPass (p1, p2, candidates))
+            return false;
+    }
+
+    return true;
+}
+
+void MapManager::checkPass (const std::vector<Segment>& segments, std::vector<uint64_t>& blocked) const
+{
+    blocked.assign ((segments.size () + 63) / 64, 0);
+
+    // Segments are grouped by sectors which they may cross
+    std::unordered_map<uint32_t, std::vector<size_t>> sector_indices;
+    std::vector<uint32_t> sector_ids;
+    for (size_t i = 0; i < segments.size (); ++i)
+    {
+        findSegmentSectors (segments[i].first, segments[i].second, sector_ids);
+        for (uint32_t id : sector_ids)
+        {
+            if (m_sectors.at (id).sector)
+                sector_indices[id].push_back (i);
+        }
+    }
+
+    std::vector<Segment> sector_segments;
+    std::vector<uint64_t> sector_blocked;
+
+    for (const auto& sector : sector_indices)
+    {
+        const std::vector<size_t>& indices (sector.second);
+
+        sector_segments.clear ();
+        for (size_t i : indices)
+            sector_segments.push_back (segments[i]);
+
+        m_sectors.at (sector.first).sector->checkPass (sector_segments, sector_blocked);
+
+        for (size_t k = 0; k < indices.size (); ++k)
+        {
+            if (sector_blocked[k / 64] & (uint64_t (1) << (k % 64)))
+                blocked[indices[k] / 64] |= uint64_t (1) << (indices[k] % 64);
+        }
+    }
+}
+
+std::vector<MapObject*> MapManager::queryRect (const FloatRect& rect) const
+{
+    std::vector<uint32_t> proxies;
+    m_object_tree.query (rect, proxies);
+
+    std::vector<MapObject*> objects;
+    for (uint32_t proxy : proxies)
+    {
+        if (m_object_tree.getBounds (proxy).intersects (rect))
+            objects.push_back (static_cast<MapObject*> (m_object_tree.getData (proxy)));
+    }
+
+    return objects;
+}
+
+std::vector<MapObject*> MapManager::queryRadius (Vector2f center, float radius) const
+{
+    std::vector<uint32_t> proxies;
+    m_object_tree.query (FloatRect (center.x - radius, center.y - radius, radius * 2, radius * 2), proxies);
+
+    std::vector<MapObject*> objects;
+    for (uint32_t proxy : proxies)
+    {
+        MapObject* object (static_cast<MapObject*> (m_object_tree.getData (proxy)));
+        if (object->getCollision ().getDistance (center) <= radius)
+            objects.push_back (object);
+    }
+
+    return objects;
+}
+
+MapObject* MapManager::raycast (Vector2f p1, Vector2f p2, Vector2f& hit) const
+{
+    MapObject* closest (nullptr);
+    float closest_fraction (1.0f);
+
+    m_object_tree.raycast (p1, p2, [&](uint32_t proxy, float max_fraction)
+    {
+        MapObject* object (static_cast<MapObject*> (m_object_tree.getData (proxy)));
+
+        float fraction;
+        if (!object->getCollision ().raycast (p1, p2, fraction) || fraction > max_fraction)
+            return max_fraction;
+
+        closest = object;
+        closest_fraction = fraction;
+        return fraction;
+    });
+
+    if (closest)
+        hit = p1 + (p2 - p1) * closest_fraction;
+
+    return closest;
+}
+
+void MapManager::requestMove (InteractiveObject* object, Vector2f vector)
+{
+    auto id (m_pending_ids.find (object));
+    if (id != m_pending_ids.end ())
+    {
+        m_pending_moves[id->second].vector += vector;
+        return;
+    }
+
+    m_pending_ids[object] = m_pending_moves.size ();
+    m_pending_moves.push_back ({ object, vector, Vector2f (), false });
+}
+
+void MapManager::step ()
+{
+    std::vector<PendingMove> moves;
+    moves.swap (m_pending_moves);
+    m_pending_ids.clear ();
+
+    moves.erase (std::remove_if (
+        moves.begin (),
+        moves.end (),
+        [](const PendingMove& move) { return !move.object; }
+    ), moves.end ());
+
+    if (moves.empty ())
+        return;
+
+    // Nothing is moved while movements are found, so every object sees
+    // positions of others at start of step
+    auto find_movements = [&moves](size_t block)
+    {
+        size_t end (std::min (moves.size (), (block + 1) * MOVE_BLOCK));
+        for (size_t i = block * MOVE_BLOCK; i < end; ++i)
+            moves[i].movement = moves[i].object->getMovement (moves[i].vector, moves[i].hit);
+    };
+
+    size_t blocks ((moves.size () + MOVE_BLOCK - 1) / MOVE_BLOCK);
+    if (blocks == 1)
+    {
+        find_movements (0);
+    }
+    else
+    {
+        if (!m_workers)
+            m_workers.reset (new WorkerPool ());
+
+        m_workers->run (blocks, [&find_movements](size_t block, size_t) { find_movements (block); });
+    }
+
+    std::unordered_set<const MapObject*> moved;
+    for (PendingMove& move : moves)
+    {
+        InteractiveObject* object (move.object);
+        Vector2f start (object->getPosition ());
+        object->setPosition (start + move.movement);
+
+        MapSector* sector (object->getSector ());
+        if (!sector)
+            continue;
+
+        // Objects which were moved earlier in this step weren't seen by sweep
+        for (const MapObject* neighbour : queryRect (object->getBounds ()))
+        {
+            if (neighbour != object && moved.count (neighbour) &&
+                (object->detectCollision (neighbour) != Collision::State::OUTSIDE ||
+                neighbour->detectCollision (object) != Collision::State::OUTSIDE))
+            {
+                object->setPosition (start);
+                move.hit = true;
+                break;
+            }
+        }
+
+        if (!sector->passObject (object))
+            object->setPosition (start);
+
+        object->getSector ()->updateObject (object);
+        moved.insert (object);
+    }
+
+    for (const PendingMove& move : moves)
+    {
+        if (move.hit)
+            move.object->runAction<CollisionAction> (nullptr);
+    }
+}
+
+size_t MapManager::getPendingMoves () const
+{
+    return m_pending_ids.size ();
+}
+
+void MapManager::findSegmentSectors (Vector2f p1, Vector2f p2, std::vector<uint32_t>& sector_ids) const
+{
+    // Segment may be degenerate, so index is queried with closed bounds.
+    // Objects may stick out of their sectors, so bounds are grown by size
+    // of the largest object.
+    float left (std::min (p1.x, p2.x) + m_offset.x - m_object_margin);
+    float top (std::min (p1.y, p2.y) + m_offset.y - m_object_margin);
+    float width (std::abs (p1.x - p2.x) + m_object_margin * 2);
+    float height (std::abs (p1.y - p2.y) + m_object_margin * 2);
+
+    m_sector_index.queryRect (FloatRect (left, top, width, height), sector_ids);
+}
+
 MapSector* MapManager::getSector (Vector2f position)
 {
-    for (auto& map : m_sectors)
+    std::vector<uint32_t> ids;
+    m_sector_index.queryPoint ({ position.x + m_offset.x, position.y + m_offset.y }, ids);
+
+    for (uint32_t id : ids)
     {
-        if (map.second.sector && map.second.sector->isObjectInSector (position))
-            return map.second.sector.get ();
+        const MapSectorDesc& desc (m_sectors.at (id));
+        if (desc.sector && desc.sector->isObjectInSector (position))
+            return desc.sector.get ();
     }
 
     return nullptr;
@@ -209,105 +811,517 @@ MapSector* MapManager::getSector (Vector2f position)
 
 void MapManager::setOffset (int32_t x, int32_t y)
 {
+    // Found ways, way points of navigation graph and grid of walkability
+    // are kept in coordinates of map. Portal graph holds only costs, so
+    // it doesn't depend on offset.
+    if (m_offset.x != x || m_offset.y != y)
+    {
+        m_path_cache.clear ();
+        m_navigation.move ({ float (m_offset.x - x), float (m_offset.y - y) });
+        m_walkability_changed = true;
+    }
+
     for (auto& map : m_sectors)
     {
         if (map.second.sector)
-            map.second.sector->setOffset ({ (float) x, (float) y });
+            map.second.sector->setOffset ({ (float) map.second.pos.x - x, (float) map.second.pos.y - y });
     }
 
     m_offset.x = x;
     m_offset.y = y;
 }
 
-void MapManager::findWayPointsEdges (MapSector* sector)
+void MapManager::insertObject (MapObject* object)
+{
+    growObjectMargin (object->getBounds ());
+
+    auto proxy (m_object_proxies.find (object));
+    if (proxy != m_object_proxies.end ())
+        m_object_tree.move (proxy->second, object->getBounds ());
+    else
+        m_object_proxies[object] = m_object_tree.insert (object->getBounds (), object);
+}
+
+void MapManager::removeObject (const MapObject* object)
 {
-    if (!sector)
+    auto proxy (m_object_proxies.find (object));
+    if (proxy == m_object_proxies.end ())
         return;
 
-    sector->connectWayPoints ();
-    for (auto& i : m_sectors)
+    m_object_tree.remove (proxy->second);
+    m_object_proxies.erase (proxy);
+
+    auto id (m_pending_ids.find (object));
+    if (id != m_pending_ids.end ())
+    {
+        m_pending_moves[id->second].object = nullptr;
+        m_pending_ids.erase (id);
+    }
+}
+
+void MapManager::moveObject (const MapObject* object)
+{
+    growObjectMargin (object->getBounds ());
+
+    auto proxy (m_object_proxies.find (object));
+    if (proxy != m_object_proxies.end ())
+        m_object_tree.move (proxy->second, object->getBounds ());
+}
+
+void MapManager::growObjectMargin (const FloatRect& bounds)
+{
+    m_object_margin = std::max (m_object_margin, std::max (bounds.width, bounds.height));
+}
+
+void MapManager::findSectors (const UintRect& area, std::vector<uint32_t>& sector_ids) const
+{
+    std::vector<uint32_t> ids;
+    m_sector_index.queryRect (area, ids);
+
+    for (uint32_t id : ids)
     {
-        if (i.second.sector && sector != i.second.sector.get ())
+        if (!m_sectors.at (id).sector &&
+            !(m_loader && m_loader->isRequested (id)) &&
+            std::find (sector_ids.begin (), sector_ids.end (), id) == sector_ids.end ()
+        )
         {
-            sector->connectWayPoints (i.second.sector.get ());
+            sector_ids.push_back (id);
         }
     }
 }
 
-std::deque<Vector2f> MapManager::findWay (const WayPointID& departure, const WayPointID& target) const
+void MapManager::touchSectors (const UintRect& area)
 {
-    const WayPoint* departure_point (m_sectors.at (departure.m_map_id).sector->getWayPoint (departure.m_id));
-    const WayPoint* target_point (m_sectors.at (target.m_map_id).sector->getWayPoint (target.m_id));
+    std::vector<uint32_t> ids;
+    m_sector_index.queryRect (area, ids);
 
-    std::map<float, PathDesc> opened_points;
-    opened_points.insert ({ getDistance (departure_point->getPosition (), target_point->getPosition ()), departure_point });
+    for (uint32_t id : ids)
+        m_sector_uses[id] = m_look_count;
+}
 
-    std::unordered_map<const WayPoint*, const WayPoint*> closed_points;
+void MapManager::evictSectors ()
+{
+    if (m_memory_budget == 0)
+        return;
 
-    while (opened_points.begin ()->second.point != target_point)
+    struct Candidate
+    {
+        uint32_t id;
+        uint64_t last_use;
+        float distance;
+        size_t bytes;
+    };
+
+    size_t bytes (0);
+    std::vector<Candidate> candidates;
+    for (const auto& sector : m_sectors)
     {
-        auto point_iterator (opened_points.begin ());
-        auto pending_point (point_iterator->second);
+        if (!sector.second.sector)
+            continue;
+
+        size_t sector_bytes (sector.second.sector->getMemoryUsage ());
+        bytes += sector_bytes;
+
+        // Sectors of the last looked areas stay loaded
+        auto use (m_sector_uses.find (sector.first));
+        uint64_t last_use (use != m_sector_uses.end () ? use->second : 0);
+        if (last_use == m_look_count && m_look_count != 0)
+            continue;
+
+        // Interactive objects are moved by game through their sector
+        if (sector.second.sector->hasInteractiveObjects ())
+            continue;
+
+        Vector2f center (
+            float (sector.second.pos.x) + sector.second.size.x / 2.0f - m_offset.x,
+            float (sector.second.pos.y) + sector.second.size.y / 2.0f - m_offset.y
+        );
+
+        candidates.push_back ({ sector.first, last_use, center.x * center.x + center.y * center.y, sector_bytes });
+    }
+
+    if (bytes <= m_memory_budget || candidates.empty ())
+        return;
+
+    checkNavigationFrozen ();
+
+    std::sort (candidates.begin (), candidates.end (), [](const Candidate& c1, const Candidate& c2)
+    {
+        if (c1.last_use != c2.last_use)
+            return c1.last_use < c2.last_use;
+        if (c1.distance != c2.distance)
+            return c1.distance > c2.distance;
+        return c1.id < c2.id;
+    });
+
+    std::vector<uint32_t> evicted;
+    for (const Candidate& candidate : candidates)
+    {
+        if (bytes <= m_memory_budget)
+            break;
 
-        auto edges (pending_point.point->getEdges ());
+        if (!unloadSector (candidate.id))
+            continue;
 
-        for (const WayPoint* current_point : edges)
+        bytes -= candidate.bytes;
+        evicted.push_back (candidate.id);
+    }
+
+    if (evicted.empty ())
+        return;
+
+    invalidateWays (evicted);
+    updateNavigation ();
+}
+
+bool MapManager::unloadSector (uint32_t id)
+{
+    MapSectorDesc& desc (m_sectors.at (id));
+
+    // Sector without path can't be loaded again, so it is saved like a changed one
+    if (desc.sector->isModified () || desc.path.empty ())
+    {
+        if (!m_saver)
+            return false;
+
+        if (desc.path.empty ())
+            desc.path = "sector-" + std::to_string (id) + ".ress";
+
+        if (!m_saver->saveSector (desc.sector.get (), desc.path))
         {
-            if (current_point == target_point)
-            {
-                opened_points.insert ({ 0.0f, { pending_point.point, current_point } });
-                break;
-            }
+            runtime_message ("Failed saving sector " + desc.sector->getName () + " before unloading");
+            return false;
+        }
 
-            if (closed_points.find (current_point) == closed_points.end ())
-            {
-                PathDesc desc (
-                    pending_point.point,
-                    current_point,
-                    pending_point.passed_dist + getDistance (current_point->getPosition (), pending_point.point->getPosition ())
-                );
-                opened_points.insert ({ getDistance (current_point->getPosition (), target_point->getPosition ()) + desc.passed_dist, desc });
-            }
+        desc.sector->setModified (false);
+        ++m_saved_sectors;
+    }
+
+    // Way points of neighbours mustn't keep pointers to way points of this sector
+    std::vector<uint32_t> neighbours;
+    m_sector_index.queryNeighbours (id, neighbours);
+    for (uint32_t neighbour_id : neighbours)
+    {
+        const MapSectorDesc& neighbour (m_sectors.at (neighbour_id));
+        if (neighbour.sector)
+            neighbour.sector->disconnectWayPoints (desc.sector.get ());
+    }
+
+    // Objects leave object tree and pending moves of manager
+    desc.sector->setMapManager (nullptr);
+    desc.sector.reset ();
+
+    m_sector_uses.erase (id);
+    ++m_evicted_sectors;
+
+    return true;
+}
+
+UintRect MapManager::getPrefetchArea (const UintRect& area, Vector2f velocity) const
+{
+    Vector2f shift (velocity * m_prefetch_time);
+
+    float left (std::max (float (area.left) + std::min (shift.x, 0.0f), 0.0f));
+    float top (std::max (float (area.top) + std::min (shift.y, 0.0f), 0.0f));
+    float right (float (area.left) + area.width + std::max (shift.x, 0.0f));
+    float bottom (float (area.top) + area.height + std::max (shift.y, 0.0f));
+
+    return UintRect (uint32_t (left), uint32_t (top), uint32_t (std::ceil (right - left)), uint32_t (std::ceil (bottom - top)));
+}
+
+void MapManager::findWayPointsEdges (const std::vector<uint32_t>& sectors)
+{
+    checkNavigationFrozen ();
+
+    std::vector<uint32_t> neighbours;
+    for (size_t i = 0; i < sectors.size (); ++i)
+    {
+        MapSectorDesc& desc (m_sectors.at (sectors[i]));
+        desc.sector->connectWayPoints ();
+
+        m_sector_index.queryNeighbours (sectors[i], neighbours);
+        for (uint32_t neighbour_id : neighbours)
+        {
+            const MapSectorDesc& neighbour (m_sectors.at (neighbour_id));
+            if (!neighbour.sector)
+                continue;
+
+            // Pair of new sectors is connected only once, when the second one is processed
+            auto pos (std::find (sectors.begin (), sectors.end (), neighbour_id));
+            if (pos != sectors.end () && size_t (pos - sectors.begin ()) > i)
+                continue;
+
+            desc.sector->connectWayPoints (neighbour.sector.get ());
         }
+    }
+}
 
-        closed_points.insert ({ pending_point.point, pending_point.parent });
-        opened_points.erase (point_iterator);
+void MapManager::invalidateWays (const std::vector<uint32_t>& sectors)
+{
+    // Border way points of neighbours get new edges, so their ways may become shorter
+    std::vector<uint32_t> neighbours;
+    for (uint32_t id : sectors)
+    {
+        invalidateSector (id);
+
+        m_sector_index.queryNeighbours (id, neighbours);
+        for (uint32_t neighbour_id : neighbours)
+            invalidateSector (neighbour_id);
     }
+}
 
-    std::deque<Vector2f> points;
+void MapManager::invalidateSector (uint32_t id)
+{
+    m_path_cache.invalidateSector (id);
+
+    for (auto field (m_flow_fields.begin ()); field != m_flow_fields.end ();)
+    {
+        const std::vector<uint32_t>& sectors (field->second.field->getSectors ());
+        if (std::binary_search (sectors.begin (), sectors.end (), id))
+            field = m_flow_fields.erase (field);
+        else
+            ++field;
+    }
+}
+
+void MapManager::updateNavigation ()
+{
+    checkNavigationFrozen ();
+
+    m_walkability_changed = true;
+
+    m_navigation.build (m_sectors);
+
+    if (m_hierarchical_search)
+        m_portals.build (m_navigation);
+    else
+        m_portals.clear ();
+}
+
+void MapManager::updateNavigation (const std::vector<const WayPoint*>& points, const std::vector<uint32_t>& sectors)
+{
+    checkNavigationFrozen ();
+
+    m_walkability_changed = true;
+
+    if (points.empty ())
+        return;
+
+    // Way points of unknown sectors can't be updated in place
+    if (!m_navigation.updateEdges (points))
+    {
+        updateNavigation ();
+        return;
+    }
+
+    if (m_hierarchical_search)
+        m_portals.update (m_navigation, sectors);
+}
+
+void MapManager::updateWalkability () const
+{
+    if (!m_walkability_changed)
+        return;
+
+    Vector2f min (FLT_MAX, FLT_MAX);
+    Vector2f max (-FLT_MAX, -FLT_MAX);
+
+    for (const auto& map : m_sectors)
+    {
+        if (!map.second.sector)
+            continue;
+
+        Vector2f offset (map.second.sector->getOffset ());
+        Vector2u size (map.second.sector->getSize ());
+
+        min.x = std::min (min.x, offset.x);
+        min.y = std::min (min.y, offset.y);
+        max.x = std::max (max.x, offset.x + size.x);
+        max.y = std::max (max.y, offset.y + size.y);
+    }
+
+    if (min.x > max.x)
+    {
+        m_walkability.reset ({ 0.0f, 0.0f }, 0, 0);
+    }
+    else
+    {
+        // Space between loaded sectors stays blocked
+        uint32_t width (static_cast<uint32_t> (std::ceil (max.x - min.x)));
+        uint32_t height (static_cast<uint32_t> (std::ceil (max.y - min.y)));
+        m_walkability.reset (min, width, height, 1.0f, false);
+
+        for (const auto& map : m_sectors)
+        {
+            if (map.second.sector)
+                m_walkability.copy (map.second.sector->getWalkability ());
+        }
+    }
+
+    m_walkability_changed = false;
+}
 
-    const WayPoint* step_departure (opened_points.begin ()->second.parent);
-    const WayPoint* step_target (target_point);
+void MapManager::checkNavigationFrozen () const
+{
+    if (m_navigation_frozen)
+        critical_error ("Edges of way points can't be changed while navigation graph is frozen", std::logic_error);
+}
 
-    while (step_departure != nullptr)
+bool MapManager::findWay (const WayPointID& departure, const WayPointID& target, std::deque<Vector2f>& points) const
+{
+    uint32_t departure_node (m_navigation.getNode (departure));
+    uint32_t target_node (m_navigation.getNode (target));
+
+    if (departure_node == NavigationGraph::INVALID_NODE || target_node == NavigationGraph::INVALID_NODE)
+        return false;
+
+    if (!m_navigation.isConnected (departure_node, target_node))
+        return false;
+
+    const PathCache::WayPoints* cached_points (m_path_cache.find (departure, target));
+    if (cached_points)
     {
-        points.push_front (getWayStep (step_departure, step_target));
+        points = *cached_points;
+        return true;
+    }
 
-        step_target = step_departure;
-        step_departure = closed_points[step_departure];
+    std::vector<uint32_t> sectors;
+    if (!searchWay (departure_node, target_node, m_search, points, sectors))
+        return false;
+
+    m_path_cache.insert (departure, target, points, sectors);
+    return true;
+}
+
+bool MapManager::searchWay (
+    uint32_t departure,
+    uint32_t target,
+    SearchContext& context,
+    std::deque<Vector2f>& points,
+    std::vector<uint32_t>& sectors
+) const
+{
+    bool found (false);
+    if (m_hierarchical_search)
+    {
+        found = m_portals.findCorridor (m_navigation, departure, target, context.corridor, context.portal_search) &&
+            context.path_finder.findPath (m_navigation, departure, target, context.corridor, context.path);
     }
+    else
+    {
+        found = context.path_finder.findPath (m_navigation, departure, target, context.path);
+    }
+
+    if (!found)
+        return false;
 
-    return points;
+    fillWay (context.path, points, sectors);
+    return true;
 }
 
-float MapManager::getDistance (Vector2f p1, Vector2f p2)
+std::shared_ptr<const FlowField> MapManager::findFlowField (const WayPointID& goal) const
 {
-    Vector2f dist (p1 - p2);
-    return sqrt (dist.x * dist.x + dist.y * dist.y);
+    uint32_t goal_node (m_navigation.getNode (goal));
+    if (goal_node == NavigationGraph::INVALID_NODE)
+        return nullptr;
+
+    uint64_t key ((uint64_t (goal.m_map_id) << 32) | goal.m_id);
+    auto cached (m_flow_fields.find (key));
+    if (cached != m_flow_fields.end ())
+    {
+        cached->second.last_use = ++m_flow_field_uses;
+        return cached->second.field;
+    }
+
+    std::shared_ptr<FlowField> field (new FlowField ());
+    field->build (m_navigation, goal_node);
+
+    if (m_flow_field_capacity == 0)
+        return field;
+
+    evictFlowFields (m_flow_field_capacity - 1);
+    m_flow_fields[key] = { field, ++m_flow_field_uses };
+    return field;
 }
 
-Vector2f MapManager::getWayStep (const WayPoint* p1, const WayPoint* p2)
+void MapManager::evictFlowFields (size_t count) const
 {
-    Vector2f start (p1->getPosition ());
-    Vector2f end (p2->getPosition ());
+    while (m_flow_fields.size () > count)
+    {
+        auto oldest (std::min_element (m_flow_fields.begin (), m_flow_fields.end (), [](
+            const std::pair<const uint64_t, FlowFieldEntry>& f1,
+            const std::pair<const uint64_t, FlowFieldEntry>& f2
+        ) { return f1.second.last_use < f2.second.last_use; }));
 
+        m_flow_fields.erase (oldest);
+    }
+}
+
+void MapManager::fillWay (const std::vector<uint32_t>& path, std::deque<Vector2f>& points, std::vector<uint32_t>& sectors) const
+{
+    for (size_t i = 1; i < path.size (); ++i)
+    {
+        points.push_back (getWayStep (
+            m_navigation.getPosition (path[i - 1]),
+            m_navigation.getPosition (path[i]),
+            m_navigation.getRadius (path[i])
+        ));
+    }
+
+    sectors.clear ();
+    for (uint32_t node : path)
+        sectors.push_back (m_navigation.getSectorID (node));
+    std::sort (sectors.begin (), sectors.end ());
+    sectors.erase (std::unique (sectors.begin (), sectors.end ()), sectors.end ());
+}
+
+void MapManager::smoothWay (Vector2f departure, std::deque<Vector2f>& points) const
+{
+    // Every kept point is followed by the farthest point which is visible from it
+    Vector2f anchor (departure);
+    size_t count (0);
+
+    for (size_t i = 0; i < points.size (); ++count)
+    {
+        size_t last (i);
+        while (last + 1 < points.size () && checkPass (anchor, points[last + 1]))
+            ++last;
+
+        anchor = points[last];
+        points[count] = anchor;
+        i = last + 1;
+    }
+
+    points.resize (count);
+}
+
+WayPointID MapManager::findWayPoint (Vector2f position) const
+{
+    std::vector<uint32_t> ids;
+    m_sector_index.queryPoint ({ position.x + m_offset.x, position.y + m_offset.y }, ids);
+
+    for (uint32_t id : ids)
+    {
+        const MapSectorDesc& desc (m_sectors.at (id));
+        if (desc.sector && desc.sector->isObjectInSector (position))
+            return { id, desc.sector->getNearestWayPoint (position) };
+    }
+
+    return WayPointID ();
+}
+
+Vector2f MapManager::getWayStep (Vector2f start, Vector2f end, float radius)
+{
     Vector2f dist (end - start);
 
-    return start + dist * p2->getRadius () / static_cast<float> (sqrt (dist.x * dist.x + dist.y * dist.y));
+    return start + dist * radius / static_cast<float> (sqrt (dist.x * dist.x + dist.y * dist.y));
 }
 
 void MapManager::draw (RenderTarget& target, RenderStates states) const
 {
     for (const auto& sector : m_sectors)
-        target.draw (*sector.second.sector);
+    {
+        if (sector.second.sector)
+            target.draw (*sector.second.sector);
+    }
 }
@@ -61,6 +61,16 @@ void MapObject::setCollision (const Collision& collision)
     m_collision = collision;
 }
 
+const Collision& MapObject::getCollision () const
+{
+    return m_collision;
+}
+
+FloatRect MapObject::getBounds () const
+{
+    return m_collision.getBounds ();
+}
+
 Collision::State MapObject::detectCollision (const MapObject* object) const
 {
     return m_collision.check (object->m_collision);
@@ -30,6 +30,7 @@
 #include "MapSaver.h"
 #include "MapManager.h"
 #include "MapSectorDesc.h"
+#include "SectorFormat.h"
 
 #include <SFGE/Err.h>
 
@@ -110,30 +111,22 @@ bool MapSaver::saveSector (MapSector* sector, const std::string& path)
         return false;
     }
 
-    if (!m_output_stream->write ("Sector\n{\n", 9))
-    {
-        debug_message ("Failed writing open block of sector " + path);
-        return false;
-    }
+    // Sector is written in the same format which loader reads
+    SectorData data;
+    sector->getSectorData (data);
 
-    if (!sector->save (this))
+    if (!SectorFormat::writeText (m_output_stream, data))
     {
         debug_message ("Failed saving sector " + path);
         return false;
     }
 
-    if (!m_output_stream->write ("}\n", 2))
-    {
-        debug_message ("Failed writing close block of sector " + path);
-        return false;
-    }
-
     return true;
 }
 
 bool MapSaver::saveTile (const std::string& texture, const Vector2u pos)
 {
-    if (!m_output_stream->write ("Tile\n{\n", 6))
+    if (!m_output_stream->write ("Tile\n{\n", 7))
     {
         debug_message ("Failed writing header of tile");
         return false;
@@ -1,371 +1,1161 @@
-/////////////////////////////////////////////////////////////////////
-//
-// SFGE - Simple and Fast Game Engine
-//
-// Copyright (c) 2016-2017 DonRumata710 
-// 
-// Permission is hereby granted, free of charge, to any person
-// obtaining a copy of this software and associated documentation
-// files (the "Software"), to deal in the Software without
-// restriction, including without limitation the rights to use, copy,
-// modify, merge, publish, distribute, sublicense, and / or sell
-// copies of the Software, and to permit persons to whom the Software
-// is furnished to do so, subject to the following conditions :
-// 
-// The above copyright notice and this permission notice shall be
-// included in all copies or substantial portions of the Software.
-// 
-// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
-// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
-// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
-// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
-// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
-// WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
-// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
-// DEALINGS IN THE SOFTWARE.
-// 
-/////////////////////////////////////////////////////////////////////
-
-
-#include "MapManager.h"
-#include "MapSector.h"
-#include "MapSaver.h"
-#include "InteractiveObject.h"
-#include "Way.h"
-
-#include <SFGE/GEDevice.h>
-#include <SFGE/ResourceManager.h>
-#include <SFGE/Err.h>
-
-#include <map>
-#include <cfloat>
-
-
-using namespace sfge;
-
-
-MapSector::MapSector (Vector2u size, MapManager* manager) : m_manager (manager)
-{
-    m_size = size;
-    m_tiles.assign (size.x * size.y, Panel ());
-    for (size_t i = 0; i < size.x; ++i)
-    {
-        for (size_t j = 0; j < size.y; ++j)
-        {
-            m_tiles[i + j * size.x].setPosition (i, j);
-            m_tiles[i + j * size.x].setSize (1.0, 1.0);
-        }
-    }
-}
-
-void MapSector::setMapManager (MapManager* manager)
-{
-    m_manager = manager;
-}
-
-void MapSector::setTileSize (Uint32 size)
-{
-    m_tile_size = size;
-}
-
-void MapSector::setTiles (const std::vector<std::pair<uint32_t, std::string>>& tiles)
-{
-    auto device (GEDevice::getInstance ());
-    if (!device)
-    {
-        debug_message ("Game engine device was not created");
-        return;
-    }
-
-    auto rm (GEDevice::getInstance ()->getResourceManager ());
-    if (!rm)
-    {
-        debug_message ("No default resource manager");
-        return;
-    }
-
-    for (const auto tile : tiles)
-    {
-        std::shared_ptr<const Texture> tex (rm->findTexture (tile.second));
-
-        if (tex)
-        {
-            m_textures[tex.get ()] = tile.second;
-            
-            Uint32 width (tex->getSize ().x / m_tile_size);
-            Uint32 height (tex->getSize ().y / m_tile_size);
-
-            for (size_t i = 0; i < width; ++i)
-            {
-                for (size_t j = 0; j < height; ++j)
-                {
-                    Uint32 pos (tile.first + i + j * m_size.x);
-                    if (pos < m_tiles.size ())
-                    {
-                        m_tiles[pos].setTexture (tex);
-                        m_tiles[pos].setTexCoord (IntRect (i * m_tile_size, j * m_tile_size, m_tile_size, m_tile_size));
-                    }
-                }
-            }
-        }
-        else
-        {
-            runtime_message ("Texture was not found");
-        }
-    }
-}
-
-void MapSector::setTileTexture (Vector2u pos, const std::string& texture_name)
-{
-    auto device (GEDevice::getInstance ());
-    if (!device)
-    {
-        debug_message ("Game engine device was not created");
-        return;
-    }
-
-    auto rm (GEDevice::getInstance ()->getResourceManager ());
-    if (!rm)
-    {
-        debug_message ("No default resource manager");
-        return;
-    }
-
-    std::shared_ptr<const Texture> tex (rm->findTexture (texture_name));
-
-    if (tex)
-    {
-        m_textures[tex.get ()] = texture_name;
-
-        Uint32 width (tex->getSize ().x / m_tile_size);
-        Uint32 height (tex->getSize ().y / m_tile_size);
-
-        for (size_t i = 0; i < width; ++i)
-        {
-            for (size_t j = 0; j < height; ++j)
-            {
-                Uint32 tile_pos (i + pos.x + (j + pos.y) * m_size.x);
-                if (tile_pos < m_tiles.size ())
-                {
-                    m_tiles[tile_pos].setTexture (tex);
-                    m_tiles[tile_pos].setTexCoord (IntRect (i * m_tile_size, j * m_tile_size, m_tile_size, m_tile_size));
-                }
-            }
-        }
-    }
-}
-
-void MapSector::setName (const std::string& name)
-{
-    m_name = name;
-}
-
-std::string sfge::MapSector::getName () const
-{
-    return m_name;
-}
-
-void MapSector::setWayPoints (const std::vector<WayPoint>& way_points)
-{
-    m_way_points = way_points;
-}
-
-void MapSector::setWayPoints (std::vector<WayPoint>&& way_points)
-{
-    m_way_points = std::move (way_points);
-}
-
-void sfge::MapSector::setOffset (Vector2f offset)
-{
-    Vector2f move (offset - m_offset);
-
-    for (Panel& tile : m_tiles)
-        tile.move (move);
-    
-    for (auto object : m_objects)
-    {
-        Vector2f pos (object->getPosition ());
-	object->setPosition (pos + move);
-    }
-    
-    for (auto way_point : m_way_points)
-    {
-        Vector2f pos (way_point.getPosition ());
-	way_point.setPosition (pos + move);
-    }
-
-    m_offset = offset;
-}
-
-Vector2f MapSector::getOffset () const
-{
-    return m_offset;
-}
-
-Vector2u MapSector::getSize () const
-{
-    return m_size;
-}
-
-bool MapSector::save (MapSaver* saver)
-{
-    for (const Panel tile : m_tiles)
-    {
-        std::string texture;
-        if (tile.getTexture ())
-        {
-            texture = m_textures[tile.getTexture ().get ()];
-        }
-        if (!saver->saveTile (texture, { (Uint32) tile.getPosition ().x, (Uint32) tile.getPosition ().y }))
-        {
-            runtime_message ("Failed saving tile in pos x = " + std::to_string (tile.getPosition ().x) + " y = " + std::to_string (tile.getPosition ().y));
-            return false;
-        }
-    }
-
-    return true;
-}
-
-bool MapSector::checkMovement (InteractiveObject* moved_object)
-{
-    if (moved_object->getPosition ().x < m_offset.x ||
-        moved_object->getPosition ().y < m_offset.y ||
-        moved_object->getPosition ().x > m_offset.x + m_size.x ||
-        moved_object->getPosition ().y > m_offset.y + m_size.y
-    )
-    {
-        if (!m_manager)
-            critical_error ("Map manager wasn't set", std::runtime_error);
-
-        removeObject (moved_object);
-        moved_object->attachToSector (m_manager->getSector (moved_object->getPosition ()));
-    }
-
-    for (auto object : m_objects)
-    {
-        if (object->detectCollision (moved_object) != Collision::State::OUTSIDE)
-        {
-            moved_object->runAction<CollisionAction> (nullptr);
-            return false;
-        }
-    }
-
-    return true;
-}
-
-uint32_t MapSector::getNearestWayPoint (Vector2f pos) const
-{
-    uint32_t nearest_point (0);
-    float min_distance (FLT_MAX);
-
-    for (size_t i = 0; i < m_way_points.size (); ++i)
-    {
-        float distance (m_way_points[i].checkArea (pos));
-        if (distance < min_distance)
-        {
-            min_distance = distance;
-            nearest_point = static_cast<uint32_t> (i);
-        }
-    }
-
-    return nearest_point;
-}
-
-const WayPoint* MapSector::getWayPoint (uint32_t id) const
-{
-    return &m_way_points[id];
-}
-
-void MapSector::attachObject (std::shared_ptr<MapObject> object)
-{
-    m_objects.push_back (object);
-}
-
-void MapSector::removeObject (const MapObject* object)
-{
-    m_objects.erase (std::remove_if (
-        m_objects.begin (),
-        m_objects.end (),
-        [object](std::shared_ptr<MapObject> obj) { return object == obj.get (); }
-    ));
-}
-
-bool MapSector::isObjectInSector (Vector2f pos) const
-{
-    return pos.x > m_offset.x && pos.y > m_offset.y && pos.x < m_offset.x + m_size.x && pos.y < m_offset.y + m_size.y;
-}
-
-void MapSector::connectWayPoints ()
-{
-    std::vector<WayPoint::EdgeList> neighbours (m_way_points.size ());
-
-    for (size_t i = 0; i < m_way_points.size (); ++i)
-    {
-        for (size_t j = i + 1; j < m_way_points.size (); ++j)
-        {
-            if (checkPass (m_way_points[i].getPosition (), m_way_points[j].getPosition ()))
-            {
-                neighbours[i].push_back (&m_way_points[j]);
-                neighbours[j].push_back (&m_way_points[i]);
-            }
-        }
-
-        m_way_points[i].assignEdges (neighbours[i]);
-    }
-}
-
-void MapSector::connectWayPoints (MapSector* map_sector)
-{
-    std::vector<WayPoint::EdgeList> self_neighbours (m_way_points.size ());
-    std::vector<WayPoint::EdgeList> neighbours (m_way_points.size ());
-
-    for (size_t i = 0; i < m_way_points.size (); ++i)
-    {
-        for (size_t j = 0; j < map_sector->m_way_points.size (); ++j)
-        {
-            if (checkPass (m_way_points[i].getPosition (), map_sector->m_way_points[j].getPosition ()))
-            {
-                self_neighbours[i].push_back (&map_sector->m_way_points[j]);
-                neighbours[j].push_back (&m_way_points[i]);
-            }
-        }
-
-        m_way_points[i].assignEdges (self_neighbours[i]);
-    }
-
-    for (size_t i = 0; i < map_sector->m_way_points.size (); ++i)
-    {
-        map_sector->m_way_points[i].assignEdges (neighbours[i]);
-    }
-}
-
-void MapSector::attachNeighbours (WayPoint* way_point) const
-{
-    WayPoint::EdgeList neighbours;
-
-    for (const WayPoint& point : m_way_points)
-    {
-        if (checkPass (way_point->getPosition (), point.getPosition ()))
-            neighbours.push_back (&point);
-    }
-}
-
-void MapSector::draw (RenderTarget& target, RenderStates states) const
-{
-    for (auto& tile : m_tiles)
-        target.draw (tile, states);
-
-    for (auto object : m_objects)
-        target.draw (*object, states);
-}
-
-bool MapSector::checkPass (Vector2f p1, Vector2f p2) const
-{
-    for (auto object : m_objects)
-    {
-        if (object->detectCollision (p1, p2) != Collision::State::OUTSIDE)
-            return false;
-    }
-
-    return true;
-}
+/////////////////////////////////////////////////////////////////////
+//
+// SFGE - Simple and Fast Game Engine
+//
+// Copyright (c) 2016-2017 DonRumata710 
+// 
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation
+// files (the "Software"), to deal in the Software without
+// restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+// WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+// 
+/////////////////////////////////////////////////////////////////////
+
+
+#include "MapManager.h"
+#include "MapSector.h"
+#include "CollisionKernels.h"
+#include "SectorFormat.h"
+#include "InteractiveObject.h"
+#include "Way.h"
+
+#include <SFGE/GEDevice.h>
+#include <SFGE/ResourceManager.h>
+#include <SFGE/Err.h>
+
+#include <algorithm>
+#include <map>
+#include <cfloat>
+#include <cmath>
+#include <stdexcept>
+
+
+using namespace sfge;
+
+
+namespace
+{
+
+    // Number of cells of object broadphase along the longest side of sector
+    const float OBJECT_GRID_CELLS = 32.0f;
+
+
+    bool isSegmentInRect (Vector2f p1, Vector2f p2, const FloatRect& rect)
+    {
+        float t_min (0.0f);
+        float t_max (1.0f);
+
+        Vector2f dir (p2 - p1);
+        const float starts[2] = { p1.x, p1.y };
+        const float dirs[2] = { dir.x, dir.y };
+        const float mins[2] = { rect.left, rect.top };
+        const float maxs[2] = { rect.left + rect.width, rect.top + rect.height };
+
+        for (int axis = 0; axis < 2; ++axis)
+        {
+            if (dirs[axis] == 0.0f)
+            {
+                if (starts[axis] < mins[axis] || starts[axis] > maxs[axis])
+                    return false;
+                continue;
+            }
+
+            float t1 ((mins[axis] - starts[axis]) / dirs[axis]);
+            float t2 ((maxs[axis] - starts[axis]) / dirs[axis]);
+            if (t1 > t2)
+                std::swap (t1, t2);
+
+            t_min = std::max (t_min, t1);
+            t_max = std::min (t_max, t2);
+            if (t_min > t_max)
+                return false;
+        }
+
+        return true;
+    }
+
+    // Bounds of part of area which is hidden by rect from point. Segment
+    // from point crosses rect only if its end is placed in this part.
+    FloatRect getShadowBounds (Vector2f point, const FloatRect& rect, const FloatRect& area)
+    {
+        const float area_right (area.left + area.width);
+        const float area_bottom (area.top + area.height);
+
+        std::vector<Vector2f> points {
+            { rect.left, rect.top },
+            { rect.left + rect.width, rect.top },
+            { rect.left, rect.top + rect.height },
+            { rect.left + rect.width, rect.top + rect.height }
+        };
+
+        // Rays through corners of rect leave area at borders of shadow
+        for (size_t i = 0; i < 4; ++i)
+        {
+            Vector2f dir (points[i] - point);
+            float exit (FLT_MAX);
+            if (dir.x != 0.0f)
+                exit = std::min (exit, ((dir.x > 0.0f ? area_right : area.left) - point.x) / dir.x);
+            if (dir.y != 0.0f)
+                exit = std::min (exit, ((dir.y > 0.0f ? area_bottom : area.top) - point.y) / dir.y);
+
+            if (exit > 1.0f && exit != FLT_MAX)
+                points.push_back (point + dir * exit);
+        }
+
+        // Shadow may cover corners of area between these rays
+        const Vector2f corners[4] = {
+            { area.left, area.top },
+            { area_right, area.top },
+            { area.left, area_bottom },
+            { area_right, area_bottom }
+        };
+
+        for (const Vector2f& corner : corners)
+        {
+            if (isSegmentInRect (point, corner, rect))
+                points.push_back (corner);
+        }
+
+        Vector2f min (points.front ());
+        Vector2f max (points.front ());
+        for (const Vector2f& p : points)
+        {
+            min.x = std::min (min.x, p.x);
+            min.y = std::min (min.y, p.y);
+            max.x = std::max (max.x, p.x);
+            max.y = std::max (max.y, p.y);
+        }
+
+        return FloatRect (min.x, min.y, max.x - min.x, max.y - min.y);
+    }
+
+    bool setEdge (WayPoint& first, WayPoint& second, bool visible)
+    {
+        if (visible == first.hasEdge (&second))
+            return false;
+
+        if (visible)
+        {
+            first.addEdge (&second);
+            second.addEdge (&first);
+        }
+        else
+        {
+            first.removeEdge (&second);
+            second.removeEdge (&first);
+        }
+
+        return true;
+    }
+
+}
+
+
+MapSector::MapSector (Vector2u size, MapManager* manager) : m_manager (manager)
+{
+    m_size = size;
+    m_tiles.assign (size.x * size.y, Panel ());
+    for (size_t i = 0; i < size.x; ++i)
+    {
+        for (size_t j = 0; j < size.y; ++j)
+        {
+            m_tiles[i + j * size.x].setPosition (i, j);
+            m_tiles[i + j * size.x].setSize (1.0, 1.0);
+        }
+    }
+
+    m_object_index.reset (FloatRect (0.0f, 0.0f, float (size.x), float (size.y)), std::max (size.x, size.y) / OBJECT_GRID_CELLS);
+}
+
+MapSector::~MapSector ()
+{
+    for (const auto& object : m_objects)
+    {
+        if (object->getSector () == this)
+            object->attachToSector (nullptr);
+    }
+}
+
+void MapSector::setMapManager (MapManager* manager)
+{
+    if (m_manager && m_manager != manager)
+    {
+        for (const auto& object : m_objects)
+            m_manager->removeObject (object.get ());
+    }
+
+    m_manager = manager;
+
+    if (m_manager)
+    {
+        for (const auto& object : m_objects)
+            m_manager->insertObject (object.get ());
+    }
+}
+
+void MapSector::setTileSize (Uint32 size)
+{
+    m_tile_size = size;
+}
+
+Uint32 MapSector::getTileSize () const
+{
+    return m_tile_size;
+}
+
+void MapSector::setTiles (const std::vector<std::pair<uint32_t, std::string>>& tiles)
+{
+    auto device (GEDevice::getInstance ());
+    if (!device)
+    {
+        debug_message ("Game engine device was not created");
+        return;
+    }
+
+    auto rm (GEDevice::getInstance ()->getResourceManager ());
+    if (!rm)
+    {
+        debug_message ("No default resource manager");
+        return;
+    }
+
+    for (const auto tile : tiles)
+    {
+        std::shared_ptr<const Texture> tex (rm->findTexture (tile.second));
+
+        if (tex)
+        {
+            m_textures[tex.get ()] = tile.second;
+            placeTexture (tile.first, tex);
+        }
+        else
+        {
+            runtime_message ("Texture was not found");
+        }
+    }
+}
+
+void MapSector::setTiles (const std::vector<std::string>& palette, const uint16_t* tiles)
+{
+    auto device (GEDevice::getInstance ());
+    if (!device)
+    {
+        debug_message ("Game engine device was not created");
+        return;
+    }
+
+    auto rm (GEDevice::getInstance ()->getResourceManager ());
+    if (!rm)
+    {
+        debug_message ("No default resource manager");
+        return;
+    }
+
+    std::vector<std::shared_ptr<const Texture>> textures (palette.size ());
+    for (size_t i = 1; i < palette.size (); ++i)
+    {
+        textures[i] = rm->findTexture (palette[i]);
+        if (textures[i])
+            m_textures[textures[i].get ()] = palette[i];
+        else
+            runtime_message ("Texture " + palette[i] + " was not found");
+    }
+
+    for (size_t pos = 0; pos < m_tiles.size (); ++pos)
+    {
+        if (tiles[pos] < textures.size () && textures[tiles[pos]])
+            placeTexture (static_cast<Uint32> (pos), textures[tiles[pos]]);
+    }
+}
+
+void MapSector::setTileTexture (Vector2u pos, const std::string& texture_name)
+{
+    auto device (GEDevice::getInstance ());
+    if (!device)
+    {
+        debug_message ("Game engine device was not created");
+        return;
+    }
+
+    auto rm (GEDevice::getInstance ()->getResourceManager ());
+    if (!rm)
+    {
+        debug_message ("No default resource manager");
+        return;
+    }
+
+    std::shared_ptr<const Texture> tex (rm->findTexture (texture_name));
+
+    if (tex)
+    {
+        m_textures[tex.get ()] = texture_name;
+        placeTexture (pos.x + pos.y * m_size.x, tex);
+
+        m_modified = true;
+    }
+}
+
+void MapSector::setName (const std::string& name)
+{
+    m_name = name;
+}
+
+std::string sfge::MapSector::getName () const
+{
+    return m_name;
+}
+
+void MapSector::setWayPoints (const std::vector<WayPoint>& way_points)
+{
+    m_way_points = way_points;
+    indexWayPoints ();
+    m_modified = true;
+}
+
+void MapSector::setWayPoints (std::vector<WayPoint>&& way_points)
+{
+    m_way_points = std::move (way_points);
+    indexWayPoints ();
+    m_modified = true;
+}
+
+void sfge::MapSector::setOffset (Vector2f offset)
+{
+    Vector2f move (offset - m_offset);
+
+    for (Panel& tile : m_tiles)
+        tile.move (move);
+    
+    for (auto object : m_objects)
+    {
+        Vector2f pos (object->getPosition ());
+	object->setPosition (pos + move);
+
+        if (m_manager)
+            m_manager->moveObject (object.get ());
+    }
+    
+    for (auto& way_point : m_way_points)
+    {
+        Vector2f pos (way_point.getPosition ());
+	way_point.setPosition (pos + move);
+    }
+
+    m_way_point_index.move (move);
+
+    m_object_index.move (move);
+    m_walkability.move (move);
+    for (FloatRect& bounds : m_object_bounds)
+    {
+        bounds.left += move.x;
+        bounds.top += move.y;
+    }
+
+    // Edges of obstacles are stored in coordinates of map, objects don't
+    // report movement by offset
+    for (size_t i = 0; i < m_edge_xs.size (); ++i)
+    {
+        m_edge_xs[i] += move.x;
+        m_edge_ys[i] += move.y;
+    }
+
+    m_offset = offset;
+}
+
+Vector2f MapSector::getOffset () const
+{
+    return m_offset;
+}
+
+Vector2u MapSector::getSize () const
+{
+    return m_size;
+}
+
+void MapSector::setModified (bool modified)
+{
+    m_modified = modified;
+}
+
+bool MapSector::isModified () const
+{
+    return m_modified;
+}
+
+size_t MapSector::getMemoryUsage () const
+{
+    size_t bytes (sizeof (MapSector));
+
+    bytes += m_tiles.capacity () * sizeof (Panel);
+    bytes += m_textures.size () * (sizeof (std::pair<const Texture*, std::string>) + sizeof (void*));
+    for (const auto& texture : m_textures)
+        bytes += texture.second.capacity ();
+
+    bytes += m_objects.capacity () * sizeof (std::shared_ptr<MapObject>);
+    bytes += m_objects.size () * sizeof (MapObject);
+    bytes += m_indexed_objects.capacity () * sizeof (const MapObject*);
+    bytes += m_object_bounds.capacity () * sizeof (FloatRect);
+    bytes += m_free_object_ids.capacity () * sizeof (uint32_t);
+    bytes += m_movement_candidates.capacity () * sizeof (uint32_t);
+    bytes += m_object_ids.size () * (sizeof (std::pair<const MapObject* const, uint32_t>) + sizeof (void*));
+    bytes += (m_edge_xs.capacity () + m_edge_ys.capacity ()) * sizeof (float);
+    bytes += m_edge_ranges.capacity () * sizeof (std::pair<uint32_t, uint32_t>);
+    bytes += m_object_index.getMemoryUsage ();
+    bytes += m_walkability.getMemoryUsage ();
+
+    bytes += m_way_points.capacity () * sizeof (WayPoint);
+    for (const WayPoint& point : m_way_points)
+        bytes += point.getEdges ().capacity () * sizeof (const WayPoint*);
+    bytes += m_way_point_index.getMemoryUsage ();
+
+    return bytes;
+}
+
+void MapSector::getSectorData (SectorData& data) const
+{
+    data = SectorData ();
+    data.name = m_name;
+    data.size = m_size;
+    data.tile_size = m_tile_size;
+    data.tiles.assign (m_tiles.size (), 0);
+
+    // Texture placed to one tile covers the following ones too, so only
+    // the first tile of every covered block is written
+    std::unordered_map<const Texture*, uint16_t> palette;
+    std::vector<char> covered (m_tiles.size (), false);
+
+    for (size_t pos = 0; pos < m_tiles.size (); ++pos)
+    {
+        const Texture* texture (m_tiles[pos].getTexture ().get ());
+        if (!texture || covered[pos])
+            continue;
+
+        auto name (m_textures.find (texture));
+        if (name == m_textures.end ())
+            continue;
+
+        auto id (palette.find (texture));
+        if (id == palette.end ())
+        {
+            id = palette.emplace (texture, static_cast<uint16_t> (data.palette.size ())).first;
+            data.palette.push_back (name->second);
+        }
+
+        data.tiles[pos] = id->second;
+
+        Uint32 width (m_tile_size ? std::max (texture->getSize ().x / m_tile_size, 1u) : 1);
+        Uint32 height (m_tile_size ? std::max (texture->getSize ().y / m_tile_size, 1u) : 1);
+        for (size_t j = 0; j < height; ++j)
+        {
+            for (size_t i = 0; i < width; ++i)
+            {
+                size_t tile_pos (pos + i + j * m_size.x);
+                if (tile_pos < m_tiles.size () && m_tiles[tile_pos].getTexture ().get () == texture)
+                    covered[tile_pos] = true;
+            }
+        }
+    }
+
+    for (const WayPoint& point : m_way_points)
+    {
+        data.way_points.emplace_back ();
+        data.way_points.back ().setPosition (point.getPosition () - m_offset);
+        data.way_points.back ().setRadius (point.getRadius ());
+    }
+
+    for (const auto& object : m_objects)
+    {
+        if (!isObstacle (object.get ()))
+            continue;
+
+        data.objects.push_back (object->getCollision ());
+        data.objects.back ().setPosition (data.objects.back ().getPosition () - m_offset);
+    }
+}
+
+bool MapSector::checkMovement (InteractiveObject* moved_object)
+{
+    MapSector* map_sector (passObject (moved_object));
+    if (!map_sector)
+        return false;
+
+    if (map_sector != this)
+        return map_sector->checkMovement (moved_object);
+
+    FloatRect bounds (moved_object->getBounds ());
+    m_object_index.query (bounds, m_movement_candidates);
+
+    for (uint32_t id : m_movement_candidates)
+    {
+        const MapObject* object (m_indexed_objects[id]);
+        if (object == moved_object || !bounds.intersects (m_object_bounds[id]))
+            continue;
+
+        if (object->detectCollision (moved_object) != Collision::State::OUTSIDE)
+        {
+            moved_object->runAction<CollisionAction> (nullptr);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool MapSector::sweepMovement (const MapObject* moved_object, const Collision& collision, Vector2f vector, float& time, Vector2f& normal) const
+{
+    FloatRect bounds (collision.getBounds ());
+    FloatRect swept (
+        bounds.left + std::min (vector.x, 0.0f) - COLLISION_SKIN,
+        bounds.top + std::min (vector.y, 0.0f) - COLLISION_SKIN,
+        bounds.width + std::abs (vector.x) + 2 * COLLISION_SKIN,
+        bounds.height + std::abs (vector.y) + 2 * COLLISION_SKIN
+    );
+
+    // Path of object may cross border, so objects of neighbour sectors
+    // are taken from tree of manager
+    std::vector<const MapObject*> candidates;
+    if (m_manager)
+    {
+        std::vector<MapObject*> objects (m_manager->queryRect (swept));
+        candidates.assign (objects.begin (), objects.end ());
+    }
+    else
+    {
+        std::vector<uint32_t> ids;
+        m_object_index.query (swept, ids);
+        for (uint32_t id : ids)
+        {
+            if (swept.intersects (m_object_bounds[id]))
+                candidates.push_back (m_indexed_objects[id]);
+        }
+    }
+
+    bool hit (false);
+    time = 1.0f;
+
+    for (const MapObject* object : candidates)
+    {
+        float object_time;
+        Vector2f object_normal;
+        if (object != moved_object &&
+            collision.sweep (object->getCollision (), vector, object_time, object_normal) &&
+            object_time <= time)
+        {
+            time = object_time;
+            normal = object_normal;
+            hit = true;
+        }
+    }
+
+    return hit;
+}
+
+MapSector* MapSector::passObject (InteractiveObject* moved_object)
+{
+    if (!(moved_object->getPosition ().x < m_offset.x ||
+        moved_object->getPosition ().y < m_offset.y ||
+        moved_object->getPosition ().x > m_offset.x + m_size.x ||
+        moved_object->getPosition ().y > m_offset.y + m_size.y))
+        return this;
+
+    if (!m_manager)
+        critical_error ("Map manager wasn't set", std::runtime_error);
+
+    // Objects can't leave loaded part of map
+    MapSector* map_sector (m_manager->getSector (moved_object->getPosition ()));
+    if (map_sector && map_sector != this)
+        transferObject (moved_object, map_sector);
+
+    return map_sector;
+}
+
+uint32_t MapSector::getNearestWayPoint (Vector2f pos) const
+{
+    uint32_t nearest_point (0);
+    float min_distance (FLT_MAX);
+
+    // Every way point is stored in all cells covered by its area, so the
+    // cell of position holds all way points which can contain it
+    for (uint32_t i : m_way_point_index.getCell (pos))
+    {
+        float distance (m_way_points[i].checkArea (pos));
+        if (distance < min_distance)
+        {
+            min_distance = distance;
+            nearest_point = i;
+        }
+    }
+
+    return nearest_point;
+}
+
+std::vector<uint32_t> MapSector::getWayPointsInRadius (Vector2f pos, float radius) const
+{
+    std::vector<uint32_t> way_points;
+    m_way_point_index.query (FloatRect (pos.x - radius, pos.y - radius, radius * 2, radius * 2), way_points);
+
+    auto far_point = [&](uint32_t id)
+    {
+        Vector2f dist (m_way_points[id].getPosition () - pos);
+        return dist.x * dist.x + dist.y * dist.y > radius * radius;
+    };
+
+    way_points.erase (std::remove_if (way_points.begin (), way_points.end (), far_point), way_points.end ());
+    return way_points;
+}
+
+const WayPoint* MapSector::getWayPoint (uint32_t id) const
+{
+    return &m_way_points[id];
+}
+
+uint32_t MapSector::getWayPointsCount () const
+{
+    return static_cast<uint32_t> (m_way_points.size ());
+}
+
+void MapSector::attachObject (std::shared_ptr<MapObject> object)
+{
+    object->attachToSector (this);
+    m_objects.push_back (object);
+    indexObject (object.get ());
+    m_modified = true;
+
+    if (m_walkability_built && isObstacle (object.get ()))
+        m_walkability.rasterize (object->getCollision ());
+
+    if (m_manager)
+    {
+        m_manager->insertObject (object.get ());
+        m_manager->updateSector (this, object->getBounds ());
+    }
+}
+
+void MapSector::removeObject (const MapObject* object)
+{
+    auto id (m_object_ids.find (object));
+    if (id == m_object_ids.end ())
+        return;
+
+    FloatRect bounds (m_object_bounds[id->second]);
+    unindexObject (object);
+    m_modified = true;
+
+    // Sector may be the last owner, so object is kept alive till the end
+    std::shared_ptr<MapObject> owner;
+    auto item (std::find_if (m_objects.begin (), m_objects.end (), [object](const std::shared_ptr<MapObject>& obj)
+    {
+        return obj.get () == object;
+    }));
+
+    if (item != m_objects.end ())
+    {
+        owner = *item;
+        m_objects.erase (item);
+    }
+
+    if (m_walkability_built && isObstacle (object))
+    {
+        // Other objects may cover the same tiles
+        std::vector<uint32_t> neighbours;
+        m_object_index.query (bounds, neighbours);
+
+        m_walkability.clear (bounds);
+        for (uint32_t neighbour : neighbours)
+        {
+            if (isObstacle (m_indexed_objects[neighbour]))
+                m_walkability.rasterize (m_indexed_objects[neighbour]->getCollision ());
+        }
+    }
+
+    if (m_manager)
+    {
+        m_manager->removeObject (object);
+        m_manager->updateSector (this, bounds);
+    }
+}
+
+const WalkabilityGrid& MapSector::getWalkability () const
+{
+    if (!m_walkability_built)
+    {
+        m_walkability.reset (m_offset, m_size.x, m_size.y);
+        for (const auto& object : m_objects)
+        {
+            if (isObstacle (object.get ()))
+                m_walkability.rasterize (object->getCollision ());
+        }
+
+        m_walkability_built = true;
+    }
+
+    return m_walkability;
+}
+
+bool MapSector::hasInteractiveObjects () const
+{
+    return std::any_of (m_objects.begin (), m_objects.end (), [](const std::shared_ptr<MapObject>& object)
+    {
+        return !isObstacle (object.get ());
+    });
+}
+
+void MapSector::updateObject (const MapObject* object)
+{
+    auto id (m_object_ids.find (object));
+    if (id == m_object_ids.end ())
+        return;
+
+    FloatRect bounds (object->getBounds ());
+    m_object_index.update (id->second, m_object_bounds[id->second], bounds);
+    m_object_bounds[id->second] = bounds;
+
+    if (m_manager)
+        m_manager->moveObject (object);
+
+    // Edges of moved object are rewritten in place while layout of arrays is kept
+    if (m_edges_changed)
+        return;
+
+    if (object->getCollision ().getPoints ().size () == m_edge_ranges[id->second].second)
+        setObstacleEdges (id->second);
+    else
+        m_edges_changed = true;
+}
+
+bool MapSector::isObjectInSector (Vector2f pos) const
+{
+    return pos.x > m_offset.x && pos.y > m_offset.y && pos.x < m_offset.x + m_size.x && pos.y < m_offset.y + m_size.y;
+}
+
+void MapSector::connectWayPoints ()
+{
+    checkNavigationFrozen ();
+
+    std::vector<WayPoint::EdgeList> neighbours (m_way_points.size ());
+    std::vector<Segment> segments;
+    std::vector<uint64_t> blocked;
+
+    for (size_t i = 0; i < m_way_points.size (); ++i)
+    {
+        // Segments from way point to all following ones are checked in one batch
+        segments.clear ();
+        for (size_t j = i + 1; j < m_way_points.size (); ++j)
+            segments.emplace_back (m_way_points[i].getPosition (), m_way_points[j].getPosition ());
+
+        checkPass (segments, blocked);
+
+        for (size_t k = 0; k < segments.size (); ++k)
+        {
+            if (blocked[k / 64] & (uint64_t (1) << (k % 64)))
+                continue;
+
+            size_t j (i + 1 + k);
+            neighbours[i].push_back (&m_way_points[j]);
+            neighbours[j].push_back (&m_way_points[i]);
+        }
+
+        m_way_points[i].assignEdges (neighbours[i]);
+    }
+}
+
+void MapSector::connectWayPoints (MapSector* map_sector)
+{
+    checkNavigationFrozen ();
+
+    std::vector<uint32_t> self_border (getBorderWayPoints ());
+    std::vector<uint32_t> border (map_sector->getBorderWayPoints ());
+
+    std::vector<WayPoint::EdgeList> self_neighbours (self_border.size ());
+    std::vector<WayPoint::EdgeList> neighbours (border.size ());
+    std::vector<Segment> segments;
+    std::vector<uint64_t> self_blocked;
+    std::vector<uint64_t> blocked;
+
+    for (size_t i = 0; i < self_border.size (); ++i)
+    {
+        WayPoint& self_point (m_way_points[self_border[i]]);
+
+        segments.clear ();
+        for (size_t j = 0; j < border.size (); ++j)
+            segments.emplace_back (self_point.getPosition (), map_sector->m_way_points[border[j]].getPosition ());
+
+        // Edge may cross obstacles of both sectors
+        checkPass (segments, self_blocked);
+        map_sector->checkPass (segments, blocked);
+
+        for (size_t j = 0; j < border.size (); ++j)
+        {
+            if ((self_blocked[j / 64] | blocked[j / 64]) & (uint64_t (1) << (j % 64)))
+                continue;
+
+            WayPoint& point (map_sector->m_way_points[border[j]]);
+            self_neighbours[i].push_back (&point);
+            neighbours[j].push_back (&self_point);
+        }
+
+        self_point.addEdges (self_neighbours[i]);
+    }
+
+    for (size_t i = 0; i < border.size (); ++i)
+    {
+        map_sector->m_way_points[border[i]].addEdges (neighbours[i]);
+    }
+}
+
+void MapSector::disconnectWayPoints (const MapSector* map_sector)
+{
+    checkNavigationFrozen ();
+
+    const WayPoint* first (map_sector->m_way_points.data ());
+    const WayPoint* last (first + map_sector->m_way_points.size ());
+
+    for (WayPoint& point : m_way_points)
+        point.removeEdges (first, last);
+}
+
+void MapSector::updateEdges (const FloatRect& area, std::vector<const WayPoint*>& changed)
+{
+    checkNavigationFrozen ();
+
+    FloatRect points_area (getWayPointsArea ());
+    std::vector<uint32_t> points;
+    std::vector<uint32_t> candidates;
+
+    for (uint32_t i = 0; i < m_way_points.size (); ++i)
+    {
+        Vector2f p1 (m_way_points[i].getPosition ());
+
+        // Only way points behind area can form segments crossing it
+        m_way_point_index.query (getShadowBounds (p1, area, points_area), points);
+
+        for (uint32_t j : points)
+        {
+            Vector2f p2 (m_way_points[j].getPosition ());
+
+            if (j > i && isSegmentInRect (p1, p2, area) &&
+                setEdge (m_way_points[i], m_way_points[j], checkPass (p1, p2, candidates)))
+            {
+                changed.push_back (&m_way_points[i]);
+                changed.push_back (&m_way_points[j]);
+            }
+        }
+    }
+}
+
+void MapSector::updateEdges (MapSector* map_sector, const FloatRect& area, std::vector<const WayPoint*>& changed)
+{
+    checkNavigationFrozen ();
+
+    std::vector<uint32_t> self_border (getBorderWayPoints ());
+    std::vector<uint32_t> border (map_sector->getBorderWayPoints ());
+    FloatRect points_area (map_sector->getWayPointsArea ());
+    std::vector<uint32_t> points;
+    std::vector<uint32_t> candidates;
+
+    for (uint32_t self_id : self_border)
+    {
+        WayPoint& self_point (m_way_points[self_id]);
+        Vector2f p1 (self_point.getPosition ());
+
+        map_sector->m_way_point_index.query (getShadowBounds (p1, area, points_area), points);
+
+        for (uint32_t id : points)
+        {
+            WayPoint& point (map_sector->m_way_points[id]);
+            Vector2f p2 (point.getPosition ());
+
+            if (std::binary_search (border.begin (), border.end (), id) && isSegmentInRect (p1, p2, area) &&
+                setEdge (self_point, point, checkPass (p1, p2, candidates) && map_sector->checkPass (p1, p2, candidates)))
+            {
+                changed.push_back (&self_point);
+                changed.push_back (&point);
+            }
+        }
+    }
+}
+
+void MapSector::setBorderWidth (float width)
+{
+    m_border_width = width;
+}
+
+std::vector<uint32_t> MapSector::getBorderWayPoints () const
+{
+    std::vector<uint32_t> border;
+
+    for (size_t i = 0; i < m_way_points.size (); ++i)
+    {
+        Vector2f pos (m_way_points[i].getPosition () - m_offset);
+
+        float distance (std::min (
+            std::min (pos.x, m_size.x - pos.x),
+            std::min (pos.y, m_size.y - pos.y)
+        ));
+
+        if (distance <= m_way_points[i].getRadius () + m_border_width)
+            border.push_back (static_cast<uint32_t> (i));
+    }
+
+    return border;
+}
+
+void MapSector::attachNeighbours (WayPoint* way_point) const
+{
+    WayPoint::EdgeList neighbours;
+
+    for (const WayPoint& point : m_way_points)
+    {
+        if (checkPass (way_point->getPosition (), point.getPosition ()))
+            neighbours.push_back (&point);
+    }
+}
+
+void MapSector::draw (RenderTarget& target, RenderStates states) const
+{
+    for (auto& tile : m_tiles)
+        target.draw (tile, states);
+
+    for (auto object : m_objects)
+        target.draw (*object, states);
+}
+
+bool MapSector::checkPass (Vector2f p1, Vector2f p2) const
+{
+    std::vector<uint32_t> candidates;
+    return checkPass (p1, p2, candidates);
+}
+
+bool MapSector::checkPass (Vector2f p1, Vector2f p2, std::vector<uint32_t>& candidates) const
+{
+    updateObstacleEdges ();
+    m_object_index.querySegment (p1, p2, candidates);
+
+    for (uint32_t id : candidates)
+    {
+        const auto& range (m_edge_ranges[id]);
+        if (crossSegment (&m_edge_xs[range.first], &m_edge_ys[range.first], range.second, Vector2f (), p1, p2))
+            return false;
+    }
+
+    return true;
+}
+
+void MapSector::checkPass (const std::vector<Segment>& segments, std::vector<uint64_t>& blocked) const
+{
+    blocked.assign ((segments.size () + 63) / 64, 0);
+
+    updateObstacleEdges ();
+
+    // Pairs of object and segment are sorted by object, so edges of every
+    // object are loaded once and checked against all its segments
+    std::vector<uint32_t> candidates;
+    std::vector<std::pair<uint32_t, uint32_t>> pairs;
+    for (size_t i = 0; i < segments.size (); ++i)
+    {
+        m_object_index.querySegment (segments[i].first, segments[i].second, candidates);
+        for (uint32_t id : candidates)
+            pairs.emplace_back (id, static_cast<uint32_t> (i));
+    }
+
+    std::sort (pairs.begin (), pairs.end ());
+
+    for (const auto& pair : pairs)
+    {
+        uint32_t i (pair.second);
+        if (blocked[i / 64] & (uint64_t (1) << (i % 64)))
+            continue;
+
+        const auto& range (m_edge_ranges[pair.first]);
+        if (crossSegment (&m_edge_xs[range.first], &m_edge_ys[range.first], range.second, Vector2f (), segments[i].first, segments[i].second))
+            blocked[i / 64] |= uint64_t (1) << (i % 64);
+    }
+}
+
+FloatRect MapSector::getWayPointsArea () const
+{
+    // Way points may be placed outside of sector, they are kept in border
+    // cells of index then
+    FloatRect area (m_way_point_index.getArea ());
+    float right (area.left + area.width);
+    float bottom (area.top + area.height);
+
+    for (const WayPoint& point : m_way_points)
+    {
+        Vector2f pos (point.getPosition ());
+        area.left = std::min (area.left, pos.x);
+        area.top = std::min (area.top, pos.y);
+        right = std::max (right, pos.x);
+        bottom = std::max (bottom, pos.y);
+    }
+
+    area.width = right - area.left;
+    area.height = bottom - area.top;
+    return area;
+}
+
+void MapSector::placeTexture (Uint32 pos, const std::shared_ptr<const Texture>& texture)
+{
+    // Texture may cover many tiles, every tile gets its part of texture
+    Uint32 width (texture->getSize ().x / m_tile_size);
+    Uint32 height (texture->getSize ().y / m_tile_size);
+
+    for (size_t i = 0; i < width; ++i)
+    {
+        for (size_t j = 0; j < height; ++j)
+        {
+            Uint32 tile_pos (pos + i + j * m_size.x);
+            if (tile_pos < m_tiles.size ())
+            {
+                m_tiles[tile_pos].setTexture (texture);
+                m_tiles[tile_pos].setTexCoord (IntRect (i * m_tile_size, j * m_tile_size, m_tile_size, m_tile_size));
+            }
+        }
+    }
+}
+
+bool MapSector::isObstacle (const MapObject* object)
+{
+    // Interactive objects move, so tiles under them aren't blocked for good
+    return !dynamic_cast<const InteractiveObject*> (object);
+}
+
+void MapSector::checkNavigationFrozen () const
+{
+    if (m_manager && m_manager->isNavigationFrozen ())
+        critical_error ("Edges of way points can't be changed while navigation graph is frozen", std::logic_error);
+}
+
+void MapSector::indexWayPoints ()
+{
+    float radius_sum (0.0f);
+    for (const WayPoint& point : m_way_points)
+        radius_sum += point.getRadius ();
+
+    float cell_size (m_way_points.empty () ? 1.0f : radius_sum * 2 / m_way_points.size ());
+    m_way_point_index.reset (FloatRect (m_offset.x, m_offset.y, float (m_size.x), float (m_size.y)), cell_size);
+
+    for (size_t i = 0; i < m_way_points.size (); ++i)
+    {
+        Vector2f pos (m_way_points[i].getPosition ());
+        float radius (m_way_points[i].getRadius ());
+        m_way_point_index.insert (static_cast<uint32_t> (i), FloatRect (pos.x - radius, pos.y - radius, radius * 2, radius * 2));
+    }
+}
+
+void MapSector::indexObject (const MapObject* object)
+{
+    uint32_t id;
+    if (m_free_object_ids.empty ())
+    {
+        id = static_cast<uint32_t> (m_indexed_objects.size ());
+        m_indexed_objects.push_back (object);
+        m_object_bounds.push_back (object->getBounds ());
+    }
+    else
+    {
+        id = m_free_object_ids.back ();
+        m_free_object_ids.pop_back ();
+        m_indexed_objects[id] = object;
+        m_object_bounds[id] = object->getBounds ();
+    }
+
+    m_object_ids[object] = id;
+    m_object_index.insert (id, m_object_bounds[id]);
+    m_edges_changed = true;
+}
+
+void MapSector::unindexObject (const MapObject* object)
+{
+    auto id (m_object_ids.find (object));
+    if (id == m_object_ids.end ())
+        return;
+
+    m_object_index.remove (id->second, m_object_bounds[id->second]);
+    m_indexed_objects[id->second] = nullptr;
+    m_free_object_ids.push_back (id->second);
+    m_object_ids.erase (id);
+    m_edges_changed = true;
+}
+
+void MapSector::transferObject (InteractiveObject* object, MapSector* map_sector)
+{
+    // Owner is kept alive while object is passed between sectors
+    std::shared_ptr<MapObject> owner;
+    auto item (std::find_if (m_objects.begin (), m_objects.end (), [object](const std::shared_ptr<MapObject>& obj)
+    {
+        return obj.get () == object;
+    }));
+
+    if (item != m_objects.end ())
+    {
+        owner = *item;
+        m_objects.erase (item);
+    }
+
+    // Moving objects don't change edges of way points, so navigation
+    // isn't updated like it is done by attachObject and removeObject
+    unindexObject (object);
+
+    if (owner)
+        map_sector->m_objects.push_back (owner);
+    map_sector->indexObject (object);
+    object->attachToSector (map_sector);
+}
+
+void MapSector::updateObstacleEdges () const
+{
+    if (!m_edges_changed)
+        return;
+
+    m_edge_xs.clear ();
+    m_edge_ys.clear ();
+    m_edge_ranges.assign (m_indexed_objects.size (), { 0, 0 });
+
+    for (uint32_t id = 0; id < m_indexed_objects.size (); ++id)
+    {
+        if (!m_indexed_objects[id])
+            continue;
+
+        // Closing vertex is stored too, so range holds one vertex more than edges
+        size_t count (m_indexed_objects[id]->getCollision ().getPoints ().size ());
+        m_edge_ranges[id] = { static_cast<uint32_t> (m_edge_xs.size ()), static_cast<uint32_t> (count) };
+        m_edge_xs.resize (m_edge_xs.size () + count + 1);
+        m_edge_ys.resize (m_edge_ys.size () + count + 1);
+        setObstacleEdges (id);
+    }
+
+    m_edges_changed = false;
+}
+
+void MapSector::setObstacleEdges (uint32_t id) const
+{
+    const Collision& collision (m_indexed_objects[id]->getCollision ());
+    const Circuit& points (collision.getPoints ());
+    const auto& range (m_edge_ranges[id]);
+
+    if (points.empty ())
+        return;
+
+    for (uint32_t i = 0; i <= range.second; ++i)
+    {
+        Vector2f point (points[i % points.size ()] + collision.getPosition ());
+        m_edge_xs[range.first + i] = point.x;
+        m_edge_ys[range.first + i] = point.y;
+    }
+}
@@ -0,0 +1,425 @@
+/////////////////////////////////////////////////////////////////////
+//
+// SFGE - Simple and Fast Game Engine
+//
+// Copyright (c) 2016-2017 DonRumata710 
+// 
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation
+// files (the "Software"), to deal in the Software without
+// restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+// WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+// 
+/////////////////////////////////////////////////////////////////////
+
+
+#include "NavigationGraph.h"
+
+#include <algorithm>
+#include <functional>
+#include <cmath>
+
+
+using namespace sfge;
+
+
+void NavigationGraph::build (const std::unordered_map<uint32_t, MapSectorDesc>& sectors)
+{
+    std::vector<uint32_t> old_offsets;
+    std::vector<uint32_t> old_targets;
+    std::vector<Vector2f> old_positions;
+    std::unordered_map<uint32_t, std::pair<uint32_t, uint32_t>> old_ranges;
+
+    old_offsets.swap (m_edge_offsets);
+    old_targets.swap (m_edge_targets);
+    old_positions.swap (m_positions);
+    old_ranges.swap (m_sector_ranges);
+
+    reset ();
+    ++m_version;
+
+    std::vector<uint32_t> sector_ids;
+    for (const auto& sector : sectors)
+    {
+        if (sector.second.sector)
+            sector_ids.push_back (sector.first);
+    }
+    std::sort (sector_ids.begin (), sector_ids.end ());
+
+    std::unordered_map<const WayPoint*, uint32_t> nodes;
+
+    for (uint32_t sector_id : sector_ids)
+    {
+        const MapSector* sector (sectors.at (sector_id).sector.get ());
+        uint32_t begin (static_cast<uint32_t> (m_positions.size ()));
+
+        for (uint32_t i = 0; i < sector->getWayPointsCount (); ++i)
+        {
+            const WayPoint* point (sector->getWayPoint (i));
+            nodes[point] = static_cast<uint32_t> (m_positions.size ());
+            m_positions.push_back (point->getPosition ());
+            m_radiuses.push_back (point->getRadius ());
+            m_node_sectors.push_back (sector_id);
+        }
+
+        m_sector_ranges[sector_id] = { begin, static_cast<uint32_t> (m_positions.size ()) };
+        if (sector->getWayPointsCount () > 0)
+            m_point_ranges.push_back ({ sector->getWayPoint (0), begin });
+    }
+
+    std::sort (m_point_ranges.begin (), m_point_ranges.end (), [](const std::pair<const WayPoint*, uint32_t>& a, const std::pair<const WayPoint*, uint32_t>& b)
+    {
+        return std::less<const WayPoint*> () (a.first, b.first);
+    });
+
+    m_edge_offsets.reserve (m_positions.size () + 1);
+    m_edge_offsets.push_back (0);
+
+    for (uint32_t sector_id : sector_ids)
+    {
+        const MapSector* sector (sectors.at (sector_id).sector.get ());
+
+        for (uint32_t i = 0; i < sector->getWayPointsCount (); ++i)
+        {
+            const WayPoint* point (sector->getWayPoint (i));
+
+            for (const WayPoint* neighbour : point->getEdges ())
+            {
+                auto node (nodes.find (neighbour));
+                if (node == nodes.end ())
+                    continue;
+
+                Vector2f dist (neighbour->getPosition () - point->getPosition ());
+                m_edge_targets.push_back (node->second);
+                m_edge_costs.push_back (sqrt (dist.x * dist.x + dist.y * dist.y));
+            }
+
+            m_edge_offsets.push_back (static_cast<uint32_t> (m_edge_targets.size ()));
+        }
+    }
+
+    findComponents ();
+    recordChanges (old_offsets, old_targets, old_positions, old_ranges);
+}
+
+bool NavigationGraph::updateEdges (const std::vector<const WayPoint*>& points)
+{
+    std::vector<std::pair<uint32_t, const WayPoint*>> changed;
+    for (const WayPoint* point : points)
+    {
+        uint32_t node (findNode (point));
+        if (node == INVALID_NODE)
+            return false;
+
+        changed.push_back ({ node, point });
+    }
+
+    std::sort (changed.begin (), changed.end ());
+    changed.erase (std::unique (changed.begin (), changed.end ()), changed.end ());
+
+    if (changed.empty ())
+        return true;
+
+    ++m_version;
+
+    std::vector<uint32_t> offsets;
+    std::vector<uint32_t> targets;
+    std::vector<float> costs;
+    offsets.reserve (m_edge_offsets.size ());
+    targets.reserve (m_edge_targets.size ());
+    costs.reserve (m_edge_costs.size ());
+    offsets.push_back (0);
+
+    std::vector<uint32_t> old_edges;
+    std::vector<uint32_t> new_edges;
+    auto next (changed.begin ());
+
+    for (uint32_t node = 0; node < m_positions.size (); ++node)
+    {
+        uint32_t begin (m_edge_offsets[node]);
+        uint32_t end (m_edge_offsets[node + 1]);
+
+        if (next == changed.end () || next->first != node)
+        {
+            targets.insert (targets.end (), m_edge_targets.begin () + begin, m_edge_targets.begin () + end);
+            costs.insert (costs.end (), m_edge_costs.begin () + begin, m_edge_costs.begin () + end);
+            offsets.push_back (static_cast<uint32_t> (targets.size ()));
+            continue;
+        }
+
+        const WayPoint* point (next->second);
+        ++next;
+
+        uint32_t first (static_cast<uint32_t> (targets.size ()));
+        for (const WayPoint* neighbour : point->getEdges ())
+        {
+            uint32_t target (findNode (neighbour));
+            if (target == INVALID_NODE)
+                continue;
+
+            Vector2f dist (neighbour->getPosition () - point->getPosition ());
+            targets.push_back (target);
+            costs.push_back (sqrt (dist.x * dist.x + dist.y * dist.y));
+        }
+        offsets.push_back (static_cast<uint32_t> (targets.size ()));
+
+        old_edges.assign (m_edge_targets.begin () + begin, m_edge_targets.begin () + end);
+        new_edges.assign (targets.begin () + first, targets.end ());
+        std::sort (old_edges.begin (), old_edges.end ());
+        std::sort (new_edges.begin (), new_edges.end ());
+
+        if (old_edges != new_edges)
+            m_changes.push_back ({ m_version, node });
+    }
+
+    m_edge_offsets.swap (offsets);
+    m_edge_targets.swap (targets);
+    m_edge_costs.swap (costs);
+
+    // Log of changes is bounded in the same way as on rebuild
+    if (m_changes.size () > m_positions.size () * 4 + 64)
+    {
+        m_layout_version = m_version;
+        m_changes.clear ();
+    }
+
+    findComponents ();
+    return true;
+}
+
+void NavigationGraph::clear ()
+{
+    reset ();
+
+    ++m_version;
+    m_layout_version = m_version;
+    m_changes.clear ();
+}
+
+void NavigationGraph::move (Vector2f offset)
+{
+    for (Vector2f& position : m_positions)
+        position += offset;
+}
+
+void NavigationGraph::reset ()
+{
+    m_edge_offsets.clear ();
+    m_edge_targets.clear ();
+    m_edge_costs.clear ();
+    m_positions.clear ();
+    m_radiuses.clear ();
+    m_node_sectors.clear ();
+    m_components.clear ();
+    m_sector_ranges.clear ();
+    m_point_ranges.clear ();
+}
+
+size_t NavigationGraph::getNodeCount () const
+{
+    return m_positions.size ();
+}
+
+uint32_t NavigationGraph::getVersion () const
+{
+    return m_version;
+}
+
+uint32_t NavigationGraph::getLayoutVersion () const
+{
+    return m_layout_version;
+}
+
+bool NavigationGraph::getChangedNodes (uint32_t version, std::vector<uint32_t>& nodes) const
+{
+    nodes.clear ();
+
+    if (version < m_layout_version || version > m_version)
+        return false;
+
+    auto change (std::upper_bound (m_changes.begin (), m_changes.end (), version, [](uint32_t v, const std::pair<uint32_t, uint32_t>& c)
+    {
+        return v < c.first;
+    }));
+
+    for (; change != m_changes.end (); ++change)
+        nodes.push_back (change->second);
+
+    std::sort (nodes.begin (), nodes.end ());
+    nodes.erase (std::unique (nodes.begin (), nodes.end ()), nodes.end ());
+    return true;
+}
+
+uint32_t NavigationGraph::getNode (const WayPointID& id) const
+{
+    auto range (m_sector_ranges.find (id.m_map_id));
+    if (range == m_sector_ranges.end () || id.m_id >= range->second.second - range->second.first)
+        return INVALID_NODE;
+
+    return range->second.first + id.m_id;
+}
+
+WayPointID NavigationGraph::getWayPointID (uint32_t node) const
+{
+    uint32_t sector_id (m_node_sectors[node]);
+    return { sector_id, node - getSectorBegin (sector_id) };
+}
+
+uint32_t NavigationGraph::getSectorID (uint32_t node) const
+{
+    return m_node_sectors[node];
+}
+
+uint32_t NavigationGraph::getComponent (uint32_t node) const
+{
+    return m_components[node];
+}
+
+bool NavigationGraph::isConnected (uint32_t first, uint32_t second) const
+{
+    return m_components[first] == m_components[second];
+}
+
+uint32_t NavigationGraph::getSectorBegin (uint32_t sector_id) const
+{
+    auto range (m_sector_ranges.find (sector_id));
+    return range != m_sector_ranges.end () ? range->second.first : 0;
+}
+
+uint32_t NavigationGraph::getSectorEnd (uint32_t sector_id) const
+{
+    auto range (m_sector_ranges.find (sector_id));
+    return range != m_sector_ranges.end () ? range->second.second : 0;
+}
+
+Vector2f NavigationGraph::getPosition (uint32_t node) const
+{
+    return m_positions[node];
+}
+
+float NavigationGraph::getRadius (uint32_t node) const
+{
+    return m_radiuses[node];
+}
+
+uint32_t NavigationGraph::getEdgeBegin (uint32_t node) const
+{
+    return m_edge_offsets[node];
+}
+
+uint32_t NavigationGraph::getEdgeEnd (uint32_t node) const
+{
+    return m_edge_offsets[node + 1];
+}
+
+uint32_t NavigationGraph::getEdgeTarget (uint32_t edge) const
+{
+    return m_edge_targets[edge];
+}
+
+float NavigationGraph::getEdgeCost (uint32_t edge) const
+{
+    return m_edge_costs[edge];
+}
+
+void NavigationGraph::findComponents ()
+{
+    // Union-find over edges; edges are treated as undirected, so nodes
+    // with different labels are never connected
+    m_components.resize (m_positions.size ());
+    for (uint32_t node = 0; node < m_components.size (); ++node)
+        m_components[node] = node;
+
+    auto find_root = [this](uint32_t node)
+    {
+        while (m_components[node] != node)
+        {
+            m_components[node] = m_components[m_components[node]];
+            node = m_components[node];
+        }
+        return node;
+    };
+
+    for (uint32_t node = 0; node < m_components.size (); ++node)
+    {
+        for (uint32_t edge = m_edge_offsets[node]; edge < m_edge_offsets[node + 1]; ++edge)
+        {
+            uint32_t first (find_root (node));
+            uint32_t second (find_root (m_edge_targets[edge]));
+
+            if (first < second)
+                m_components[second] = first;
+            else if (second < first)
+                m_components[first] = second;
+        }
+    }
+
+    for (uint32_t node = 0; node < m_components.size (); ++node)
+        m_components[node] = find_root (node);
+}
+
+uint32_t NavigationGraph::findNode (const WayPoint* point) const
+{
+    std::less<const WayPoint*> less;
+
+    auto range (std::upper_bound (m_point_ranges.begin (), m_point_ranges.end (), point, [&less](const WayPoint* p, const std::pair<const WayPoint*, uint32_t>& r)
+    {
+        return less (p, r.first);
+    }));
+
+    if (range == m_point_ranges.begin ())
+        return INVALID_NODE;
+    --range;
+
+    uint32_t begin (range->second);
+    uint32_t count (getSectorEnd (m_node_sectors[begin]) - begin);
+    if (!less (point, range->first + count))
+        return INVALID_NODE;
+
+    return begin + static_cast<uint32_t> (point - range->first);
+}
+
+void NavigationGraph::recordChanges (
+    const std::vector<uint32_t>& old_offsets,
+    const std::vector<uint32_t>& old_targets,
+    const std::vector<Vector2f>& old_positions,
+    const std::unordered_map<uint32_t, std::pair<uint32_t, uint32_t>>& old_ranges
+)
+{
+    // Log of changes is bounded: too long log is replaced by change of layout
+    if (old_ranges != m_sector_ranges || old_positions.size () != m_positions.size () ||
+        m_changes.size () > m_positions.size () * 4 + 64)
+    {
+        m_layout_version = m_version;
+        m_changes.clear ();
+        return;
+    }
+
+    std::vector<uint32_t> old_edges;
+    std::vector<uint32_t> new_edges;
+
+    for (uint32_t node = 0; node < m_positions.size (); ++node)
+    {
+        old_edges.assign (old_targets.begin () + old_offsets[node], old_targets.begin () + old_offsets[node + 1]);
+        new_edges.assign (m_edge_targets.begin () + m_edge_offsets[node], m_edge_targets.begin () + m_edge_offsets[node + 1]);
+        std::sort (old_edges.begin (), old_edges.end ());
+        std::sort (new_edges.begin (), new_edges.end ());
+
+        if (old_edges != new_edges || old_positions[node] != m_positions[node])
+            m_changes.push_back ({ m_version, node });
+    }
+}
@@ -0,0 +1,166 @@
+/////////////////////////////////////////////////////////////////////
+//
+// SFGE - Simple and Fast Game Engine
+//
+// Copyright (c) 2016-2017 DonRumata710 
+// 
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation
+// files (the "Software"), to deal in the Software without
+// restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+// WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+// 
+/////////////////////////////////////////////////////////////////////
+
+
+#include "PathCache.h"
+
+
+using namespace sfge;
+
+
+bool PathCache::Key::operator== (const Key& key) const
+{
+    return departure.m_id == key.departure.m_id && departure.m_map_id == key.departure.m_map_id &&
+        target.m_id == key.target.m_id && target.m_map_id == key.target.m_map_id;
+}
+
+size_t PathCache::KeyHash::operator() (const Key& key) const
+{
+    uint64_t departure ((uint64_t (key.departure.m_map_id) << 32) | key.departure.m_id);
+    uint64_t target ((uint64_t (key.target.m_map_id) << 32) | key.target.m_id);
+
+    std::hash<uint64_t> hash;
+    size_t seed (hash (departure));
+    return seed ^ (hash (target) + 0x9e3779b9 + (seed << 6) + (seed >> 2));
+}
+
+
+PathCache::PathCache (size_t capacity) :
+    m_capacity (capacity)
+{}
+
+void PathCache::setCapacity (size_t capacity)
+{
+    m_capacity = capacity;
+
+    while (m_entries.size () > m_capacity)
+        erase (std::prev (m_entries.end ()));
+}
+
+size_t PathCache::getCapacity () const
+{
+    return m_capacity;
+}
+
+size_t PathCache::getSize () const
+{
+    return m_entries.size ();
+}
+
+const PathCache::WayPoints* PathCache::find (const WayPointID& departure, const WayPointID& target)
+{
+    if (m_capacity == 0)
+        return nullptr;
+
+    auto it (m_index.find ({ departure, target }));
+    if (it == m_index.end ())
+    {
+        ++m_misses;
+        return nullptr;
+    }
+
+    ++m_hits;
+    m_entries.splice (m_entries.begin (), m_entries, it->second);
+    return &it->second->points;
+}
+
+void PathCache::insert (const WayPointID& departure, const WayPointID& target, const WayPoints& points, const std::vector<uint32_t>& sectors)
+{
+    if (m_capacity == 0)
+        return;
+
+    Key key { departure, target };
+
+    auto it (m_index.find (key));
+    if (it != m_index.end ())
+        erase (it->second);
+
+    while (m_entries.size () >= m_capacity)
+        erase (std::prev (m_entries.end ()));
+
+    m_entries.push_front ({ key, points, sectors });
+    m_index[key] = m_entries.begin ();
+
+    for (uint32_t sector : sectors)
+        m_sector_ways[sector].insert (key);
+}
+
+void PathCache::invalidateSector (uint32_t sector_id)
+{
+    auto ways (m_sector_ways.find (sector_id));
+    if (ways == m_sector_ways.end ())
+        return;
+
+    std::vector<Key> keys (ways->second.begin (), ways->second.end ());
+    for (const Key& key : keys)
+    {
+        auto it (m_index.find (key));
+        if (it != m_index.end ())
+            erase (it->second);
+    }
+}
+
+void PathCache::clear ()
+{
+    m_entries.clear ();
+    m_index.clear ();
+    m_sector_ways.clear ();
+}
+
+uint64_t PathCache::getHits () const
+{
+    return m_hits;
+}
+
+uint64_t PathCache::getMisses () const
+{
+    return m_misses;
+}
+
+void PathCache::resetCounters ()
+{
+    m_hits = 0;
+    m_misses = 0;
+}
+
+void PathCache::erase (EntryIterator entry)
+{
+    for (uint32_t sector : entry->sectors)
+    {
+        auto ways (m_sector_ways.find (sector));
+        if (ways == m_sector_ways.end ())
+            continue;
+
+        ways->second.erase (entry->key);
+        if (ways->second.empty ())
+            m_sector_ways.erase (ways);
+    }
+
+    m_index.erase (entry->key);
+    m_entries.erase (entry);
+}
@@ -0,0 +1,193 @@
+/////////////////////////////////////////////////////////////////////
+//
+// SFGE - Simple and Fast Game Engine
+//
+// Copyright (c) 2016-2017 DonRumata710 
+// 
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation
+// files (the "Software"), to deal in the Software without
+// restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+// WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+// 
+/////////////////////////////////////////////////////////////////////
+
+
+#include "PathFinder.h"
+#include "NavigationGraph.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+
+using namespace sfge;
+
+
+namespace
+{
+
+    float getDistance (Vector2f p1, Vector2f p2)
+    {
+        Vector2f dist (p1 - p2);
+        return sqrt (dist.x * dist.x + dist.y * dist.y);
+    }
+
+}
+
+
+bool PathFinder::findPath (const NavigationGraph& graph, uint32_t departure, uint32_t target, std::vector<uint32_t>& path)
+{
+    start (graph, departure, target);
+    expand (graph, SIZE_MAX);
+    getPath (path);
+
+    return m_state == State::COMPLETE;
+}
+
+bool PathFinder::findPath (
+    const NavigationGraph& graph,
+    uint32_t departure,
+    uint32_t target,
+    const std::vector<uint32_t>& sectors,
+    std::vector<uint32_t>& path
+)
+{
+    start (graph, departure, target, sectors);
+    expand (graph, SIZE_MAX);
+    getPath (path);
+
+    return m_state == State::COMPLETE;
+}
+
+void PathFinder::start (const NavigationGraph& graph, uint32_t departure, uint32_t target)
+{
+    m_use_sectors = false;
+    prepare (graph, departure, target);
+}
+
+void PathFinder::start (const NavigationGraph& graph, uint32_t departure, uint32_t target, const std::vector<uint32_t>& sectors)
+{
+    m_use_sectors = true;
+    m_sectors.assign (sectors.begin (), sectors.end ());
+    prepare (graph, departure, target);
+}
+
+PathFinder::State PathFinder::expand (const NavigationGraph& graph, size_t max_nodes)
+{
+    for (size_t expanded = 0; m_state == State::PENDING && expanded < max_nodes; ++expanded)
+    {
+        if (m_opened.empty ())
+        {
+            m_state = State::FAILED;
+            break;
+        }
+
+        uint32_t node (m_opened.pop ());
+
+        if (node == m_target)
+        {
+            m_opened.clear ();
+            m_state = State::COMPLETE;
+            break;
+        }
+
+        m_close_marks[node] = m_generation;
+
+        for (uint32_t edge = graph.getEdgeBegin (node); edge < graph.getEdgeEnd (node); ++edge)
+        {
+            uint32_t neighbour (graph.getEdgeTarget (edge));
+            if (m_close_marks[neighbour] == m_generation)
+                continue;
+
+            if (m_use_sectors && !std::binary_search (m_sectors.begin (), m_sectors.end (), graph.getSectorID (neighbour)))
+                continue;
+
+            float passed_dist (m_passed_dist[node] + graph.getEdgeCost (edge));
+
+            if (!isVisited (neighbour) || passed_dist < m_passed_dist[neighbour])
+            {
+                m_visit_marks[neighbour] = m_generation;
+                m_passed_dist[neighbour] = passed_dist;
+                m_parents[neighbour] = node;
+                m_opened.push (neighbour, passed_dist + getDistance (graph.getPosition (neighbour), m_target_pos));
+            }
+        }
+    }
+
+    return m_state;
+}
+
+PathFinder::State PathFinder::getState () const
+{
+    return m_state;
+}
+
+void PathFinder::getPath (std::vector<uint32_t>& path) const
+{
+    path.clear ();
+
+    if (m_state != State::COMPLETE)
+        return;
+
+    for (uint32_t step = m_target; step != NavigationGraph::INVALID_NODE; step = m_parents[step])
+        path.push_back (step);
+    std::reverse (path.begin (), path.end ());
+}
+
+void PathFinder::prepare (const NavigationGraph& graph, uint32_t departure, uint32_t target)
+{
+    m_opened.clear ();
+    m_target = target;
+
+    if (departure >= graph.getNodeCount () || target >= graph.getNodeCount ())
+    {
+        m_state = State::FAILED;
+        return;
+    }
+
+    size_t node_count (graph.getNodeCount ());
+    if (m_passed_dist.size () < node_count)
+    {
+        m_passed_dist.resize (node_count);
+        m_parents.resize (node_count);
+        m_visit_marks.resize (node_count, 0);
+        m_close_marks.resize (node_count, 0);
+    }
+
+    m_opened.reset (node_count);
+
+    if (++m_generation == 0)
+    {
+        std::fill (m_visit_marks.begin (), m_visit_marks.end (), 0);
+        std::fill (m_close_marks.begin (), m_close_marks.end (), 0);
+        m_generation = 1;
+    }
+
+    m_state = State::PENDING;
+    m_target_pos = graph.getPosition (target);
+
+    m_passed_dist[departure] = 0.0f;
+    m_parents[departure] = NavigationGraph::INVALID_NODE;
+    m_visit_marks[departure] = m_generation;
+    m_opened.push (departure, getDistance (graph.getPosition (departure), m_target_pos));
+}
+
+bool PathFinder::isVisited (uint32_t node) const
+{
+    return node < m_visit_marks.size () && m_visit_marks[node] == m_generation;
+}
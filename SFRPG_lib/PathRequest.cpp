@@ -0,0 +1,206 @@
+/////////////////////////////////////////////////////////////////////
+//
+// SFGE - Simple and Fast Game Engine
+//
+// Copyright (c) 2016-2017 DonRumata710 
+// 
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation
+// files (the "Software"), to deal in the Software without
+// restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+// WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+// 
+/////////////////////////////////////////////////////////////////////
+
+
+#include "PathRequest.h"
+#include "MapManager.h"
+#include "Way.h"
+
+#include <SFML/System/Clock.hpp>
+
+#include <algorithm>
+
+
+using namespace sfge;
+
+
+namespace
+{
+
+    // Number of nodes expanded between checks of time limit
+    const size_t TIME_CHECK_STEP = 32;
+
+}
+
+
+PathRequest::PathRequest (const MapManager* manager, Vector2f departure, Vector2f target) :
+    m_manager (manager),
+    m_departure (departure),
+    m_target (target)
+{
+    restart ();
+}
+
+PathRequest::State PathRequest::update (size_t max_nodes, sf::Time max_time)
+{
+    if (m_state != State::PENDING)
+        return m_state;
+
+    const NavigationGraph& graph (m_manager->m_navigation);
+    if (m_graph_version != graph.getVersion ())
+    {
+        if (isSearchChanged ())
+            restart ();
+        else
+            m_graph_version = graph.getVersion ();
+    }
+
+    if (m_state != State::PENDING)
+        return m_state;
+
+    sf::Clock clock;
+
+    if (m_corridor_pending)
+    {
+        if (!findCorridor ())
+            return m_state;
+
+        max_nodes -= std::min (max_nodes, m_portal_search.getExpandedNodes ());
+    }
+
+    while (max_nodes > 0 && m_path_finder.getState () == State::PENDING)
+    {
+        size_t step (max_time == sf::Time::Zero ? max_nodes : std::min (max_nodes, TIME_CHECK_STEP));
+        m_path_finder.expand (graph, step);
+        max_nodes -= step;
+
+        if (max_time != sf::Time::Zero && clock.getElapsedTime () >= max_time)
+            break;
+    }
+
+    if (m_path_finder.getState () != State::PENDING)
+        finish ();
+
+    return m_state;
+}
+
+PathRequest::State PathRequest::getState () const
+{
+    return m_state;
+}
+
+Way PathRequest::getWay () const
+{
+    if (m_state != State::COMPLETE)
+        return Way (std::deque<Vector2f> ());
+
+    Way way (m_points);
+    way.pushPointBack (m_target);
+    return way;
+}
+
+void PathRequest::restart ()
+{
+    const NavigationGraph& graph (m_manager->m_navigation);
+
+    m_graph_version = graph.getVersion ();
+    m_state = State::PENDING;
+    m_points.clear ();
+
+    m_departure_point = m_manager->findWayPoint (m_departure);
+    m_target_point = m_manager->findWayPoint (m_target);
+
+    m_departure_node = graph.getNode (m_departure_point);
+    m_target_node = graph.getNode (m_target_point);
+    m_corridor_pending = false;
+    m_corridor.clear ();
+
+    if (m_departure_node == NavigationGraph::INVALID_NODE ||
+        m_target_node == NavigationGraph::INVALID_NODE ||
+        !graph.isConnected (m_departure_node, m_target_node))
+    {
+        m_state = State::FAILED;
+        return;
+    }
+
+    const PathCache::WayPoints* cached_points (m_manager->m_path_cache.find (m_departure_point, m_target_point));
+    if (cached_points)
+    {
+        m_points = *cached_points;
+        m_state = State::COMPLETE;
+        return;
+    }
+
+    // Corridor is searched by update, so it fits into budget of nodes
+    if (m_manager->m_hierarchical_search)
+        m_corridor_pending = true;
+    else
+        m_path_finder.start (graph, m_departure_node, m_target_node);
+}
+
+bool PathRequest::isSearchChanged ()
+{
+    const NavigationGraph& graph (m_manager->m_navigation);
+
+    // Indices of nodes are changed, so state of search is useless
+    if (!graph.getChangedNodes (m_graph_version, m_changed_nodes))
+        return true;
+
+    if (m_corridor_pending)
+        return false;
+
+    // Nodes which weren't reached yet are read with their new edges when
+    // they are expanded. Changed sector of corridor may not be passable
+    // anymore, so the corridor is searched again.
+    for (uint32_t node : m_changed_nodes)
+    {
+        if (m_path_finder.isVisited (node) ||
+            (!m_corridor.empty () && std::binary_search (m_corridor.begin (), m_corridor.end (), graph.getSectorID (node))))
+            return true;
+    }
+
+    return false;
+}
+
+bool PathRequest::findCorridor ()
+{
+    const NavigationGraph& graph (m_manager->m_navigation);
+
+    m_corridor_pending = false;
+    if (!m_manager->m_portals.findCorridor (graph, m_departure_node, m_target_node, m_corridor, m_portal_search))
+    {
+        m_state = State::FAILED;
+        return false;
+    }
+
+    m_path_finder.start (graph, m_departure_node, m_target_node, m_corridor);
+    return true;
+}
+
+void PathRequest::finish ()
+{
+    m_state = m_path_finder.getState ();
+    if (m_state != State::COMPLETE)
+        return;
+
+    std::vector<uint32_t> sectors;
+    m_path_finder.getPath (m_path);
+    m_manager->fillWay (m_path, m_points, sectors);
+
+    m_manager->m_path_cache.insert (m_departure_point, m_target_point, m_points, sectors);
+}
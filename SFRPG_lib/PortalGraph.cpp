@@ -0,0 +1,387 @@
+/////////////////////////////////////////////////////////////////////
+//
+// SFGE - Simple and Fast Game Engine
+//
+// Copyright (c) 2016-2017 DonRumata710 
+// 
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation
+// files (the "Software"), to deal in the Software without
+// restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+// WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+// 
+/////////////////////////////////////////////////////////////////////
+
+
+#include "PortalGraph.h"
+#include "NavigationGraph.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+
+using namespace sfge;
+
+
+namespace
+{
+
+    float getDistance (Vector2f p1, Vector2f p2)
+    {
+        Vector2f dist (p1 - p2);
+        return sqrt (dist.x * dist.x + dist.y * dist.y);
+    }
+
+}
+
+
+void PortalGraph::build (const NavigationGraph& graph)
+{
+    clear ();
+
+    m_node_portals.assign (graph.getNodeCount (), NavigationGraph::INVALID_NODE);
+    connectPortals (graph, nullptr);
+}
+
+void PortalGraph::update (const NavigationGraph& graph, const std::vector<uint32_t>& sectors)
+{
+    if (m_node_portals.size () != graph.getNodeCount ())
+    {
+        build (graph);
+        return;
+    }
+
+    connectPortals (graph, &sectors);
+}
+
+void PortalGraph::connectPortals (const NavigationGraph& graph, const std::vector<uint32_t>* sectors)
+{
+    std::vector<uint32_t> old_portal_nodes;
+    std::vector<uint32_t> old_node_portals;
+    std::vector<uint32_t> old_offsets;
+    std::vector<uint32_t> old_targets;
+    std::vector<float> old_costs;
+
+    old_portal_nodes.swap (m_portal_nodes);
+    old_node_portals.swap (m_node_portals);
+    old_offsets.swap (m_edge_offsets);
+    old_targets.swap (m_edge_targets);
+    old_costs.swap (m_edge_costs);
+
+    Search search;
+    const uint32_t node_count (static_cast<uint32_t> (graph.getNodeCount ()));
+    m_node_portals.assign (node_count, NavigationGraph::INVALID_NODE);
+
+    std::vector<bool> is_portal (node_count, false);
+    for (uint32_t node = 0; node < node_count; ++node)
+    {
+        for (uint32_t edge = graph.getEdgeBegin (node); edge < graph.getEdgeEnd (node); ++edge)
+        {
+            uint32_t neighbour (graph.getEdgeTarget (edge));
+            if (graph.getSectorID (neighbour) != graph.getSectorID (node))
+            {
+                is_portal[node] = true;
+                is_portal[neighbour] = true;
+            }
+        }
+    }
+
+    // Distances inside sector are copied only if its edges and portals
+    // are the same
+    std::vector<uint32_t> changed_sectors;
+    if (sectors)
+        changed_sectors = *sectors;
+
+    for (uint32_t node = 0; node < node_count; ++node)
+    {
+        if (is_portal[node])
+        {
+            m_node_portals[node] = static_cast<uint32_t> (m_portal_nodes.size ());
+            m_portal_nodes.push_back (node);
+        }
+
+        if (is_portal[node] != (old_node_portals[node] != NavigationGraph::INVALID_NODE))
+            changed_sectors.push_back (graph.getSectorID (node));
+    }
+
+    std::sort (changed_sectors.begin (), changed_sectors.end ());
+    changed_sectors.erase (std::unique (changed_sectors.begin (), changed_sectors.end ()), changed_sectors.end ());
+
+    m_edge_offsets.reserve (m_portal_nodes.size () + 1);
+    m_edge_offsets.push_back (0);
+
+    for (uint32_t portal = 0; portal < m_portal_nodes.size (); ++portal)
+    {
+        uint32_t node (m_portal_nodes[portal]);
+        uint32_t sector_id (graph.getSectorID (node));
+
+        if (sectors && !std::binary_search (changed_sectors.begin (), changed_sectors.end (), sector_id))
+        {
+            uint32_t old_portal (old_node_portals[node]);
+
+            for (uint32_t edge = old_offsets[old_portal]; edge < old_offsets[old_portal + 1]; ++edge)
+            {
+                uint32_t target (old_portal_nodes[old_targets[edge]]);
+                if (graph.getSectorID (target) == sector_id)
+                {
+                    m_edge_targets.push_back (m_node_portals[target]);
+                    m_edge_costs.push_back (old_costs[edge]);
+                }
+            }
+        }
+        else
+        {
+            search.findSectorDistances (graph, node);
+
+            auto first (std::lower_bound (m_portal_nodes.begin (), m_portal_nodes.end (), graph.getSectorBegin (sector_id)));
+            auto last (std::lower_bound (m_portal_nodes.begin (), m_portal_nodes.end (), graph.getSectorEnd (sector_id)));
+
+            for (auto it = first; it != last; ++it)
+            {
+                float distance (search.getSectorDistance (*it));
+                if (*it != node && distance != FLT_MAX)
+                {
+                    m_edge_targets.push_back (m_node_portals[*it]);
+                    m_edge_costs.push_back (distance);
+                }
+            }
+        }
+
+        for (uint32_t edge = graph.getEdgeBegin (node); edge < graph.getEdgeEnd (node); ++edge)
+        {
+            uint32_t neighbour (graph.getEdgeTarget (edge));
+            if (graph.getSectorID (neighbour) != sector_id)
+            {
+                m_edge_targets.push_back (m_node_portals[neighbour]);
+                m_edge_costs.push_back (graph.getEdgeCost (edge));
+            }
+        }
+
+        m_edge_offsets.push_back (static_cast<uint32_t> (m_edge_targets.size ()));
+    }
+}
+
+void PortalGraph::clear ()
+{
+    m_portal_nodes.clear ();
+    m_node_portals.clear ();
+    m_edge_offsets.clear ();
+    m_edge_targets.clear ();
+    m_edge_costs.clear ();
+}
+
+size_t PortalGraph::getPortalCount () const
+{
+    return m_portal_nodes.size ();
+}
+
+bool PortalGraph::findCorridor (
+    const NavigationGraph& graph,
+    uint32_t departure,
+    uint32_t target,
+    std::vector<uint32_t>& sectors,
+    Search& search
+) const
+{
+    sectors.clear ();
+    search.m_expanded = 0;
+
+    if (departure >= graph.getNodeCount () || target >= graph.getNodeCount () || m_node_portals.size () != graph.getNodeCount ())
+        return false;
+
+    const uint32_t start (static_cast<uint32_t> (m_portal_nodes.size ()));
+    const uint32_t goal (start + 1);
+    const Vector2f target_pos (graph.getPosition (target));
+
+    // Connect departure with portals of its sector
+
+    search.m_start_edges.clear ();
+    search.findSectorDistances (graph, departure);
+
+    uint32_t departure_sector (graph.getSectorID (departure));
+    uint32_t target_sector (graph.getSectorID (target));
+
+    for (uint32_t node = graph.getSectorBegin (departure_sector); node < graph.getSectorEnd (departure_sector); ++node)
+    {
+        float distance (search.getSectorDistance (node));
+        if (distance == FLT_MAX)
+            continue;
+
+        if (node == target)
+            search.m_start_edges.push_back ({ goal, distance });
+        else if (m_node_portals[node] != NavigationGraph::INVALID_NODE)
+            search.m_start_edges.push_back ({ m_node_portals[node], distance });
+    }
+
+    // Connect portals of target sector with target
+
+    if (search.m_goal_distances.size () < m_portal_nodes.size ())
+    {
+        search.m_goal_distances.resize (m_portal_nodes.size ());
+        search.m_goal_marks.resize (m_portal_nodes.size (), 0);
+    }
+
+    search.findSectorDistances (graph, target);
+    uint32_t goal_generation (search.m_generation);
+
+    for (uint32_t node = graph.getSectorBegin (target_sector); node < graph.getSectorEnd (target_sector); ++node)
+    {
+        uint32_t portal (m_node_portals[node]);
+        float distance (search.getSectorDistance (node));
+        if (portal != NavigationGraph::INVALID_NODE && distance != FLT_MAX)
+        {
+            search.m_goal_distances[portal] = distance;
+            search.m_goal_marks[portal] = goal_generation;
+        }
+    }
+
+    // A* over portals
+
+    if (search.m_costs.size () < m_portal_nodes.size () + 2)
+    {
+        search.m_costs.resize (m_portal_nodes.size () + 2);
+        search.m_cost_marks.resize (m_portal_nodes.size () + 2, 0);
+        search.m_parents.resize (m_portal_nodes.size () + 2);
+    }
+
+    uint32_t generation (search.nextGeneration ());
+    search.m_heap.reset (m_portal_nodes.size () + 2);
+
+    auto relax = [&](uint32_t from, uint32_t to, float cost)
+    {
+        if (search.m_cost_marks[to] == generation && search.m_costs[to] <= cost)
+            return;
+
+        search.m_cost_marks[to] = generation;
+        search.m_costs[to] = cost;
+        search.m_parents[to] = from;
+
+        float estimation (to == goal ? 0.0f : getDistance (graph.getPosition (m_portal_nodes[to]), target_pos));
+        search.m_heap.push (to, cost + estimation);
+    };
+
+    search.m_cost_marks[start] = generation;
+    search.m_costs[start] = 0.0f;
+    search.m_parents[start] = NavigationGraph::INVALID_NODE;
+
+    for (const auto& edge : search.m_start_edges)
+        relax (start, edge.first, edge.second);
+
+    bool found (false);
+    while (!search.m_heap.empty ())
+    {
+        uint32_t portal (search.m_heap.pop ());
+        ++search.m_expanded;
+        if (portal == goal)
+        {
+            found = true;
+            break;
+        }
+
+        for (uint32_t edge = m_edge_offsets[portal]; edge < m_edge_offsets[portal + 1]; ++edge)
+            relax (portal, m_edge_targets[edge], search.m_costs[portal] + m_edge_costs[edge]);
+
+        if (search.m_goal_marks[portal] == goal_generation)
+            relax (portal, goal, search.m_costs[portal] + search.m_goal_distances[portal]);
+    }
+    search.m_heap.clear ();
+
+    if (!found)
+        return false;
+
+    sectors.push_back (departure_sector);
+    sectors.push_back (target_sector);
+    for (uint32_t portal = search.m_parents[goal]; portal != start; portal = search.m_parents[portal])
+        sectors.push_back (graph.getSectorID (m_portal_nodes[portal]));
+
+    std::sort (sectors.begin (), sectors.end ());
+    sectors.erase (std::unique (sectors.begin (), sectors.end ()), sectors.end ());
+
+    return true;
+}
+
+size_t PortalGraph::Search::getExpandedNodes () const
+{
+    return m_expanded;
+}
+
+void PortalGraph::Search::findSectorDistances (const NavigationGraph& graph, uint32_t source)
+{
+    uint32_t sector_id (graph.getSectorID (source));
+    uint32_t begin (graph.getSectorBegin (sector_id));
+    uint32_t end (graph.getSectorEnd (sector_id));
+
+    if (m_distances.size () < end - begin)
+    {
+        m_distances.resize (end - begin);
+        m_marks.resize (end - begin, 0);
+    }
+
+    uint32_t generation (nextGeneration ());
+    m_sector_begin = begin;
+    m_heap.reset (end - begin);
+
+    m_distances[source - begin] = 0.0f;
+    m_marks[source - begin] = generation;
+    m_heap.push (source - begin, 0.0f);
+
+    while (!m_heap.empty ())
+    {
+        uint32_t node (m_heap.pop () + begin);
+        ++m_expanded;
+
+        for (uint32_t edge = graph.getEdgeBegin (node); edge < graph.getEdgeEnd (node); ++edge)
+        {
+            uint32_t neighbour (graph.getEdgeTarget (edge));
+            if (neighbour < begin || neighbour >= end)
+                continue;
+
+            float distance (m_distances[node - begin] + graph.getEdgeCost (edge));
+            uint32_t local (neighbour - begin);
+
+            if (m_marks[local] != generation || distance < m_distances[local])
+            {
+                m_marks[local] = generation;
+                m_distances[local] = distance;
+                m_heap.push (local, distance);
+            }
+        }
+    }
+}
+
+float PortalGraph::Search::getSectorDistance (uint32_t node) const
+{
+    uint32_t local (node - m_sector_begin);
+    if (node < m_sector_begin || local >= m_marks.size () || m_marks[local] != m_generation)
+        return FLT_MAX;
+
+    return m_distances[local];
+}
+
+uint32_t PortalGraph::Search::nextGeneration ()
+{
+    if (++m_generation == 0)
+    {
+        std::fill (m_marks.begin (), m_marks.end (), 0);
+        std::fill (m_cost_marks.begin (), m_cost_marks.end (), 0);
+        std::fill (m_goal_marks.begin (), m_goal_marks.end (), 0);
+        m_generation = 1;
+    }
+
+    return m_generation;
+}
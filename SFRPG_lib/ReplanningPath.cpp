@@ -0,0 +1,284 @@
+/////////////////////////////////////////////////////////////////////
+//
+// SFGE - Simple and Fast Game Engine
+//
+// Copyright (c) 2016-2017 DonRumata710 
+// 
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation
+// files (the "Software"), to deal in the Software without
+// restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+// WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+// 
+/////////////////////////////////////////////////////////////////////
+
+
+#include "ReplanningPath.h"
+#include "MapManager.h"
+#include "NavigationGraph.h"
+#include "Way.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+
+using namespace sfge;
+
+
+namespace
+{
+
+    const float INFINITE_DISTANCE (std::numeric_limits<float>::infinity ());
+
+}
+
+
+bool ReplanningPath::Key::operator< (const Key& other) const
+{
+    if (first != other.first)
+        return first < other.first;
+    return second < other.second;
+}
+
+ReplanningPath::ReplanningPath (const MapManager* manager) :
+    m_manager (manager)
+{}
+
+void ReplanningPath::setDeparture (Vector2f departure)
+{
+    m_departure = departure;
+}
+
+Vector2f ReplanningPath::getDeparture () const
+{
+    return m_departure;
+}
+
+void ReplanningPath::setTarget (Vector2f target)
+{
+    m_target = target;
+}
+
+Vector2f ReplanningPath::getTarget () const
+{
+    return m_target;
+}
+
+bool ReplanningPath::update ()
+{
+    const NavigationGraph& graph (m_manager->m_navigation);
+
+    m_expanded_nodes = 0;
+    m_found = false;
+
+    m_start = graph.getNode (m_manager->findWayPoint (m_departure));
+    uint32_t goal (graph.getNode (m_manager->findWayPoint (m_target)));
+
+    if (m_start == NavigationGraph::INVALID_NODE || goal == NavigationGraph::INVALID_NODE)
+    {
+        m_initialized = false;
+        return false;
+    }
+
+    if (!m_initialized || !graph.getChangedNodes (m_graph_version, m_changed_nodes))
+    {
+        m_goal = goal;
+        restart (graph);
+    }
+    else
+    {
+        // Keys of opened nodes were computed for previous departure
+        if (m_last_start != m_start)
+        {
+            Vector2f shift (graph.getPosition (m_start) - graph.getPosition (m_last_start));
+            m_key_modifier += std::sqrt (shift.x * shift.x + shift.y * shift.y);
+            m_last_start = m_start;
+        }
+
+        applyChanges (graph, m_changed_nodes);
+
+        // Moved target changes root of search tree: old root gets its
+        // estimation from neighbours and new one gets zero distance
+        if (goal != m_goal)
+        {
+            uint32_t old_goal (m_goal);
+            m_goal = goal;
+            m_estimations[m_goal] = 0.0f;
+            updateNode (graph, old_goal);
+            updateNode (graph, m_goal);
+        }
+    }
+
+    m_graph_version = graph.getVersion ();
+
+    if (!graph.isConnected (m_start, m_goal))
+        return false;
+
+    computeShortestPath (graph);
+
+    m_found = m_distances[m_start] != INFINITE_DISTANCE;
+    return m_found;
+}
+
+Way ReplanningPath::getWay () const
+{
+    const NavigationGraph& graph (m_manager->m_navigation);
+
+    if (!m_found || m_graph_version != graph.getVersion ())
+        return Way (std::deque<Vector2f> ());
+
+    std::vector<uint32_t> path (1, m_start);
+    uint32_t node (m_start);
+
+    while (node != m_goal && path.size () <= graph.getNodeCount ())
+    {
+        uint32_t next (NavigationGraph::INVALID_NODE);
+        float best_distance (INFINITE_DISTANCE);
+
+        for (uint32_t edge = graph.getEdgeBegin (node); edge < graph.getEdgeEnd (node); ++edge)
+        {
+            uint32_t neighbour (graph.getEdgeTarget (edge));
+            float distance (graph.getEdgeCost (edge) + m_distances[neighbour]);
+
+            if (distance < best_distance)
+            {
+                best_distance = distance;
+                next = neighbour;
+            }
+        }
+
+        if (next == NavigationGraph::INVALID_NODE)
+            return Way (std::deque<Vector2f> ());
+
+        node = next;
+        path.push_back (node);
+    }
+
+    if (node != m_goal)
+        return Way (std::deque<Vector2f> ());
+
+    std::deque<Vector2f> points;
+    std::vector<uint32_t> sectors;
+    m_manager->fillWay (path, points, sectors);
+
+    Way way (std::move (points));
+    way.pushPointBack (m_target);
+    return way;
+}
+
+size_t ReplanningPath::getExpandedNodes () const
+{
+    return m_expanded_nodes;
+}
+
+void ReplanningPath::restart (const NavigationGraph& graph)
+{
+    m_distances.assign (graph.getNodeCount (), INFINITE_DISTANCE);
+    m_estimations.assign (graph.getNodeCount (), INFINITE_DISTANCE);
+    m_opened.reset (graph.getNodeCount ());
+
+    m_key_modifier = 0.0f;
+    m_last_start = m_start;
+    m_initialized = true;
+
+    m_estimations[m_goal] = 0.0f;
+    Key key (calculateKey (graph, m_goal));
+    m_opened.push (m_goal, key.first, key.second);
+}
+
+void ReplanningPath::applyChanges (const NavigationGraph& graph, const std::vector<uint32_t>& nodes)
+{
+    // Edges are symmetric, so both ends of changed edge are in the list.
+    // Neighbours are updated too because cost of edge to moved node is changed.
+    for (uint32_t node : nodes)
+    {
+        updateNode (graph, node);
+
+        for (uint32_t edge = graph.getEdgeBegin (node); edge < graph.getEdgeEnd (node); ++edge)
+            updateNode (graph, graph.getEdgeTarget (edge));
+    }
+}
+
+void ReplanningPath::updateNode (const NavigationGraph& graph, uint32_t node)
+{
+    if (node != m_goal)
+    {
+        float estimation (INFINITE_DISTANCE);
+        for (uint32_t edge = graph.getEdgeBegin (node); edge < graph.getEdgeEnd (node); ++edge)
+            estimation = std::min (estimation, graph.getEdgeCost (edge) + m_distances[graph.getEdgeTarget (edge)]);
+        m_estimations[node] = estimation;
+    }
+
+    if (m_distances[node] != m_estimations[node])
+    {
+        Key key (calculateKey (graph, node));
+        m_opened.push (node, key.first, key.second);
+    }
+    else if (m_opened.contains (node))
+    {
+        m_opened.erase (node);
+    }
+}
+
+void ReplanningPath::computeShortestPath (const NavigationGraph& graph)
+{
+    while (!m_opened.empty ())
+    {
+        Key top_key { m_opened.topKey (), m_opened.topSecondKey () };
+
+        if (!(top_key < calculateKey (graph, m_start)) && m_distances[m_start] == m_estimations[m_start])
+            break;
+
+        uint32_t node (m_opened.top ());
+        Key key (calculateKey (graph, node));
+
+        if (top_key < key)
+        {
+            m_opened.update (node, key.first, key.second);
+            continue;
+        }
+
+        ++m_expanded_nodes;
+
+        if (m_distances[node] > m_estimations[node])
+        {
+            m_distances[node] = m_estimations[node];
+            m_opened.erase (node);
+        }
+        else
+        {
+            m_distances[node] = INFINITE_DISTANCE;
+            updateNode (graph, node);
+        }
+
+        for (uint32_t edge = graph.getEdgeBegin (node); edge < graph.getEdgeEnd (node); ++edge)
+            updateNode (graph, graph.getEdgeTarget (edge));
+    }
+}
+
+ReplanningPath::Key ReplanningPath::calculateKey (const NavigationGraph& graph, uint32_t node) const
+{
+    float distance (std::min (m_distances[node], m_estimations[node]));
+    return { distance + getHeuristic (graph, node) + m_key_modifier, distance };
+}
+
+float ReplanningPath::getHeuristic (const NavigationGraph& graph, uint32_t node) const
+{
+    Vector2f dist (graph.getPosition (m_start) - graph.getPosition (node));
+    return std::sqrt (dist.x * dist.x + dist.y * dist.y);
+}
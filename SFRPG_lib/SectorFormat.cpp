@@ -0,0 +1,695 @@
+/////////////////////////////////////////////////////////////////////
+//
+// SFGE - Simple and Fast Game Engine
+//
+// Copyright (c) 2016-2017 DonRumata710 
+// 
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation
+// files (the "Software"), to deal in the Software without
+// restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+// WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+// 
+/////////////////////////////////////////////////////////////////////
+
+
+#include "SectorFormat.h"
+#include "MapSaver.h"
+
+#include <SFGE/TextParser.h>
+#include <SFGE/Err.h>
+
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+
+
+using namespace sfge;
+
+
+namespace
+{
+
+    enum SectorDescription : size_t
+    {
+        MD_NONE, MD_END, MD_NUMBER, MD_STRING, MD_EQUAL,
+        MD_OPEN_BLOCK, MD_CLOSE_BLOCK,
+        MD_SECTOR,
+        MD_NAME, MD_TILE_SIZE,
+        MD_TILE, MD_TEXTURE, MD_X, MD_Y,
+        MD_WAY_POINT, MD_RADIUS,
+        MD_OBJECT, MD_POINT
+    };
+
+    const SemanticsDescription SECTOR_SEMANTICS = {
+        {
+            { "=",          MD_EQUAL },
+            { "{",          MD_OPEN_BLOCK },
+            { "}",          MD_CLOSE_BLOCK },
+            { "Sector",     MD_SECTOR },
+            { "name",       MD_NAME },
+            { "tile_size",  MD_TILE_SIZE },
+            { "Tile",       MD_TILE },
+            { "texture",    MD_TEXTURE },
+            { "x",          MD_X },
+            { "y",          MD_Y },
+            { "WayPoint",   MD_WAY_POINT },
+            { "radius",     MD_RADIUS },
+            { "Object",     MD_OBJECT },
+            { "Point",      MD_POINT },
+        },
+        {
+            '_'
+        },
+        MD_STRING,
+        MD_NUMBER,
+        MD_END
+    };
+
+    const char BINARY_MAGIC[4] = { 'S', 'F', 'S', 'B' };
+
+    struct TileDesc
+    {
+        uint32_t x = 0;
+        uint32_t y = 0;
+        std::string texture;
+    };
+
+    size_t align (size_t offset)
+    {
+        return (offset + 3) & ~size_t (3);
+    }
+
+    bool readValue (TextParser* tp)
+    {
+        tp->getToken ();
+        if (tp->getTokentype () != MD_EQUAL)
+        {
+            runtime_message ("Expected '=' in line " + std::to_string (tp->getLine ()));
+            return false;
+        }
+
+        tp->getToken ();
+        return tp->getTokentype () == MD_NUMBER || tp->getTokentype () == MD_STRING;
+    }
+
+    bool openBlock (TextParser* tp)
+    {
+        tp->getToken ();
+        if (tp->getTokentype () != MD_OPEN_BLOCK)
+        {
+            runtime_message ("Unexpected identifier instead '{' in line " + std::to_string (tp->getLine ()));
+            return false;
+        }
+
+        return true;
+    }
+
+    bool readTile (TextParser* tp, TileDesc& tile)
+    {
+        if (!openBlock (tp))
+            return false;
+
+        while (true)
+        {
+            tp->getToken ();
+            size_t token (tp->getTokentype ());
+
+            if (token == MD_CLOSE_BLOCK)
+                return true;
+
+            if (token != MD_X && token != MD_Y && token != MD_TEXTURE)
+            {
+                runtime_message ("Unexpected identifier in tile description in line " + std::to_string (tp->getLine ()));
+                return false;
+            }
+
+            if (!readValue (tp))
+                return false;
+
+            if (token == MD_X)
+                tile.x = static_cast<uint32_t> (tp->tknInt ());
+            else if (token == MD_Y)
+                tile.y = static_cast<uint32_t> (tp->tknInt ());
+            else
+                tile.texture = tp->tknString ();
+        }
+    }
+
+    bool readWayPoint (TextParser* tp, WayPoint& way_point)
+    {
+        if (!openBlock (tp))
+            return false;
+
+        Vector2f pos;
+        while (true)
+        {
+            tp->getToken ();
+            size_t token (tp->getTokentype ());
+
+            if (token == MD_CLOSE_BLOCK)
+                break;
+
+            if ((token != MD_X && token != MD_Y && token != MD_RADIUS) || !readValue (tp))
+            {
+                runtime_message ("Unexpected identifier in way point description in line " + std::to_string (tp->getLine ()));
+                return false;
+            }
+
+            if (token == MD_X)
+                pos.x = tp->tknFloat ();
+            else if (token == MD_Y)
+                pos.y = tp->tknFloat ();
+            else
+                way_point.setRadius (tp->tknFloat ());
+        }
+
+        way_point.setPosition (pos);
+        return true;
+    }
+
+    bool readPoint (TextParser* tp, Point& point)
+    {
+        if (!openBlock (tp))
+            return false;
+
+        while (true)
+        {
+            tp->getToken ();
+            size_t token (tp->getTokentype ());
+
+            if (token == MD_CLOSE_BLOCK)
+                return true;
+
+            if ((token != MD_X && token != MD_Y) || !readValue (tp))
+            {
+                runtime_message ("Unexpected identifier in point description in line " + std::to_string (tp->getLine ()));
+                return false;
+            }
+
+            if (token == MD_X)
+                point.x = tp->tknFloat ();
+            else
+                point.y = tp->tknFloat ();
+        }
+    }
+
+    bool readObject (TextParser* tp, Collision& object)
+    {
+        if (!openBlock (tp))
+            return false;
+
+        Vector2f pos;
+        Circuit points;
+        while (true)
+        {
+            tp->getToken ();
+            size_t token (tp->getTokentype ());
+
+            if (token == MD_CLOSE_BLOCK)
+                break;
+
+            switch (token)
+            {
+            case MD_X:
+            case MD_Y:
+                if (!readValue (tp))
+                    return false;
+
+                if (token == MD_X)
+                    pos.x = tp->tknFloat ();
+                else
+                    pos.y = tp->tknFloat ();
+                break;
+            case MD_POINT:
+                points.emplace_back ();
+                if (!readPoint (tp, points.back ()))
+                    return false;
+                break;
+            default:
+                runtime_message ("Unexpected identifier in object description in line " + std::to_string (tp->getLine ()));
+                return false;
+            }
+        }
+
+        object.setPoints (points);
+        object.setPosition (pos);
+        return true;
+    }
+
+    bool write (iDataOutputStream* stream, const std::string& str)
+    {
+        return stream->write (str.data (), str.size ()) == Int64 (str.size ());
+    }
+
+}
+
+
+bool SectorFormat::isBinary (const char* data, size_t size)
+{
+    return size >= sizeof (BINARY_MAGIC) && memcmp (data, BINARY_MAGIC, sizeof (BINARY_MAGIC)) == 0;
+}
+
+bool SectorFormat::readText (const char* text, Vector2u size, SectorData& sector)
+{
+    TextParser tp (text, SECTOR_SEMANTICS);
+
+    tp.getToken ();
+    if (tp.getTokentype () != MD_SECTOR)
+    {
+        runtime_message ("Wrong map sector description");
+        return false;
+    }
+
+    if (!openBlock (&tp))
+        return false;
+
+    sector = SectorData ();
+
+    std::vector<TileDesc> tiles;
+    while (true)
+    {
+        tp.getToken ();
+        size_t token (tp.getTokentype ());
+
+        if (token == MD_CLOSE_BLOCK)
+            break;
+
+        switch (token)
+        {
+        case MD_NAME:
+            if (!readValue (&tp))
+                return false;
+            sector.name = tp.tknString ();
+            break;
+        case MD_TILE_SIZE:
+            if (!readValue (&tp))
+                return false;
+            sector.tile_size = static_cast<uint32_t> (tp.tknInt ());
+            break;
+        case MD_TILE:
+            tiles.emplace_back ();
+            if (!readTile (&tp, tiles.back ()))
+                return false;
+            break;
+        case MD_WAY_POINT:
+            sector.way_points.emplace_back ();
+            if (!readWayPoint (&tp, sector.way_points.back ()))
+                return false;
+            break;
+        case MD_OBJECT:
+            sector.objects.emplace_back ();
+            if (!readObject (&tp, sector.objects.back ()))
+                return false;
+            break;
+        default:
+            runtime_message ("Unexpected identifier in segment description in line " + std::to_string (tp.getLine ()));
+            return false;
+        }
+    }
+
+    // Text keeps only positions of tiles, so size of sector may be unknown
+    if (size.x == 0 || size.y == 0)
+    {
+        size = Vector2u ();
+        for (const TileDesc& tile : tiles)
+        {
+            size.x = std::max (size.x, tile.x + 1);
+            size.y = std::max (size.y, tile.y + 1);
+        }
+    }
+
+    sector.size = size;
+    sector.tiles.assign (size_t (size.x) * size.y, 0);
+
+    std::unordered_map<std::string, uint16_t> palette;
+    for (const TileDesc& tile : tiles)
+    {
+        if (tile.x >= size.x || tile.y >= size.y)
+        {
+            runtime_message ("Tile x = " + std::to_string (tile.x) + " y = " + std::to_string (tile.y) + " is placed outside of sector");
+            continue;
+        }
+
+        uint16_t id (0);
+        if (!tile.texture.empty ())
+        {
+            auto item (palette.find (tile.texture));
+            if (item == palette.end ())
+            {
+                if (sector.palette.size () > UINT16_MAX)
+                {
+                    runtime_message ("Too many textures in sector " + sector.name);
+                    return false;
+                }
+
+                item = palette.emplace (tile.texture, static_cast<uint16_t> (sector.palette.size ())).first;
+                sector.palette.push_back (tile.texture);
+            }
+
+            id = item->second;
+        }
+
+        sector.tiles[tile.x + size_t (tile.y) * size.x] = id;
+    }
+
+    return true;
+}
+
+bool SectorFormat::writeText (iDataOutputStream* stream, const SectorData& sector)
+{
+    MapSaver saver (stream);
+
+    if (!write (stream, "Sector\n{\n") ||
+        !saver.save ("name", sector.name) ||
+        !saver.save ("tile_size", Uint32 (sector.tile_size)))
+    {
+        debug_message ("Failed writing header of sector " + sector.name);
+        return false;
+    }
+
+    for (size_t i = 0; i < sector.tiles.size (); ++i)
+    {
+        uint16_t id (sector.tiles[i]);
+        if (id == 0 || id >= sector.palette.size ())
+            continue;
+
+        if (!saver.saveTile (sector.palette[id], Vector2u (Uint32 (i % sector.size.x), Uint32 (i / sector.size.x))))
+            return false;
+    }
+
+    for (const WayPoint& way_point : sector.way_points)
+    {
+        if (!write (stream, "WayPoint\n{\n") ||
+            !saver.save ("x", double (way_point.getPosition ().x)) ||
+            !saver.save ("y", double (way_point.getPosition ().y)) ||
+            !saver.save ("radius", double (way_point.getRadius ())) ||
+            !write (stream, "}\n"))
+        {
+            debug_message ("Failed writing way point of sector " + sector.name);
+            return false;
+        }
+    }
+
+    for (const Collision& object : sector.objects)
+    {
+        if (!write (stream, "Object\n{\n") ||
+            !saver.save ("x", double (object.getPosition ().x)) ||
+            !saver.save ("y", double (object.getPosition ().y)))
+        {
+            debug_message ("Failed writing object of sector " + sector.name);
+            return false;
+        }
+
+        for (const Point& point : object.getPoints ())
+        {
+            if (!write (stream, "Point\n{\n") ||
+                !saver.save ("x", double (point.x)) ||
+                !saver.save ("y", double (point.y)) ||
+                !write (stream, "}\n"))
+            {
+                debug_message ("Failed writing object of sector " + sector.name);
+                return false;
+            }
+        }
+
+        if (!write (stream, "}\n"))
+            return false;
+    }
+
+    return write (stream, "}\n");
+}
+
+bool SectorFormat::writeBinary (iDataOutputStream* stream, const SectorData& sector)
+{
+    if (sector.palette.empty () || sector.palette.size () > size_t (UINT16_MAX) + 1 ||
+        sector.tiles.size () != size_t (sector.size.x) * sector.size.y)
+    {
+        runtime_message ("Sector " + sector.name + " can't be written in binary format");
+        return false;
+    }
+
+    std::vector<char> strings;
+    auto add_string = [&strings](const std::string& str)
+    {
+        uint32_t offset (static_cast<uint32_t> (strings.size ()));
+        strings.insert (strings.end (), str.begin (), str.end ());
+        strings.push_back ('\0');
+        return offset;
+    };
+
+    Header header;
+    memcpy (header.magic, BINARY_MAGIC, sizeof (BINARY_MAGIC));
+    header.version = VERSION;
+    header.width = sector.size.x;
+    header.height = sector.size.y;
+    header.tile_size = sector.tile_size;
+    header.name = add_string (sector.name);
+
+    std::vector<uint32_t> palette;
+    for (const std::string& texture : sector.palette)
+        palette.push_back (add_string (texture));
+
+    std::vector<WayPointRecord> way_points;
+    for (const WayPoint& way_point : sector.way_points)
+        way_points.push_back ({ way_point.getPosition ().x, way_point.getPosition ().y, way_point.getRadius () });
+
+    std::vector<ObjectRecord> objects;
+    std::vector<PointRecord> points;
+    for (const Collision& object : sector.objects)
+    {
+        objects.push_back ({
+            object.getPosition ().x,
+            object.getPosition ().y,
+            static_cast<uint32_t> (points.size ()),
+            static_cast<uint32_t> (object.getPoints ().size ())
+        });
+
+        for (const Point& point : object.getPoints ())
+            points.push_back ({ point.x, point.y });
+    }
+
+    uint64_t offset (sizeof (Header));
+
+    header.palette_count = static_cast<uint32_t> (palette.size ());
+    header.palette_offset = static_cast<uint32_t> (offset);
+    offset += palette.size () * sizeof (uint32_t);
+
+    header.strings_size = static_cast<uint32_t> (strings.size ());
+    header.strings_offset = static_cast<uint32_t> (offset);
+    offset = align (offset + strings.size ());
+
+    header.tiles_offset = static_cast<uint32_t> (offset);
+    offset = align (offset + sector.tiles.size () * sizeof (uint16_t));
+
+    header.way_points_count = static_cast<uint32_t> (way_points.size ());
+    header.way_points_offset = static_cast<uint32_t> (offset);
+    offset += way_points.size () * sizeof (WayPointRecord);
+
+    header.objects_count = static_cast<uint32_t> (objects.size ());
+    header.objects_offset = static_cast<uint32_t> (offset);
+    offset += objects.size () * sizeof (ObjectRecord);
+
+    header.points_count = static_cast<uint32_t> (points.size ());
+    header.points_offset = static_cast<uint32_t> (offset);
+    offset += points.size () * sizeof (PointRecord);
+
+    if (offset > UINT32_MAX)
+    {
+        runtime_message ("Sector " + sector.name + " is too big for binary format");
+        return false;
+    }
+
+    std::vector<char> data (static_cast<size_t> (offset), '\0');
+
+    auto copy = [&data](uint32_t section, const void* source, size_t size)
+    {
+        if (size != 0)
+            memcpy (data.data () + section, source, size);
+    };
+
+    copy (0, &header, sizeof (Header));
+    copy (header.palette_offset, palette.data (), palette.size () * sizeof (uint32_t));
+    copy (header.strings_offset, strings.data (), strings.size ());
+    copy (header.tiles_offset, sector.tiles.data (), sector.tiles.size () * sizeof (uint16_t));
+    copy (header.way_points_offset, way_points.data (), way_points.size () * sizeof (WayPointRecord));
+    copy (header.objects_offset, objects.data (), objects.size () * sizeof (ObjectRecord));
+    copy (header.points_offset, points.data (), points.size () * sizeof (PointRecord));
+
+    if (stream->write (data.data (), Int64 (data.size ())) != Int64 (data.size ()))
+    {
+        debug_message ("Failed writing binary sector " + sector.name);
+        return false;
+    }
+
+    return true;
+}
+
+
+bool BinarySector::open (const char* data, size_t size)
+{
+    m_data = nullptr;
+    m_size = 0;
+
+    if (!SectorFormat::isBinary (data, size) || size < sizeof (SectorFormat::Header))
+        return false;
+
+    if (reinterpret_cast<uintptr_t> (data) % 4 != 0)
+    {
+        runtime_message ("Binary sector isn't aligned in memory");
+        return false;
+    }
+
+    memcpy (&m_header, data, sizeof (SectorFormat::Header));
+    if (m_header.version != SectorFormat::VERSION)
+    {
+        runtime_message ("Unsupported version of binary sector " + std::to_string (m_header.version));
+        return false;
+    }
+
+    m_data = data;
+    m_size = size;
+
+    bool valid (
+        m_header.palette_count != 0 &&
+        m_header.strings_size != 0 &&
+        checkSection (m_header.palette_offset, uint64_t (m_header.palette_count) * sizeof (uint32_t)) &&
+        checkSection (m_header.strings_offset, m_header.strings_size) &&
+        checkSection (m_header.tiles_offset, uint64_t (m_header.width) * m_header.height * sizeof (uint16_t)) &&
+        checkSection (m_header.way_points_offset, uint64_t (m_header.way_points_count) * sizeof (SectorFormat::WayPointRecord)) &&
+        checkSection (m_header.objects_offset, uint64_t (m_header.objects_count) * sizeof (SectorFormat::ObjectRecord)) &&
+        checkSection (m_header.points_offset, uint64_t (m_header.points_count) * sizeof (SectorFormat::PointRecord))
+    );
+
+    // Every string is terminated if the last one is
+    valid = valid && m_data[m_header.strings_offset + m_header.strings_size - 1] == '\0' && m_header.name < m_header.strings_size;
+
+    const uint32_t* palette (getSection<uint32_t> (m_header.palette_offset));
+    for (uint32_t i = 0; valid && i < m_header.palette_count; ++i)
+        valid = palette[i] < m_header.strings_size;
+
+    const SectorFormat::ObjectRecord* objects (getSection<SectorFormat::ObjectRecord> (m_header.objects_offset));
+    for (uint32_t i = 0; valid && i < m_header.objects_count; ++i)
+        valid = objects[i].first_point <= m_header.points_count && objects[i].points_count <= m_header.points_count - objects[i].first_point;
+
+    if (!valid)
+    {
+        runtime_message ("Sections of binary sector are broken");
+        m_data = nullptr;
+        m_size = 0;
+        return false;
+    }
+
+    return true;
+}
+
+const char* BinarySector::getName () const
+{
+    return m_data + m_header.strings_offset + m_header.name;
+}
+
+Vector2u BinarySector::getSize () const
+{
+    return Vector2u (m_header.width, m_header.height);
+}
+
+uint32_t BinarySector::getTileSize () const
+{
+    return m_header.tile_size;
+}
+
+uint32_t BinarySector::getPaletteSize () const
+{
+    return m_header.palette_count;
+}
+
+const char* BinarySector::getTexture (uint32_t id) const
+{
+    return m_data + m_header.strings_offset + getSection<uint32_t> (m_header.palette_offset)[id];
+}
+
+const uint16_t* BinarySector::getTiles () const
+{
+    return getSection<uint16_t> (m_header.tiles_offset);
+}
+
+uint32_t BinarySector::getWayPointsCount () const
+{
+    return m_header.way_points_count;
+}
+
+WayPoint BinarySector::getWayPoint (uint32_t id) const
+{
+    const SectorFormat::WayPointRecord& record (getSection<SectorFormat::WayPointRecord> (m_header.way_points_offset)[id]);
+
+    WayPoint way_point;
+    way_point.setPosition ({ record.x, record.y });
+    way_point.setRadius (record.radius);
+    return way_point;
+}
+
+uint32_t BinarySector::getObjectsCount () const
+{
+    return m_header.objects_count;
+}
+
+Collision BinarySector::getObject (uint32_t id) const
+{
+    const SectorFormat::ObjectRecord& record (getSection<SectorFormat::ObjectRecord> (m_header.objects_offset)[id]);
+    const SectorFormat::PointRecord* points (getSection<SectorFormat::PointRecord> (m_header.points_offset) + record.first_point);
+
+    Circuit circuit;
+    circuit.reserve (record.points_count);
+    for (uint32_t i = 0; i < record.points_count; ++i)
+        circuit.emplace_back (points[i].x, points[i].y);
+
+    Collision object (circuit);
+    object.setPosition ({ record.x, record.y });
+    return object;
+}
+
+void BinarySector::read (SectorData& sector) const
+{
+    sector.name = getName ();
+    sector.size = getSize ();
+    sector.tile_size = getTileSize ();
+
+    sector.palette.clear ();
+    for (uint32_t i = 0; i < getPaletteSize (); ++i)
+        sector.palette.push_back (getTexture (i));
+
+    const uint16_t* tiles (getTiles ());
+    sector.tiles.assign (tiles, tiles + size_t (m_header.width) * m_header.height);
+
+    sector.way_points.clear ();
+    for (uint32_t i = 0; i < getWayPointsCount (); ++i)
+        sector.way_points.push_back (getWayPoint (i));
+
+    sector.objects.clear ();
+    for (uint32_t i = 0; i < getObjectsCount (); ++i)
+        sector.objects.push_back (getObject (i));
+}
+
+bool BinarySector::checkSection (uint32_t offset, uint64_t size) const
+{
+    return offset % 4 == 0 && offset <= m_size && size <= m_size - offset;
+}
+
+template <typename T> const T* BinarySector::getSection (uint32_t offset) const
+{
+    return reinterpret_cast<const T*> (m_data + offset);
+}
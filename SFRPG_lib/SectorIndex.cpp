@@ -0,0 +1,175 @@
+/////////////////////////////////////////////////////////////////////
+//
+// SFGE - Simple and Fast Game Engine
+//
+// Copyright (c) 2016-2017 DonRumata710 
+// 
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation
+// files (the "Software"), to deal in the Software without
+// restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+// WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+// 
+/////////////////////////////////////////////////////////////////////
+
+
+#include "SectorIndex.h"
+
+#include <algorithm>
+#include <cmath>
+
+
+using namespace sfge;
+
+
+void SectorIndex::build (const std::unordered_map<uint32_t, MapSectorDesc>& sectors)
+{
+    clear ();
+
+    if (sectors.empty ())
+        return;
+
+    uint64_t sides (0);
+    for (const auto& sector : sectors)
+        sides += std::max (sector.second.size.x, sector.second.size.y);
+
+    m_cell_size = static_cast<uint32_t> (std::max<uint64_t> (sides / sectors.size (), 1));
+
+    for (const auto& sector : sectors)
+    {
+        Bounds bounds {
+            sector.second.pos.x,
+            sector.second.pos.y,
+            uint64_t (sector.second.pos.x) + sector.second.size.x,
+            uint64_t (sector.second.pos.y) + sector.second.size.y
+        };
+        m_bounds[sector.first] = bounds;
+
+        // Borders belong to sector, so sectors with common border share cells
+        Bounds cells (getCells (bounds));
+        for (uint64_t column = cells.left; column <= cells.right; ++column)
+        {
+            for (uint64_t row = cells.top; row <= cells.bottom; ++row)
+                m_cells[getKey (column, row)].push_back (sector.first);
+        }
+    }
+}
+
+void SectorIndex::clear ()
+{
+    m_cell_size = 1;
+    m_bounds.clear ();
+    m_cells.clear ();
+}
+
+uint32_t SectorIndex::getCellSize () const
+{
+    return m_cell_size;
+}
+
+void SectorIndex::queryPoint (Vector2f point, std::vector<uint32_t>& ids) const
+{
+    queryRect (FloatRect (point.x, point.y, 0.0f, 0.0f), ids);
+}
+
+void SectorIndex::queryRect (const UintRect& area, std::vector<uint32_t>& ids) const
+{
+    Bounds rect { area.left, area.top, uint64_t (area.left) + area.width, uint64_t (area.top) + area.height };
+
+    query (getCells (rect), [&rect](const Bounds& bounds)
+    {
+        return rect.left < bounds.right && rect.top < bounds.bottom && rect.right > bounds.left && rect.bottom > bounds.top;
+    }, ids);
+}
+
+void SectorIndex::queryRect (const FloatRect& area, std::vector<uint32_t>& ids) const
+{
+    ids.clear ();
+
+    double left (area.left);
+    double top (area.top);
+    double right (double (area.left) + area.width);
+    double bottom (double (area.top) + area.height);
+
+    // Map has no negative coordinates
+    if (right < 0.0 || bottom < 0.0)
+        return;
+
+    Bounds cells {
+        uint64_t (std::max (left, 0.0)),
+        uint64_t (std::max (top, 0.0)),
+        uint64_t (std::ceil (right)),
+        uint64_t (std::ceil (bottom))
+    };
+
+    query (getCells (cells), [=](const Bounds& bounds)
+    {
+        return bounds.left <= right && left <= bounds.right && bounds.top <= bottom && top <= bounds.bottom;
+    }, ids);
+}
+
+void SectorIndex::queryNeighbours (uint32_t id, std::vector<uint32_t>& ids) const
+{
+    ids.clear ();
+
+    auto sector (m_bounds.find (id));
+    if (sector == m_bounds.end ())
+        return;
+
+    const Bounds& rect (sector->second);
+    query (getCells (rect), [&rect](const Bounds& bounds)
+    {
+        return bounds.left <= rect.right && rect.left <= bounds.right && bounds.top <= rect.bottom && rect.top <= bounds.bottom;
+    }, ids);
+
+    ids.erase (std::remove (ids.begin (), ids.end (), id), ids.end ());
+}
+
+template <typename Check> void SectorIndex::query (const Bounds& cells, Check check, std::vector<uint32_t>& ids) const
+{
+    ids.clear ();
+
+    for (uint64_t column = cells.left; column <= cells.right; ++column)
+    {
+        for (uint64_t row = cells.top; row <= cells.bottom; ++row)
+        {
+            auto cell (m_cells.find (getKey (column, row)));
+            if (cell == m_cells.end ())
+                continue;
+
+            for (uint32_t id : cell->second)
+            {
+                if (check (m_bounds.at (id)))
+                    ids.push_back (id);
+            }
+        }
+    }
+
+    std::sort (ids.begin (), ids.end ());
+    ids.erase (std::unique (ids.begin (), ids.end ()), ids.end ());
+}
+
+SectorIndex::Bounds SectorIndex::getCells (const Bounds& bounds) const
+{
+    return { bounds.left / m_cell_size, bounds.top / m_cell_size, bounds.right / m_cell_size, bounds.bottom / m_cell_size };
+}
+
+uint64_t SectorIndex::getKey (uint64_t column, uint64_t row)
+{
+    // Keys of far cells may be equal, sectors of cells are checked anyway
+    return (column << 32) ^ row;
+}
@@ -28,171 +28,314 @@
 
 
 #include "SectorLoader.h"
+#include "SectorFormat.h"
+#include "StaticObject.h"
+#include "WorkerPool.h"
 
-#include "SFGE/TextParser.h"
 #include "SFGE/Err.h"
 
+#include <algorithm>
+
 
 using namespace sfge;
 
 
-enum SectorDescritpion : size_t
-{
-    MD_NONE, MD_END, MD_NUMBER, MD_STRING, MD_EQUAL,
-    MD_OPEN_BLOCK, MD_CLOSE_BLOCK,
-    MD_SECTOR,
-    MD_NAME, MD_TILE_SIZE, MD_SIZE,
-    MD_TILE,
-    MD_TEXTURE, MD_X, MD_Y
-};
-
-
-const SemanticsDescription SectorLoader::m_sem_desc = {
-    {
-        { "=",          MD_EQUAL },
-        { "{",          MD_OPEN_BLOCK },
-        { "}",          MD_CLOSE_BLOCK },
-        { "Sector",     MD_SECTOR },
-        { "name",       MD_NAME },
-        { "tile_size",  MD_TILE_SIZE },
-        { "Tile",       MD_TILE },
-        { "texture",    MD_TEXTURE },
-        { "x",          MD_X },
-        { "y",          MD_Y },
-    },
-    {
-        '_'
-    },
-    MD_STRING,
-    MD_NUMBER,
-    MD_END
-};
-
-
-SectorLoader::SectorLoader (iResourceInputStream* stream) : m_stream (stream)
+SectorLoader::SectorLoader (iResourceInputStream* stream, size_t threads) :
+    m_stream (stream),
+    m_threads (threads)
 {}
 
-void SectorLoader::loadSectors (const std::vector<MapSectorDesc*>& sectors)
+SectorLoader::~SectorLoader ()
 {
-    for (MapSectorDesc* sector_desc : sectors)
+    m_workers.reset ();
+}
+
+void SectorLoader::loadSectors (const std::vector<MapSectorDesc*>& sectors, const Finisher& finish)
+{
+    if (sectors.empty ())
+        return;
+
+    std::vector<LoadedSector> loaded;
+    loaded.reserve (sectors.size ());
+    for (size_t i = 0; i < sectors.size (); ++i)
+        loaded.push_back ({ uint32_t (i), nullptr, TileList (), std::vector<char> () });
+
+    std::mutex mutex;
+    std::condition_variable parsed;
+    std::vector<char> done (sectors.size (), false);
+
+    auto complete ([&mutex, &parsed, &done](size_t i)
+    {
+        // Notification is sent under lock, so waiting thread can't leave
+        // this method before it is sent
+        std::lock_guard<std::mutex> lock (mutex);
+        done[i] = true;
+        parsed.notify_all ();
+    });
+
+    // Workers refer to locals of this method, so every task is waited for
+    // before leaving it, even if finisher or setTiles throws
+    struct Drain
     {
-        if (!m_stream->open (sector_desc->path))
+        std::mutex& mutex;
+        std::condition_variable& parsed;
+        std::vector<char>& done;
+
+        ~Drain ()
         {
-            runtime_message ("Failed loading map sector from file " + sector_desc->path);
-            break;
+            std::unique_lock<std::mutex> lock (mutex);
+            parsed.wait (lock, [this]() { return std::all_of (done.begin (), done.end (), [](char item) { return item != 0; }); });
         }
+    } drain { mutex, parsed, done };
+
+    startWorkers ();
+
+    // Stream has one position, so one worker reads files and every read
+    // file is parsed by any free worker. Vector of sectors may be gone
+    // after the last sector is completed, so its size is copied.
+    size_t count (sectors.size ());
+    m_workers->push ([this, count, &sectors, &loaded, complete](size_t)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            std::shared_ptr<std::vector<char>> data (std::make_shared<std::vector<char>> ());
+            if (!readFile (sectors[i]->path, *data))
+            {
+                runtime_message ("Failed loading map sector from file " + sectors[i]->path);
+                complete (i);
+                continue;
+            }
 
-        uint64_t size (m_stream->getSize ());
-        char* data = new char[size];
-        m_stream->read (data, size);
-        data[size - 1] = '\0';
+            std::string path (sectors[i]->path);
+            Vector2u size (sectors[i]->size);
 
-        TextParser* tp = new TextParser (data, m_sem_desc);
+            m_workers->push ([this, i, path, size, data, &loaded, complete](size_t)
+            {
+                parseSector (path, size, *data, loaded[i]);
+                complete (i);
+            });
+        }
+    });
 
-        tp->getToken ();
-        if (tp->getTokentype () != MD_SECTOR)
+    for (size_t i = 0; i < sectors.size (); ++i)
+    {
         {
-            runtime_message ("Wrong map sector description in file " + sector_desc->path);
-            return;
+            std::unique_lock<std::mutex> lock (mutex);
+            parsed.wait (lock, [&done, i]() { return done[i] != 0; });
         }
 
-        std::unique_ptr<MapSector> sector (std::make_unique<MapSector> (sector_desc->size));
-        if (!loadMapSector (tp, sector.get ()))
-            runtime_message ("Failed including named " + std::string (tp->tknString ()) + " failed!");
-        sector_desc->sector.swap (sector);
-        break;
+        if (!loaded[i].sector)
+            continue;
+
+        setTiles (loaded[i]);
+        sectors[i]->sector.swap (loaded[i].sector);
+
+        if (finish)
+            finish (i);
     }
 }
 
-bool SectorLoader::loadMapSector (TextParser* tp, MapSector* sector)
+void SectorLoader::requestSector (uint32_t id, const MapSectorDesc& desc)
 {
-    if (!sector)
-        return false;
-
-    tp->getToken ();
-    if (tp->getTokentype () != MD_OPEN_BLOCK)
     {
-        runtime_message ("Unexpected identifier instead '{' in line " + std::to_string (tp->getLine ()));
-        return false;
+        std::lock_guard<std::mutex> lock (m_mutex);
+        if (!m_requested.insert (id).second)
+            return;
+
+        ++m_loading;
     }
 
-    Uint32 sector_width = sector->getSize ().x;
+    startWorkers ();
 
-    std::vector<std::pair<uint32_t, std::string>> tiles;
+    std::string path (desc.path);
+    Vector2u size (desc.size);
 
-    while (true)
+    m_workers->push ([this, id, path, size](size_t)
     {
-        tp->getToken ();
-        size_t token (tp->getTokentype ());
+        LoadedSector loaded { id, nullptr, TileList (), std::vector<char> () };
+        loadSector (path, size, loaded);
+
+        std::lock_guard<std::mutex> lock (m_mutex);
+        m_loaded.push_back (std::move (loaded));
+        --m_loading;
+        m_sector_loaded.notify_all ();
+    });
+}
+
+bool SectorLoader::isRequested (uint32_t id) const
+{
+    std::lock_guard<std::mutex> lock (m_mutex);
+    return m_requested.count (id) != 0;
+}
 
-        if (token == MD_CLOSE_BLOCK)
-            break;
+size_t SectorLoader::getRequestCount () const
+{
+    std::lock_guard<std::mutex> lock (m_mutex);
+    return m_requested.size ();
+}
+
+void SectorLoader::takeSectors (std::vector<LoadedSector>& sectors)
+{
+    sectors.clear ();
+
+    std::lock_guard<std::mutex> lock (m_mutex);
+    sectors.swap (m_loaded);
+    for (const LoadedSector& sector : sectors)
+        m_requested.erase (sector.id);
+}
 
-        switch (token)
+void SectorLoader::wait ()
+{
+    std::unique_lock<std::mutex> lock (m_mutex);
+    m_sector_loaded.wait (lock, [this]() { return m_loading == 0; });
+}
+
+void SectorLoader::setTiles (LoadedSector& sector)
+{
+    if (!sector.sector)
+        return;
+
+    if (!sector.data.empty ())
+    {
+        BinarySector binary;
+        if (binary.open (sector.data.data (), sector.data.size ()))
         {
-        case MD_NAME:
-            tp->getToken ();
-            tp->getToken ();
-            sector->setName (tp->tknString ());
-            break;
-        case MD_TILE_SIZE:
-            tp->getToken ();
-            tp->getToken ();
-            sector->setTileSize (tp->tknInt ());
-            break;
-        case MD_TILE:
-            tiles.push_back (loadTile (tp, sector_width));
-            break;
-        default:
-            runtime_message ("Unexpected identifier in segment description in line " + std::to_string (tp->getLine ()));
-            return false;
+            std::vector<std::string> palette;
+            for (uint32_t i = 0; i < binary.getPaletteSize (); ++i)
+                palette.push_back (binary.getTexture (i));
+
+            sector.sector->setTiles (palette, binary.getTiles ());
         }
     }
+    else
+    {
+        sector.sector->setTiles (sector.tiles);
+    }
 
-    sector->setTiles (tiles);
-    return true;
+    sector.tiles = TileList ();
+    sector.data = std::vector<char> ();
+}
+
+bool SectorLoader::loadSector (const std::string& path, Vector2u size, LoadedSector& sector)
+{
+    std::vector<char> data;
+    if (!readFile (path, data))
+    {
+        runtime_message ("Failed loading map sector from file " + path);
+        return false;
+    }
+
+    return parseSector (path, size, data, sector);
 }
 
-std::pair<uint32_t, std::string> SectorLoader::loadTile (TextParser* tp, Uint32 sector_width)
+bool SectorLoader::parseSector (const std::string& path, Vector2u size, std::vector<char>& data, LoadedSector& sector)
 {
-    tp->getToken ();
+    // The last byte terminates text
+    if (SectorFormat::isBinary (data.data (), data.size () - 1))
+    {
+        data.pop_back ();
+        sector.data.swap (data);
+        return loadBinarySector (path, size, sector);
+    }
 
-    std::pair<uint32_t, std::string> tile_desc;
+    return loadTextSector (path, size, data.data (), sector);
+}
 
-    tp->getToken ();
-    if (tp->getTokentype () == MD_OPEN_BLOCK)
+bool SectorLoader::loadTextSector (const std::string& path, Vector2u size, const char* text, LoadedSector& sector)
+{
+    SectorData content;
+    if (!SectorFormat::readText (text, size, content))
     {
-        while (true)
-        {
-            tp->getToken ();
-            size_t token (tp->getTokentype ());
+        runtime_message ("Wrong map sector description in file " + path);
+        return false;
+    }
 
-            if (token == MD_CLOSE_BLOCK)
-                break;
+    std::unique_ptr<MapSector> map_sector (std::make_unique<MapSector> (content.size));
+    map_sector->setName (content.name);
+    map_sector->setTileSize (content.tile_size);
+    map_sector->setWayPoints (std::move (content.way_points));
 
-            switch (token)
-            {
-            case MD_TEXTURE:
-                tp->getToken ();
-                tp->getToken ();
-                tile_desc.second = tp->tknString ();
-                break;
-            case MD_X:
-                tp->getToken ();
-                tp->getToken ();
-                tile_desc.first += tp->tknInt ();
-                break;
-            case MD_Y:
-                tp->getToken ();
-                tp->getToken ();
-                tile_desc.first += tp->tknInt () * sector_width;
-                break;
-            default:
-                runtime_message ("Unexpected identifier in tile description in line " + std::to_string (tp->getLine ()));
-                return std::pair<uint32_t, std::string> ();
-            }
-        }
+    for (const Collision& collision : content.objects)
+    {
+        std::shared_ptr<StaticObject> object (std::make_shared<StaticObject> ());
+        object->setCollision (collision);
+        map_sector->attachObject (object);
     }
 
-    return tile_desc;
+    for (size_t i = 0; i < content.tiles.size (); ++i)
+    {
+        if (content.tiles[i] != 0)
+            sector.tiles.emplace_back (static_cast<uint32_t> (i), content.palette[content.tiles[i]]);
+    }
+
+    map_sector->setModified (false);
+    sector.sector = std::move (map_sector);
+    return true;
+}
+
+bool SectorLoader::loadBinarySector (const std::string& path, Vector2u size, LoadedSector& sector)
+{
+    BinarySector binary;
+    if (!binary.open (sector.data.data (), sector.data.size ()))
+    {
+        runtime_message ("Wrong binary map sector in file " + path);
+        sector.data.clear ();
+        return false;
+    }
+
+    // Tiles are used in place, so they must cover the whole sector
+    if (binary.getSize () != size)
+    {
+        runtime_message ("Size of binary map sector in file " + path + " doesn't match description of map");
+        sector.data.clear ();
+        return false;
+    }
+
+    std::unique_ptr<MapSector> map_sector (std::make_unique<MapSector> (size));
+    map_sector->setName (binary.getName ());
+    map_sector->setTileSize (binary.getTileSize ());
+
+    std::vector<WayPoint> way_points;
+    way_points.reserve (binary.getWayPointsCount ());
+    for (uint32_t i = 0; i < binary.getWayPointsCount (); ++i)
+        way_points.push_back (binary.getWayPoint (i));
+    map_sector->setWayPoints (std::move (way_points));
+
+    for (uint32_t i = 0; i < binary.getObjectsCount (); ++i)
+    {
+        std::shared_ptr<StaticObject> object (std::make_shared<StaticObject> ());
+        object->setCollision (binary.getObject (i));
+        map_sector->attachObject (object);
+    }
+
+    map_sector->setModified (false);
+    sector.sector = std::move (map_sector);
+    return true;
+}
+
+void SectorLoader::startWorkers ()
+{
+    if (!m_workers)
+        m_workers.reset (new WorkerPool (m_threads));
+}
+
+bool SectorLoader::readFile (const std::string& path, std::vector<char>& data)
+{
+    // Stream has one position, so files are read one by one while the
+    // rest of loading runs in parallel
+    std::lock_guard<std::mutex> lock (m_stream_mutex);
+
+    if (!m_stream->open (path))
+        return false;
+
+    int64_t size (m_stream->getSize ());
+    if (size <= 0)
+        return false;
+
+    data.resize (size_t (size) + 1);
+    if (m_stream->read (data.data (), size) != size)
+        return false;
+
+    data[size_t (size)] = '\0';
+    return true;
 }
@@ -28,10 +28,20 @@
 
 
 
+#pragma once
+
+
 #include "MapSectorDesc.h"
 
 #include <SFGE/ResourceInputStream.h>
 
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+#include <utility>
 #include <vector>
 
 
@@ -39,39 +49,149 @@ namespace sfge
 {
 
 
-    class TextParser;
-    struct SemanticsDescription;
+    class WorkerPool;
 
 
+    /////////////////////////////////////////////////////////////////////
+    /// SectorLoader - load sectors of map from resource files
+    ///
+    /// Sectors can be loaded at once or streamed in background: files are
+    /// read and parsed on worker threads, and loaded sectors are taken by
+    /// map manager on its own thread. Textures of tiles are set only when
+    /// sector is taken, because resource manager isn't thread-safe.
+    ///
+    /// Sectors which are loaded at once pass a pipeline: files are read
+    /// one by one by a worker, every read file is parsed by another worker
+    /// and the calling thread finishes parsed sectors meanwhile.
+    ///
+    /// Files of sectors may be text or binary, format is found by content.
+    /////////////////////////////////////////////////////////////////////
     class SectorLoader
     {
     public:
+        typedef std::vector<std::pair<uint32_t, std::string>> TileList;
+        typedef std::function<void (size_t index)> Finisher;
+
+        struct LoadedSector
+        {
+            uint32_t id;
+            std::unique_ptr<MapSector> sector;  // nullptr if loading failed
+            TileList tiles;                     // tiles of text sector
+            std::vector<char> data;             // content of binary sector, its tiles are used in place
+        };
 
         /////////////////////////////////////////////////////////////////////
         /// Constructor
         ///
+        /// Stream mustn't be used by anybody else while sectors are
+        /// streamed, reading from it is serialized by loader.
+        ///
         /// @param stream - source for loading file
+        /// @param threads - number of threads for loading, zero means number
+        /// of cores
         /////////////////////////////////////////////////////////////////////
-        SectorLoader (iResourceInputStream* stream);
-        
+        SectorLoader (iResourceInputStream* stream, size_t threads = 0);
+
         /////////////////////////////////////////////////////////////////////
-        /// loadSectors - load sectors of map
+        /// Destructor
+        ///
+        /// Waits for sectors which are being loaded, other requests are
+        /// dropped.
+        /////////////////////////////////////////////////////////////////////
+        ~SectorLoader ();
+
+        /////////////////////////////////////////////////////////////////////
+        /// loadSectors - load sectors of map and wait for them
+        ///
+        /// Sectors are read and parsed on worker threads, textures of tiles
+        /// are set on the calling thread. Sector which can't be loaded is
+        /// left empty.
         ///
         /// @param sectors - pointers to sectors which should be loaded
+        /// @param finish - function which is called on the calling thread
+        /// for every loaded sector in order of sectors, while the next ones
+        /// are still parsed
+        /////////////////////////////////////////////////////////////////////
+        void loadSectors (const std::vector<MapSectorDesc*>& sectors, const Finisher& finish = Finisher ());
+
+        /////////////////////////////////////////////////////////////////////
+        /// requestSector - start loading of sector in background
+        ///
+        /// Sectors are loaded in order of requests. Request of sector
+        /// which is being loaded is ignored.
+        ///
+        /// @param id - id of sector
+        /// @param desc - description of sector
         /////////////////////////////////////////////////////////////////////
-        void loadSectors (const std::vector<MapSectorDesc*>& sectors);
+        void requestSector (uint32_t id, const MapSectorDesc& desc);
+
+        /////////////////////////////////////////////////////////////////////
+        /// isRequested - check is sector being loaded or waiting to be taken
+        ///
+        /// @param id - id of sector
+        ///
+        /// @return - true if sector was requested and not taken yet
+        /////////////////////////////////////////////////////////////////////
+        bool isRequested (uint32_t id) const;
+
+        /////////////////////////////////////////////////////////////////////
+        /// getRequestCount - get number of requested sectors which weren't
+        /// taken yet
+        ///
+        /// @return - number of sectors
+        /////////////////////////////////////////////////////////////////////
+        size_t getRequestCount () const;
+
+        /////////////////////////////////////////////////////////////////////
+        /// takeSectors - take sectors which were loaded in background
+        ///
+        /// @param sectors - loaded sectors in order of loading
+        /////////////////////////////////////////////////////////////////////
+        void takeSectors (std::vector<LoadedSector>& sectors);
+
+        /////////////////////////////////////////////////////////////////////
+        /// wait - wait until all requested sectors are loaded
+        /////////////////////////////////////////////////////////////////////
+        void wait ();
+
+        /////////////////////////////////////////////////////////////////////
+        /// setTiles - set textures of tiles to loaded sector
+        ///
+        /// Method should be called on the thread which owns resource
+        /// manager. Tiles and content of file are released after that.
+        ///
+        /// @param sector - loaded sector
+        /////////////////////////////////////////////////////////////////////
+        static void setTiles (LoadedSector& sector);
 
     private:
-        bool loadMapSector (TextParser* tp, MapSector* sector);
+        bool loadSector (const std::string& path, Vector2u size, LoadedSector& sector);
+
+        bool parseSector (const std::string& path, Vector2u size, std::vector<char>& data, LoadedSector& sector);
+
+        void startWorkers ();
 
-        std::pair<uint32_t, std::string> loadTile (TextParser* tp, Uint32 sector_width);
+        bool loadTextSector (const std::string& path, Vector2u size, const char* text, LoadedSector& sector);
+
+        bool loadBinarySector (const std::string& path, Vector2u size, LoadedSector& sector);
+
+        bool readFile (const std::string& path, std::vector<char>& data);
 
     private:
         iResourceInputStream* m_stream;
+        std::mutex m_stream_mutex;
 
-    private:
-        static const SemanticsDescription m_sem_desc;
+        mutable std::mutex m_mutex;
+        std::condition_variable m_sector_loaded;
+        std::unordered_set<uint32_t> m_requested;
+        std::vector<LoadedSector> m_loaded;
+        size_t m_loading = 0;
+
+        size_t m_threads;
+
+        // Workers are destroyed first, so tasks never see destroyed members
+        std::unique_ptr<WorkerPool> m_workers;
     };
 
 
-}
\ No newline at end of file
+}
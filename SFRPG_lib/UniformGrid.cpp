@@ -0,0 +1,276 @@
+/////////////////////////////////////////////////////////////////////
+//
+// SFGE - Simple and Fast Game Engine
+//
+// Copyright (c) 2016-2017 DonRumata710 
+// 
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation
+// files (the "Software"), to deal in the Software without
+// restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+// WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+// 
+/////////////////////////////////////////////////////////////////////
+
+
+#include "UniformGrid.h"
+
+#include <algorithm>
+#include <cmath>
+
+
+using namespace sfge;
+
+
+void UniformGrid::reset (const FloatRect& area, float cell_size, uint32_t max_cells)
+{
+    m_area = area;
+    m_cell_size = std::max (cell_size, 1.0f);
+
+    float max_side (std::max (area.width, area.height));
+    if (max_side > m_cell_size * max_cells)
+        m_cell_size = max_side / max_cells;
+
+    m_columns = std::max (static_cast<uint32_t> (std::ceil (area.width / m_cell_size)), 1u);
+    m_rows = std::max (static_cast<uint32_t> (std::ceil (area.height / m_cell_size)), 1u);
+
+    m_cells.clear ();
+    m_cells.resize (size_t (m_columns) * m_rows);
+}
+
+void UniformGrid::clear ()
+{
+    for (auto& cell : m_cells)
+        cell.clear ();
+}
+
+void UniformGrid::move (Vector2f offset)
+{
+    m_area.left += offset.x;
+    m_area.top += offset.y;
+}
+
+FloatRect UniformGrid::getArea () const
+{
+    return m_area;
+}
+
+float UniformGrid::getCellSize () const
+{
+    return m_cell_size;
+}
+
+size_t UniformGrid::getMemoryUsage () const
+{
+    size_t bytes (m_cells.capacity () * sizeof (std::vector<uint32_t>));
+    for (const auto& cell : m_cells)
+        bytes += cell.capacity () * sizeof (uint32_t);
+
+    return bytes;
+}
+
+void UniformGrid::insert (uint32_t id, const FloatRect& bounds)
+{
+    if (m_cells.empty ())
+        return;
+
+    uint32_t first_column (getColumn (bounds.left));
+    uint32_t last_column (getColumn (bounds.left + bounds.width));
+    uint32_t first_row (getRow (bounds.top));
+    uint32_t last_row (getRow (bounds.top + bounds.height));
+
+    for (uint32_t row = first_row; row <= last_row; ++row)
+    {
+        for (uint32_t column = first_column; column <= last_column; ++column)
+            m_cells[size_t (row) * m_columns + column].push_back (id);
+    }
+}
+
+void UniformGrid::remove (uint32_t id, const FloatRect& bounds)
+{
+    if (m_cells.empty ())
+        return;
+
+    uint32_t first_column (getColumn (bounds.left));
+    uint32_t last_column (getColumn (bounds.left + bounds.width));
+    uint32_t first_row (getRow (bounds.top));
+    uint32_t last_row (getRow (bounds.top + bounds.height));
+
+    for (uint32_t row = first_row; row <= last_row; ++row)
+    {
+        for (uint32_t column = first_column; column <= last_column; ++column)
+        {
+            auto& cell (m_cells[size_t (row) * m_columns + column]);
+            auto item (std::find (cell.begin (), cell.end (), id));
+            if (item != cell.end ())
+                cell.erase (item);
+        }
+    }
+}
+
+void UniformGrid::update (uint32_t id, const FloatRect& old_bounds, const FloatRect& new_bounds)
+{
+    if (m_cells.empty ())
+        return;
+
+    uint32_t old_first_column (getColumn (old_bounds.left));
+    uint32_t old_last_column (getColumn (old_bounds.left + old_bounds.width));
+    uint32_t old_first_row (getRow (old_bounds.top));
+    uint32_t old_last_row (getRow (old_bounds.top + old_bounds.height));
+
+    uint32_t first_column (getColumn (new_bounds.left));
+    uint32_t last_column (getColumn (new_bounds.left + new_bounds.width));
+    uint32_t first_row (getRow (new_bounds.top));
+    uint32_t last_row (getRow (new_bounds.top + new_bounds.height));
+
+    if (old_first_column == first_column && old_last_column == last_column &&
+        old_first_row == first_row && old_last_row == last_row)
+        return;
+
+    auto is_new_cell = [&](uint32_t row, uint32_t column)
+    {
+        return row >= first_row && row <= last_row && column >= first_column && column <= last_column;
+    };
+
+    auto is_old_cell = [&](uint32_t row, uint32_t column)
+    {
+        return row >= old_first_row && row <= old_last_row && column >= old_first_column && column <= old_last_column;
+    };
+
+    for (uint32_t row = old_first_row; row <= old_last_row; ++row)
+    {
+        for (uint32_t column = old_first_column; column <= old_last_column; ++column)
+        {
+            if (is_new_cell (row, column))
+                continue;
+
+            auto& cell (m_cells[size_t (row) * m_columns + column]);
+            auto item (std::find (cell.begin (), cell.end (), id));
+            if (item != cell.end ())
+                cell.erase (item);
+        }
+    }
+
+    for (uint32_t row = first_row; row <= last_row; ++row)
+    {
+        for (uint32_t column = first_column; column <= last_column; ++column)
+        {
+            if (!is_old_cell (row, column))
+                m_cells[size_t (row) * m_columns + column].push_back (id);
+        }
+    }
+}
+
+const std::vector<uint32_t>& UniformGrid::getCell (Vector2f point) const
+{
+    static const std::vector<uint32_t> empty_cell;
+
+    if (m_cells.empty ())
+        return empty_cell;
+
+    return m_cells[size_t (getRow (point.y)) * m_columns + getColumn (point.x)];
+}
+
+void UniformGrid::query (const FloatRect& rect, std::vector<uint32_t>& ids) const
+{
+    ids.clear ();
+
+    if (m_cells.empty ())
+        return;
+
+    uint32_t first_column (getColumn (rect.left));
+    uint32_t last_column (getColumn (rect.left + rect.width));
+    uint32_t first_row (getRow (rect.top));
+    uint32_t last_row (getRow (rect.top + rect.height));
+
+    for (uint32_t row = first_row; row <= last_row; ++row)
+    {
+        for (uint32_t column = first_column; column <= last_column; ++column)
+        {
+            const auto& cell (m_cells[size_t (row) * m_columns + column]);
+            ids.insert (ids.end (), cell.begin (), cell.end ());
+        }
+    }
+
+    std::sort (ids.begin (), ids.end ());
+    ids.erase (std::unique (ids.begin (), ids.end ()), ids.end ());
+}
+
+void UniformGrid::querySegment (Vector2f p1, Vector2f p2, std::vector<uint32_t>& ids) const
+{
+    ids.clear ();
+
+    if (m_cells.empty ())
+        return;
+
+    if (p1.y > p2.y)
+        std::swap (p1, p2);
+
+    uint32_t first_row (getRow (p1.y));
+    uint32_t last_row (getRow (p2.y));
+
+    // Small margin keeps cells which are touched by segment exactly on the border
+    float margin (m_cell_size * 1e-4f);
+
+    for (uint32_t row = first_row; row <= last_row; ++row)
+    {
+        float x1 (p1.x);
+        float x2 (p2.x);
+
+        if (p2.y != p1.y)
+        {
+            float top (row == first_row ? p1.y : m_area.top + row * m_cell_size);
+            float bottom (row == last_row ? p2.y : m_area.top + (row + 1) * m_cell_size);
+            float slope ((p2.x - p1.x) / (p2.y - p1.y));
+
+            x1 = p1.x + (top - p1.y) * slope;
+            x2 = p1.x + (bottom - p1.y) * slope;
+        }
+
+        uint32_t first_column (getColumn (std::min (x1, x2) - margin));
+        uint32_t last_column (getColumn (std::max (x1, x2) + margin));
+
+        for (uint32_t column = first_column; column <= last_column; ++column)
+        {
+            const auto& cell (m_cells[size_t (row) * m_columns + column]);
+            ids.insert (ids.end (), cell.begin (), cell.end ());
+        }
+    }
+
+    std::sort (ids.begin (), ids.end ());
+    ids.erase (std::unique (ids.begin (), ids.end ()), ids.end ());
+}
+
+uint32_t UniformGrid::getColumn (float x) const
+{
+    float column (std::floor ((x - m_area.left) / m_cell_size));
+    if (!(column > 0.0f))
+        return 0;
+    if (column >= m_columns)
+        return m_columns - 1;
+    return static_cast<uint32_t> (column);
+}
+
+uint32_t UniformGrid::getRow (float y) const
+{
+    float row (std::floor ((y - m_area.top) / m_cell_size));
+    if (!(row > 0.0f))
+        return 0;
+    if (row >= m_rows)
+        return m_rows - 1;
+    return static_cast<uint32_t> (row);
+}
@@ -0,0 +1,192 @@
+/////////////////////////////////////////////////////////////////////
+//
+// SFGE - Simple and Fast Game Engine
+//
+// Copyright (c) 2016-2017 DonRumata710 
+// 
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation
+// files (the "Software"), to deal in the Software without
+// restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+// WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+// 
+/////////////////////////////////////////////////////////////////////
+
+
+#include "WalkabilityGrid.h"
+#include "Collision.h"
+
+#include <algorithm>
+#include <cmath>
+
+
+using namespace sfge;
+
+
+void WalkabilityGrid::reset (Vector2f origin, uint32_t width, uint32_t height, float cell_size, bool walkable)
+{
+    m_origin = origin;
+    m_width = width;
+    m_height = height;
+    m_cell_size = cell_size;
+
+    m_blocked.assign ((size_t (width) * height + 63) / 64, walkable ? 0 : UINT64_MAX);
+}
+
+void WalkabilityGrid::move (Vector2f offset)
+{
+    m_origin += offset;
+}
+
+Vector2f WalkabilityGrid::getOrigin () const
+{
+    return m_origin;
+}
+
+uint32_t WalkabilityGrid::getWidth () const
+{
+    return m_width;
+}
+
+uint32_t WalkabilityGrid::getHeight () const
+{
+    return m_height;
+}
+
+float WalkabilityGrid::getCellSize () const
+{
+    return m_cell_size;
+}
+
+size_t WalkabilityGrid::getMemoryUsage () const
+{
+    return m_blocked.capacity () * sizeof (uint64_t);
+}
+
+bool WalkabilityGrid::isWalkable (int32_t x, int32_t y) const
+{
+    if (!isInside (x, y))
+        return false;
+
+    size_t index (size_t (y) * m_width + x);
+    return (m_blocked[index / 64] & (uint64_t (1) << (index % 64))) == 0;
+}
+
+void WalkabilityGrid::setWalkable (int32_t x, int32_t y, bool walkable)
+{
+    if (!isInside (x, y))
+        return;
+
+    size_t index (size_t (y) * m_width + x);
+    if (walkable)
+        m_blocked[index / 64] &= ~(uint64_t (1) << (index % 64));
+    else
+        m_blocked[index / 64] |= uint64_t (1) << (index % 64);
+}
+
+Vector2i WalkabilityGrid::getCell (Vector2f point) const
+{
+    return Vector2i (
+        static_cast<int32_t> (std::floor ((point.x - m_origin.x) / m_cell_size)),
+        static_cast<int32_t> (std::floor ((point.y - m_origin.y) / m_cell_size))
+    );
+}
+
+Vector2f WalkabilityGrid::getCellCenter (Vector2i cell) const
+{
+    return Vector2f (
+        m_origin.x + (cell.x + 0.5f) * m_cell_size,
+        m_origin.y + (cell.y + 0.5f) * m_cell_size
+    );
+}
+
+void WalkabilityGrid::rasterize (const Collision& collision)
+{
+    FloatRect bounds (collision.getBounds ());
+
+    Vector2i first;
+    Vector2i last;
+    getCellRange (bounds, first, last);
+
+    // Polygon which is placed inside one cell doesn't cross its sides
+    if (getCell ({ bounds.left, bounds.top }) == getCell ({ bounds.left + bounds.width, bounds.top + bounds.height }))
+    {
+        Vector2i cell (getCell ({ bounds.left, bounds.top }));
+        setWalkable (cell.x, cell.y, false);
+        return;
+    }
+
+    for (int32_t y = first.y; y <= last.y; ++y)
+    {
+        for (int32_t x = first.x; x <= last.x; ++x)
+        {
+            Vector2f corner (m_origin.x + x * m_cell_size, m_origin.y + y * m_cell_size);
+            Vector2f right (corner.x + m_cell_size, corner.y);
+            Vector2f bottom (corner.x, corner.y + m_cell_size);
+            Vector2f opposite (corner.x + m_cell_size, corner.y + m_cell_size);
+
+            if (collision.check (getCellCenter ({ x, y })) != Collision::State::OUTSIDE ||
+                collision.check (corner, right) != Collision::State::OUTSIDE ||
+                collision.check (corner, bottom) != Collision::State::OUTSIDE ||
+                collision.check (right, opposite) != Collision::State::OUTSIDE ||
+                collision.check (bottom, opposite) != Collision::State::OUTSIDE)
+            {
+                setWalkable (x, y, false);
+            }
+        }
+    }
+}
+
+void WalkabilityGrid::clear (const FloatRect& area)
+{
+    Vector2i first;
+    Vector2i last;
+    getCellRange (area, first, last);
+
+    for (int32_t y = first.y; y <= last.y; ++y)
+    {
+        for (int32_t x = first.x; x <= last.x; ++x)
+            setWalkable (x, y, true);
+    }
+}
+
+void WalkabilityGrid::copy (const WalkabilityGrid& grid)
+{
+    Vector2i shift (getCell (grid.getCellCenter ({ 0, 0 })));
+
+    for (uint32_t y = 0; y < grid.getHeight (); ++y)
+    {
+        for (uint32_t x = 0; x < grid.getWidth (); ++x)
+            setWalkable (shift.x + x, shift.y + y, grid.isWalkable (x, y));
+    }
+}
+
+bool WalkabilityGrid::isInside (int32_t x, int32_t y) const
+{
+    return x >= 0 && y >= 0 && uint32_t (x) < m_width && uint32_t (y) < m_height;
+}
+
+void WalkabilityGrid::getCellRange (const FloatRect& area, Vector2i& first, Vector2i& last) const
+{
+    first = getCell ({ area.left, area.top });
+    last = getCell ({ area.left + area.width, area.top + area.height });
+
+    first.x = std::max (first.x, 0);
+    first.y = std::max (first.y, 0);
+    last.x = std::min (last.x, int32_t (m_width) - 1);
+    last.y = std::min (last.y, int32_t (m_height) - 1);
+}
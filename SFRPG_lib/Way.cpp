@@ -45,9 +45,37 @@ sfge::Way::Way (WayPoints&& points) :
     m_current_point (m_points.begin ())
 {}
 
+sfge::Way::Way (const Way& way) :
+    m_points (way.m_points),
+    m_current_point (m_points.begin () + (way.m_current_point - way.m_points.begin ()))
+{}
+
+sfge::Way::Way (Way&& way)
+{
+    auto current (way.m_current_point - way.m_points.begin ());
+    m_points = std::move (way.m_points);
+    m_current_point = m_points.begin () + current;
+}
+
+Way& sfge::Way::operator= (const Way& way)
+{
+    m_points = way.m_points;
+    m_current_point = m_points.begin () + (way.m_current_point - way.m_points.begin ());
+    return *this;
+}
+
+Way& sfge::Way::operator= (Way&& way)
+{
+    auto current (way.m_current_point - way.m_points.begin ());
+    m_points = std::move (way.m_points);
+    m_current_point = m_points.begin () + current;
+    return *this;
+}
+
 void sfge::Way::clear ()
 {
     m_points.clear ();
+    m_current_point = m_points.begin ();
 }
 
 void sfge::Way::pushPointFront (Vector2f point)
@@ -89,9 +117,9 @@ float Way::getLength () const
 {
     float sum (0.0f);
 
-    for (size_t i = 0; i < m_points.size () - 1; ++i)
+    for (size_t i = 1; i < m_points.size (); ++i)
     {
-        Vector2f dist (m_points[i] - m_points[i + 1]);
+        Vector2f dist (m_points[i - 1] - m_points[i]);
         sum += sqrt (dist.x * dist.x + dist.y * dist.y);
     }
 
@@ -102,3 +130,8 @@ size_t Way::getPoints () const
 {
     return m_points.size ();
 }
+
+bool Way::isEmpty () const
+{
+    return m_points.empty ();
+}
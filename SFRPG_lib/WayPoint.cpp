@@ -29,8 +29,10 @@
 
 #include "WayPoint.h"
 
+#include <algorithm>
 #include <cmath>
 #include <cfloat>
+#include <functional>
 
 
 using namespace sfge;
@@ -46,6 +48,35 @@ void WayPoint::assignEdges (const EdgeList& edges)
     m_neighbours.assign (edges.begin (), edges.end ());
 }
 
+void WayPoint::addEdges (const EdgeList& edges)
+{
+    m_neighbours.insert (m_neighbours.end (), edges.begin (), edges.end ());
+}
+
+void WayPoint::addEdge (const WayPoint* point)
+{
+    m_neighbours.push_back (point);
+}
+
+void WayPoint::removeEdge (const WayPoint* point)
+{
+    m_neighbours.erase (std::remove (m_neighbours.begin (), m_neighbours.end (), point), m_neighbours.end ());
+}
+
+void WayPoint::removeEdges (const WayPoint* first, const WayPoint* last)
+{
+    std::less<const WayPoint*> less;
+    m_neighbours.erase (std::remove_if (m_neighbours.begin (), m_neighbours.end (), [&](const WayPoint* point)
+    {
+        return !less (point, first) && less (point, last);
+    }), m_neighbours.end ());
+}
+
+bool WayPoint::hasEdge (const WayPoint* point) const
+{
+    return std::find (m_neighbours.begin (), m_neighbours.end (), point) != m_neighbours.end ();
+}
+
 const WayPoint::EdgeList& WayPoint::getEdges () const
 {
     return m_neighbours;
@@ -0,0 +1,141 @@
+/////////////////////////////////////////////////////////////////////
+//
+// SFGE - Simple and Fast Game Engine
+//
+// Copyright (c) 2016-2017 DonRumata710 
+// 
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation
+// files (the "Software"), to deal in the Software without
+// restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+// WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+// 
+/////////////////////////////////////////////////////////////////////
+
+
+#include "WorkerPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+
+
+using namespace sfge;
+
+
+WorkerPool::WorkerPool (size_t threads)
+{
+    if (threads == 0)
+        threads = std::max (1u, std::thread::hardware_concurrency ());
+
+    for (size_t i = 0; i < threads; ++i)
+        m_threads.emplace_back (&WorkerPool::work, this, i);
+}
+
+WorkerPool::~WorkerPool ()
+{
+    {
+        std::lock_guard<std::mutex> lock (m_mutex);
+        m_stop = true;
+    }
+    m_task_added.notify_all ();
+
+    for (std::thread& thread : m_threads)
+        thread.join ();
+}
+
+size_t WorkerPool::getThreadCount () const
+{
+    return m_threads.size ();
+}
+
+void WorkerPool::push (Task task)
+{
+    {
+        std::lock_guard<std::mutex> lock (m_mutex);
+        m_tasks.push_back (std::move (task));
+    }
+    m_task_added.notify_one ();
+}
+
+void WorkerPool::run (size_t count, const std::function<void (size_t index, size_t worker)>& function)
+{
+    if (count == 0)
+        return;
+
+    std::atomic<size_t> next_index (0);
+    size_t chunks (std::min (count, m_threads.size ()));
+    size_t finished_chunks (0);
+
+    std::mutex mutex;
+    std::condition_variable chunk_finished;
+    std::exception_ptr error;
+
+    for (size_t i = 0; i < chunks; ++i)
+    {
+        push ([&](size_t worker)
+        {
+            // Exception can't leave worker thread, it is passed to caller
+            std::exception_ptr chunk_error;
+            try
+            {
+                for (size_t index = next_index++; index < count; index = next_index++)
+                    function (index, worker);
+            }
+            catch (...)
+            {
+                chunk_error = std::current_exception ();
+                next_index = count;
+            }
+
+            std::lock_guard<std::mutex> lock (mutex);
+            if (chunk_error && !error)
+                error = chunk_error;
+            ++finished_chunks;
+            chunk_finished.notify_one ();
+        });
+    }
+
+    {
+        std::unique_lock<std::mutex> lock (mutex);
+        chunk_finished.wait (lock, [&]() { return finished_chunks == chunks; });
+    }
+
+    if (error)
+        std::rethrow_exception (error);
+}
+
+void WorkerPool::work (size_t worker)
+{
+    while (true)
+    {
+        Task task;
+
+        {
+            std::unique_lock<std::mutex> lock (m_mutex);
+            m_task_added.wait (lock, [this]() { return m_stop || !m_tasks.empty (); });
+
+            if (m_stop)
+                return;
+
+            task = std::move (m_tasks.front ());
+            m_tasks.pop_front ();
+        }
+
+        task (worker);
+    }
+}
@@ -0,0 +1,112 @@
+/////////////////////////////////////////////////////////////////////
+//
+// SFGE - Simple and Fast Game Engine
+//
+// Copyright (c) 2016-2017 DonRumata710 
+// 
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation
+// files (the "Software"), to deal in the Software without
+// restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+// WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+// 
+/////////////////////////////////////////////////////////////////////
+
+
+#pragma once
+
+
+#include <condition_variable>
+#include <functional>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+namespace sfge
+{
+
+
+    /////////////////////////////////////////////////////////////////////
+    /// WorkerPool - pool of worker threads
+    ///
+    /// Every task receives index of worker which runs it, so tasks can
+    /// use per-thread scratch data without locking.
+    /////////////////////////////////////////////////////////////////////
+    class WorkerPool
+    {
+    public:
+        typedef std::function<void (size_t worker)> Task;
+
+        /////////////////////////////////////////////////////////////////////
+        /// Constructor
+        ///
+        /// @param threads - number of threads, zero means number of cores
+        /////////////////////////////////////////////////////////////////////
+        explicit WorkerPool (size_t threads = 0);
+
+        /////////////////////////////////////////////////////////////////////
+        /// Destructor
+        ///
+        /// Waits for running tasks, tasks which were not started are dropped.
+        /////////////////////////////////////////////////////////////////////
+        ~WorkerPool ();
+
+        WorkerPool (const WorkerPool&) = delete;
+        WorkerPool& operator= (const WorkerPool&) = delete;
+
+        /////////////////////////////////////////////////////////////////////
+        /// getThreadCount - get number of worker threads
+        ///
+        /// @return - number of threads
+        /////////////////////////////////////////////////////////////////////
+        size_t getThreadCount () const;
+
+        /////////////////////////////////////////////////////////////////////
+        /// push - add task to queue
+        ///
+        /// @param task - task
+        /////////////////////////////////////////////////////////////////////
+        void push (Task task);
+
+        /////////////////////////////////////////////////////////////////////
+        /// run - run function for each index in range [0, count)
+        ///
+        /// Method returns when all indices are processed. If function throws,
+        /// the rest of indices are skipped and the first exception is thrown
+        /// again by this method when all started calls are finished.
+        ///
+        /// @param count - number of indices
+        /// @param function - function which receives index and worker
+        /////////////////////////////////////////////////////////////////////
+        void run (size_t count, const std::function<void (size_t index, size_t worker)>& function);
+
+    private:
+        void work (size_t worker);
+
+    private:
+        std::vector<std::thread> m_threads;
+        std::deque<Task> m_tasks;
+
+        std::mutex m_mutex;
+        std::condition_variable m_task_added;
+        bool m_stop = false;
+    };
+
+
+}
@@ -52,7 +52,10 @@ void World::loadMap (const std::string& path)
 {
     std::shared_ptr<iResourceInputStream> stream (std::make_shared<FileInputStream> ());
     std::shared_ptr<MapLoader> loader (std::make_shared<MapLoader> (stream.get ()));
+
+    // Previous map may still read sectors from previous stream
     setMap (std::make_shared<MapManager> ());
+    m_stream = stream;
     if (!loader->loadMap (getMap ().get (), getMapName (path)))
         getMap ().reset ();
 }
@@ -68,6 +71,7 @@ void World::saveMap (const std::string& path)
 void World::closeMap ()
 {
     m_map.reset ();
+    m_stream.reset ();
     sf::Sprite sprite;
     sprite.setColor (sf::Color::Black);
     m_screen.draw (sprite);
@@ -112,6 +116,10 @@ void World::draw (sf::RenderTarget& target) const
 
 void World::update (const float delta)
 {
+    // Sectors which were streamed during the last frame appear before drawing
+    if (m_map)
+        m_map->update ();
+
     redraw ();
 }
 
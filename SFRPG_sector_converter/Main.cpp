@@ -0,0 +1,192 @@
+/////////////////////////////////////////////////////////////////////
+//
+// SFGE - Simple and Fast Game Engine
+//
+// Copyright (c) 2016-2017 DonRumata710 
+// 
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation
+// files (the "Software"), to deal in the Software without
+// restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+// WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+// 
+/////////////////////////////////////////////////////////////////////
+
+
+#include <SFRPG/SectorFormat.h>
+
+#include <SFGE/FileOutputStream.h>
+
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+
+
+using namespace sfge;
+
+
+namespace
+{
+
+    enum class Format
+    {
+        SAME_AS_INPUT,
+        TEXT,
+        BINARY
+    };
+
+    struct Options
+    {
+        Format format = Format::SAME_AS_INPUT;
+        Vector2u size;
+        std::string input;
+        std::string output;
+    };
+
+    void printUsage ()
+    {
+        std::cerr <<
+            "Usage: SFRPG_sector_converter [options] input output\n"
+            "  --to text|binary           format of output, opposite to input by default\n"
+            "  --width 64                 width of text sector, found by tiles by default\n"
+            "  --height 64                height of text sector, found by tiles by default\n";
+    }
+
+    bool parseOptions (int argc, char* argv[], Options& options)
+    {
+        std::vector<std::string> files;
+        for (int i = 1; i < argc; ++i)
+        {
+            std::string name (argv[i]);
+            if (name == "--help")
+                return false;
+
+            if (name.compare (0, 2, "--") != 0)
+            {
+                files.push_back (name);
+                continue;
+            }
+
+            if (i + 1 >= argc)
+                return false;
+
+            std::string value (argv[++i]);
+            try
+            {
+                if (name == "--to" && value == "text")
+                    options.format = Format::TEXT;
+                else if (name == "--to" && value == "binary")
+                    options.format = Format::BINARY;
+                else if (name == "--width")
+                    options.size.x = std::stoul (value);
+                else if (name == "--height")
+                    options.size.y = std::stoul (value);
+                else
+                    return false;
+            }
+            catch (const std::logic_error&)
+            {
+                return false;
+            }
+        }
+
+        if (files.size () != 2)
+            return false;
+
+        options.input = files[0];
+        options.output = files[1];
+        return true;
+    }
+
+    bool readFile (const std::string& path, std::vector<char>& data)
+    {
+        std::ifstream file (path, std::ios::binary);
+        if (!file)
+            return false;
+
+        data.assign (std::istreambuf_iterator<char> (file), std::istreambuf_iterator<char> ());
+        return !file.bad ();
+    }
+
+}
+
+
+int main (int argc, char* argv[])
+{
+    Options options;
+    if (!parseOptions (argc, argv, options))
+    {
+        printUsage ();
+        return 1;
+    }
+
+    std::vector<char> data;
+    if (!readFile (options.input, data))
+    {
+        std::cerr << "Can't read " << options.input << std::endl;
+        return 1;
+    }
+
+    SectorData sector;
+    bool binary (SectorFormat::isBinary (data.data (), data.size ()));
+    if (binary)
+    {
+        BinarySector view;
+        if (!view.open (data.data (), data.size ()))
+        {
+            std::cerr << "Wrong binary sector " << options.input << std::endl;
+            return 1;
+        }
+        view.read (sector);
+    }
+    else
+    {
+        data.push_back ('\0');
+        if (!SectorFormat::readText (data.data (), options.size, sector))
+        {
+            std::cerr << "Wrong text sector " << options.input << std::endl;
+            return 1;
+        }
+    }
+
+    Format format (options.format);
+    if (format == Format::SAME_AS_INPUT)
+        format = binary ? Format::TEXT : Format::BINARY;
+
+    FileOutputStream stream;
+    if (!stream.open (options.output))
+    {
+        std::cerr << "Can't open " << options.output << std::endl;
+        return 1;
+    }
+
+    bool written (format == Format::BINARY ? SectorFormat::writeBinary (&stream, sector) : SectorFormat::writeText (&stream, sector));
+    if (!written)
+    {
+        std::cerr << "Can't write " << options.output << std::endl;
+        return 1;
+    }
+
+    std::cerr << options.input << " -> " << options.output << ": " <<
+        sector.size.x << "x" << sector.size.y << " tiles, " <<
+        sector.palette.size () - 1 << " textures, " <<
+        sector.way_points.size () << " way points, " <<
+        sector.objects.size () << " objects" << std::endl;
+
+    return 0;
+}
@@ -28,15 +28,138 @@
 
 
 #include <SFRPG/Collision.h>
+#include <SFRPG/InteractiveObject.h>
+#include <SFRPG/MapManager.h>
+#include <SFRPG/MapSector.h>
+#include <SFRPG/StaticObject.h>
 
 #include <catch.hpp>
 
+#include <algorithm>
+#include <cmath>
 #include <random>
 
 
 using namespace sfge;
 
 
+namespace
+{
+
+    // Checks without bounds rejection, results of Collision must be the same
+
+    float sign (Point p1, Point p2, Point p3)
+    {
+        return (p1.x - p3.x) * (p2.y - p3.y) - (p1.y - p3.y) * (p2.x - p3.x);
+    }
+
+    bool crossSegments (Point a, Point b, Point c, Point d)
+    {
+        const float eps (1e-4f);
+
+        float side_a (sign (a, c, d));
+        float side_b (sign (b, c, d));
+        float side_c (sign (c, a, b));
+        float side_d (sign (d, a, b));
+
+        return ((side_a < -eps && side_b > eps) || (side_a > eps && side_b < -eps)) &&
+            ((side_c < -eps && side_d > eps) || (side_c > eps && side_d < -eps));
+    }
+
+    bool isInside (const Circuit& points, Point p)
+    {
+        bool flag (sign (p, points.back (), points[0]) < 0.0f);
+
+        for (size_t i = 0; i < points.size () - 1; ++i)
+        {
+            if (flag != sign (p, points[i], points[i + 1]) < 0.0f)
+                return false;
+        }
+
+        return true;
+    }
+
+    Collision::State referenceCheck (const Circuit& first, const Circuit& second)
+    {
+        for (size_t i = 0; i < first.size (); ++i)
+        {
+            for (size_t j = 0; j < second.size (); ++j)
+            {
+                if (crossSegments (first[i], first[(i + 1) % first.size ()], second[j], second[(j + 1) % second.size ()]))
+                    return Collision::State::INTERSECTION;
+            }
+        }
+
+        return isInside (first, second[0]) ? Collision::State::INSIDE : Collision::State::OUTSIDE;
+    }
+
+    Collision::State referenceCheck (const Circuit& points, Point p1, Point p2)
+    {
+        for (size_t i = 0; i < points.size (); ++i)
+        {
+            if (crossSegments (points[i], points[(i + 1) % points.size ()], p1, p2))
+                return Collision::State::INTERSECTION;
+        }
+
+        return Collision::State::OUTSIDE;
+    }
+
+    Circuit makePolygon (std::mt19937& gen, Point center, float radius, int max_count = 8)
+    {
+        // Convex polygon with random number of vertices
+        std::uniform_real_distribution<float> angle (0.0f, 6.2831853f);
+        std::uniform_int_distribution<int> count (3, max_count);
+
+        std::vector<float> angles (count (gen));
+        for (float& a : angles)
+            a = angle (gen);
+        std::sort (angles.begin (), angles.end ());
+
+        Circuit points;
+        for (float a : angles)
+            points.push_back (center + Point (std::cos (a), std::sin (a)) * radius);
+        return points;
+    }
+
+    Circuit makeStar (std::mt19937& gen, Point center, float radius)
+    {
+        // Concave polygon: vertices are placed on rays with random lengths
+        std::uniform_real_distribution<float> length (0.3f, 1.0f);
+        std::uniform_int_distribution<int> count (5, 12);
+
+        Circuit points;
+        int n (count (gen));
+        for (int i = 0; i < n; ++i)
+        {
+            float a (6.2831853f * i / n);
+            points.push_back (center + Point (std::cos (a), std::sin (a)) * radius * length (gen));
+        }
+        return points;
+    }
+
+    // Even-odd rule works for any simple polygon
+    bool isInsidePolygon (const Circuit& points, Point p)
+    {
+        bool inside (false);
+        for (size_t i = 0, j = points.size () - 1; i < points.size (); j = i++)
+        {
+            if ((points[i].y > p.y) != (points[j].y > p.y) &&
+                p.x < (points[j].x - points[i].x) * (p.y - points[i].y) / (points[j].y - points[i].y) + points[i].x)
+                inside = !inside;
+        }
+        return inside;
+    }
+
+    Circuit shift (Circuit points, Vector2f offset)
+    {
+        for (Point& point : points)
+            point += offset;
+        return points;
+    }
+
+}
+
+
 TEST_CASE ("Test successful collisions")
 {
     Collision c1;
@@ -210,4 +333,558 @@ TEST_CASE ("Test collision movement")
         REQUIRE (c1.check (c2) == Collision::State::INTERSECTION);
         REQUIRE (c2.check (c1) == Collision::State::INTERSECTION);
     }
-}
\ No newline at end of file
+}
+
+TEST_CASE ("Test collision bounds")
+{
+    Collision c ({ { -2.0, 1.0 }, { 4.0, -3.0 }, { 2.0, 5.0 } });
+
+    FloatRect bounds (c.getBounds ());
+    REQUIRE (bounds.left == Approx (-2.0f));
+    REQUIRE (bounds.top == Approx (-3.0f));
+    REQUIRE (bounds.width == Approx (6.0f));
+    REQUIRE (bounds.height == Approx (8.0f));
+
+    c.move ({ 10.0f, 20.0f });
+    REQUIRE (c.getBounds ().left == Approx (8.0f));
+    REQUIRE (c.getBounds ().top == Approx (17.0f));
+    REQUIRE (c.getCenter ().x == Approx (11.0f));
+    REQUIRE (c.getCenter ().y == Approx (21.0f));
+    REQUIRE (c.getRadius () == Approx (std::sqrt (25.0f)));
+
+    c.setPosition ({ -5.0f, 0.0f });
+    c.setPoints ({ { 0.0, 0.0 }, { 1.0, 0.0 }, { 1.0, 1.0 } });
+    REQUIRE (c.getBounds ().left == Approx (-5.0f));
+    REQUIRE (c.getBounds ().width == Approx (1.0f));
+
+    REQUIRE (Collision ().check (c) == Collision::State::OUTSIDE);
+    REQUIRE (c.check (Collision ()) == Collision::State::OUTSIDE);
+}
+
+TEST_CASE ("Test collision rejection by bounds")
+{
+    std::mt19937 gen (11);
+    std::uniform_real_distribution<float> place (0.0f, 40.0f);
+    std::uniform_real_distribution<float> size (1.0f, 8.0f);
+
+    size_t rejected (0);
+    size_t detected (0);
+
+    for (size_t i = 0; i < 3000; ++i)
+    {
+        Circuit first (makePolygon (gen, { 0.0f, 0.0f }, size (gen)));
+        Circuit second (makePolygon (gen, { 0.0f, 0.0f }, size (gen)));
+        Vector2f first_pos (place (gen), place (gen));
+        Vector2f second_pos (place (gen), place (gen));
+
+        Collision c1 (first);
+        Collision c2;
+        c2.setPoints (second);
+        c1.setPosition (first_pos);
+        c2.move (second_pos);
+
+        Collision::State state (c1.check (c2));
+        REQUIRE (state == referenceCheck (shift (first, first_pos), shift (second, second_pos)));
+
+        Point p1 (place (gen), place (gen));
+        Point p2 (place (gen), place (gen));
+        REQUIRE (c1.check (p1, p2) == referenceCheck (shift (first, first_pos), p1, p2));
+        REQUIRE ((c1.check (p1) == Collision::State::INSIDE) == isInside (shift (first, first_pos), p1));
+
+        if (state == Collision::State::OUTSIDE)
+            ++rejected;
+        else
+            ++detected;
+    }
+
+    REQUIRE (rejected > 0);
+    REQUIRE (detected > 0);
+}
+
+TEST_CASE ("Test narrowphase classification")
+{
+    // Shapes are placed close to each other, so most pairs pass bounds
+    // rejection and are classified by separating axes and edges
+    std::mt19937 gen (5);
+    std::uniform_real_distribution<float> place (0.0f, 12.0f);
+    std::uniform_real_distribution<float> size (1.0f, 8.0f);
+
+    size_t states[3] = { 0, 0, 0 };
+
+    for (size_t i = 0; i < 5000; ++i)
+    {
+        Circuit first (makePolygon (gen, { 0.0f, 0.0f }, size (gen), 16));
+        Circuit second (makePolygon (gen, { 0.0f, 0.0f }, size (gen), 16));
+        Vector2f first_pos (place (gen), place (gen));
+        Vector2f second_pos (place (gen), place (gen));
+
+        Collision c1 (first);
+        Collision c2 (second);
+        c1.setPosition (first_pos);
+        c2.setPosition (second_pos);
+
+        Circuit first_world (shift (first, first_pos));
+        Circuit second_world (shift (second, second_pos));
+
+        Collision::State state (c1.check (c2));
+        REQUIRE (state == referenceCheck (first_world, second_world));
+        REQUIRE (c2.check (c1) == referenceCheck (second_world, first_world));
+        ++states[static_cast<int> (state)];
+
+        Point p1 (place (gen), place (gen));
+        Point p2 (place (gen), place (gen));
+        REQUIRE (c1.check (p1, p2) == referenceCheck (first_world, p1, p2));
+        REQUIRE ((c1.check (p1) == Collision::State::INSIDE) == isInside (first_world, p1));
+    }
+
+    REQUIRE (states[static_cast<int> (Collision::State::INTERSECTION)] > 0);
+    REQUIRE (states[static_cast<int> (Collision::State::INSIDE)] > 0);
+    REQUIRE (states[static_cast<int> (Collision::State::OUTSIDE)] > 0);
+}
+
+TEST_CASE ("Test concave collision")
+{
+    Circuit corner ({ { 0.0, 0.0 }, { 10.0, 0.0 }, { 10.0, 3.0 }, { 3.0, 3.0 }, { 3.0, 10.0 }, { 0.0, 10.0 } });
+    Collision c (corner);
+
+    REQUIRE (c.check (Point (1.5f, 8.0f)) == Collision::State::INSIDE);
+    REQUIRE (c.check (Point (8.0f, 1.5f)) == Collision::State::INSIDE);
+    REQUIRE (c.check (Point (7.0f, 7.0f)) == Collision::State::OUTSIDE);
+
+    Collision probe ({ { -0.5, -0.5 }, { 0.5, -0.5 }, { 0.0, 0.5 } });
+    probe.setPosition ({ 7.0f, 7.0f });
+    REQUIRE (c.check (probe) == Collision::State::OUTSIDE);
+    probe.setPosition ({ 1.5f, 6.0f });
+    REQUIRE (c.check (probe) == Collision::State::INSIDE);
+    probe.setPosition ({ 3.0f, 6.0f });
+    REQUIRE (c.check (probe) == Collision::State::INTERSECTION);
+
+    std::mt19937 gen (3);
+    std::uniform_real_distribution<float> place (-12.0f, 12.0f);
+
+    for (size_t i = 0; i < 300; ++i)
+    {
+        Circuit star (makeStar (gen, { 0.0f, 0.0f }, 10.0f));
+        Collision shape;
+        shape.setPoints (star);
+        shape.setPosition ({ 3.0f, -2.0f });
+        Circuit star_world (shift (star, { 3.0f, -2.0f }));
+
+        for (size_t j = 0; j < 50; ++j)
+        {
+            Point p (place (gen), place (gen));
+            REQUIRE ((shape.check (p) == Collision::State::INSIDE) == isInsidePolygon (star_world, p));
+
+            Circuit small (makePolygon (gen, { 0.0f, 0.0f }, 1.0f));
+            Collision other (small);
+            other.setPosition (p);
+
+            // Edges are crossed like before, containment follows even-odd rule
+            Circuit small_world (shift (small, p));
+            Collision::State expected (referenceCheck (star_world, small_world));
+            if (expected != Collision::State::INTERSECTION)
+                expected = isInsidePolygon (star_world, small_world[0]) ? Collision::State::INSIDE : Collision::State::OUTSIDE;
+
+            REQUIRE (shape.check (other) == expected);
+        }
+    }
+}
+
+TEST_CASE ("Test movement broadphase")
+{
+    std::unordered_map<uint32_t, MapSectorDesc> sectors;
+    sectors[0].size = { 100, 100 };
+    sectors[0].sector = std::make_unique<MapSector> (Vector2u (100, 100));
+    sectors[1].pos = { 100, 0 };
+    sectors[1].size = { 100, 100 };
+    sectors[1].sector = std::make_unique<MapSector> (Vector2u (100, 100));
+    MapSector* first (sectors[0].sector.get ());
+    MapSector* second (sectors[1].sector.get ());
+
+    MapManager map;
+    map.setMapDescription (std::move (sectors));
+
+    std::mt19937 gen (7);
+    std::uniform_real_distribution<float> place (20.0f, 80.0f);
+    std::uniform_real_distribution<float> step (-3.0f, 3.0f);
+
+    std::vector<std::shared_ptr<MapObject>> props;
+    for (size_t i = 0; i < 200; ++i)
+    {
+        std::shared_ptr<MapObject> prop (new StaticObject ());
+        Collision c;
+        c.setPoints ({ { 0.0, 0.0 }, { 3.0, 0.0 }, { 3.0, 3.0 }, { 0.0, 3.0 } });
+        c.setPosition ({ place (gen), place (gen) });
+        prop->setCollision (c);
+        first->attachObject (prop);
+        props.push_back (prop);
+    }
+
+    std::shared_ptr<InteractiveObject> object (new InteractiveObject ());
+    Collision c;
+    c.setPoints ({ { -1.0, -1.0 }, { 1.0, -1.0 }, { 1.0, 1.0 }, { -1.0, 1.0 } });
+    c.setPosition ({ 10.0, 10.0 });
+    object->setCollision (c);
+    first->attachObject (object);
+
+    REQUIRE (object->getSector () == first);
+
+    // Free path found by broadphase is the same as sweep against every
+    // object, and blocked object never overlaps any of them
+    size_t blocked (0);
+    for (size_t i = 0; i < 2000; ++i)
+    {
+        Vector2f vector (step (gen), step (gen));
+        Vector2f position (object->getPosition ());
+        if (position.x + vector.x < 3.0f || position.x + vector.x > 97.0f ||
+            position.y + vector.y < 3.0f || position.y + vector.y > 97.0f)
+            continue;
+
+        bool expected (true);
+        for (const auto& prop : props)
+        {
+            float time;
+            Vector2f normal;
+            if (object->getCollision ().sweep (prop->getCollision (), vector, time, normal))
+                expected = false;
+        }
+
+        object->move (vector);
+
+        if (expected)
+        {
+            REQUIRE (object->getPosition ().x == Approx (position.x + vector.x));
+            REQUIRE (object->getPosition ().y == Approx (position.y + vector.y));
+        }
+        else
+        {
+            ++blocked;
+        }
+
+        for (const auto& prop : props)
+            REQUIRE (prop->getCollision ().check (object->getCollision ()) == Collision::State::OUTSIDE);
+    }
+
+    REQUIRE (blocked > 0);
+
+    // Sector keeps moved object alive while it passes to another sector
+    std::weak_ptr<InteractiveObject> weak (object);
+    object->setPosition ({ 97.0f, 10.0f });
+    first->updateObject (object.get ());
+    InteractiveObject* raw (object.get ());
+    object.reset ();
+
+    raw->move ({ 5.0f, 0.0f });
+    REQUIRE_FALSE (weak.expired ());
+    REQUIRE (raw->getSector () == second);
+    REQUIRE (raw->getPosition ().x == Approx (102.0f));
+
+    raw->move ({ 5.0f, 0.0f });
+    REQUIRE (raw->getPosition ().x == Approx (107.0f));
+
+    second->removeObject (raw);
+    REQUIRE (weak.expired ());
+}
+
+TEST_CASE ("Test collision distance and raycast")
+{
+    Collision c;
+    c.setPoints ({ { 0.0, 0.0 }, { 4.0, 0.0 }, { 4.0, 4.0 }, { 0.0, 4.0 } });
+    c.setPosition ({ 10.0, 10.0 });
+
+    REQUIRE (c.getDistance ({ 12.0, 12.0 }) == 0.0f);
+    REQUIRE (c.getDistance ({ 17.0, 12.0 }) == Approx (3.0f));
+    REQUIRE (c.getDistance ({ 17.0, 18.0 }) == Approx (5.0f));
+
+    float fraction;
+    REQUIRE (c.raycast ({ 0.0, 12.0 }, { 20.0, 12.0 }, fraction));
+    REQUIRE (fraction == Approx (0.5f));
+    REQUIRE (c.raycast ({ 12.0, 12.0 }, { 20.0, 12.0 }, fraction));
+    REQUIRE (fraction == 0.0f);
+    REQUIRE_FALSE (c.raycast ({ 0.0, 15.0 }, { 20.0, 15.0 }, fraction));
+    REQUIRE_FALSE (c.raycast ({ 0.0, 12.0 }, { 9.0, 12.0 }, fraction));
+}
+
+TEST_CASE ("Test object tree queries")
+{
+    std::unordered_map<uint32_t, MapSectorDesc> sectors;
+    sectors[0].size = { 100, 100 };
+    sectors[0].sector = std::make_unique<MapSector> (Vector2u (100, 100));
+    sectors[1].pos = { 100, 0 };
+    sectors[1].size = { 100, 100 };
+    sectors[1].sector = std::make_unique<MapSector> (Vector2u (100, 100));
+    MapSector* first (sectors[0].sector.get ());
+    MapSector* second (sectors[1].sector.get ());
+
+    // Objects attached before description is set are added to the tree too
+    std::shared_ptr<MapObject> early (new StaticObject ());
+    Collision square;
+    square.setPoints ({ { 0.0, 0.0 }, { 2.0, 0.0 }, { 2.0, 2.0 }, { 0.0, 2.0 } });
+    square.setPosition ({ 50.0, 50.0 });
+    early->setCollision (square);
+    first->attachObject (early);
+
+    MapManager map;
+    map.setMapDescription (std::move (sectors));
+
+    std::mt19937 gen (11);
+    std::uniform_real_distribution<float> place (5.0f, 190.0f);
+    std::uniform_real_distribution<float> size (0.5f, 4.0f);
+    std::uniform_real_distribution<float> step (-2.0f, 2.0f);
+
+    std::vector<std::shared_ptr<MapObject>> objects { early };
+    std::vector<std::shared_ptr<InteractiveObject>> movers;
+    for (size_t i = 0; i < 300; ++i)
+    {
+        Collision c;
+        float side (size (gen));
+        c.setPoints ({ { 0.0, 0.0 }, { side, 0.0 }, { side / 2, side } });
+        c.setPosition ({ place (gen), std::min (place (gen), 95.0f) });
+
+        std::shared_ptr<MapObject> object;
+        if (i % 4 == 0)
+        {
+            std::shared_ptr<InteractiveObject> mover (new InteractiveObject ());
+            movers.push_back (mover);
+            object = mover;
+        }
+        else
+        {
+            object.reset (new StaticObject ());
+        }
+
+        object->setCollision (c);
+        (c.getPosition ().x < 100.0f ? first : second)->attachObject (object);
+        objects.push_back (object);
+    }
+
+    auto sorted = [](std::vector<MapObject*> objects)
+    {
+        std::sort (objects.begin (), objects.end ());
+        return objects;
+    };
+
+    // Every query is compared with check of all objects
+    auto check_queries = [&]()
+    {
+        for (size_t i = 0; i < 50; ++i)
+        {
+            FloatRect rect (place (gen), place (gen) / 2, size (gen) * 5, size (gen) * 5);
+            std::vector<MapObject*> expected;
+            for (const auto& object : objects)
+            {
+                if (object->getBounds ().intersects (rect))
+                    expected.push_back (object.get ());
+            }
+            REQUIRE (sorted (map.queryRect (rect)) == sorted (expected));
+
+            Vector2f center (place (gen), place (gen) / 2);
+            float radius (size (gen) * 3);
+            expected.clear ();
+            for (const auto& object : objects)
+            {
+                if (object->getCollision ().getDistance (center) <= radius)
+                    expected.push_back (object.get ());
+            }
+            REQUIRE (sorted (map.queryRadius (center, radius)) == sorted (expected));
+
+            Vector2f p1 (place (gen), place (gen) / 2);
+            Vector2f p2 (place (gen), place (gen) / 2);
+            MapObject* closest (nullptr);
+            float min_fraction (2.0f);
+            for (const auto& object : objects)
+            {
+                float fraction;
+                if (object->getCollision ().raycast (p1, p2, fraction) && fraction < min_fraction)
+                {
+                    min_fraction = fraction;
+                    closest = object.get ();
+                }
+            }
+
+            Vector2f hit;
+            MapObject* found (map.raycast (p1, p2, hit));
+            REQUIRE (found == closest);
+            if (closest)
+            {
+                REQUIRE (hit.x == Approx (p1.x + (p2.x - p1.x) * min_fraction));
+                REQUIRE (hit.y == Approx (p1.y + (p2.y - p1.y) * min_fraction));
+            }
+        }
+    };
+
+    check_queries ();
+
+    for (size_t i = 0; i < 20; ++i)
+    {
+        for (const auto& mover : movers)
+        {
+            Vector2f position (mover->getPosition ());
+            Vector2f vector (step (gen), step (gen));
+            if (position.x + vector.x > 3.0f && position.x + vector.x < 195.0f &&
+                position.y + vector.y > 3.0f && position.y + vector.y < 95.0f)
+                mover->move (vector);
+        }
+    }
+
+    check_queries ();
+
+    for (size_t i = 0; i < 100; ++i)
+    {
+        objects.back ()->getSector ()->removeObject (objects.back ().get ());
+        objects.pop_back ();
+    }
+
+    check_queries ();
+}
+
+TEST_CASE ("Test swept movement")
+{
+    std::unordered_map<uint32_t, MapSectorDesc> sectors;
+    sectors[0].size = { 100, 100 };
+    sectors[0].sector = std::make_unique<MapSector> (Vector2u (100, 100));
+    MapSector* sector (sectors[0].sector.get ());
+
+    MapManager map;
+    map.setMapDescription (std::move (sectors));
+
+    // Thin wall from (50, 10) to (50.2, 90)
+    std::shared_ptr<MapObject> wall (new StaticObject ());
+    Collision c;
+    c.setPoints ({ { 0.0, 0.0 }, { 0.2f, 0.0 }, { 0.2f, 80.0 }, { 0.0, 80.0 } });
+    c.setPosition ({ 50.0, 10.0 });
+    wall->setCollision (c);
+    sector->attachObject (wall);
+
+    std::shared_ptr<InteractiveObject> object (new InteractiveObject ());
+    c.setPoints ({ { -1.0, -1.0 }, { 1.0, -1.0 }, { 1.0, 1.0 }, { -1.0, 1.0 } });
+    c.setPosition ({ 40.0, 50.0 });
+    object->setCollision (c);
+    sector->attachObject (object);
+
+    float time;
+    Vector2f normal;
+    REQUIRE (object->getCollision ().sweep (wall->getCollision (), { 20.0, 0.0 }, time, normal));
+    REQUIRE (time == Approx (9.0f / 20.0f).margin (1e-3));
+    REQUIRE (normal.x == Approx (-1.0f));
+    REQUIRE (normal.y == Approx (0.0f).margin (1e-6));
+    REQUIRE_FALSE (object->getCollision ().sweep (wall->getCollision (), { -20.0, 0.0 }, time, normal));
+    REQUIRE_FALSE (object->getCollision ().sweep (wall->getCollision (), { 8.0, 0.0 }, time, normal));
+
+    // Fast object stops before thin wall instead of passing through it
+    object->move ({ 20.0, 0.0 });
+    REQUIRE (object->getPosition ().x == Approx (49.0f).margin (1e-2));
+    REQUIRE (object->getPosition ().x < 49.0f);
+    REQUIRE (wall->getCollision ().check (object->getCollision ()) == Collision::State::OUTSIDE);
+
+    // The rest of diagonal movement slides along wall
+    object->move ({ 5.0, 5.0 });
+    REQUIRE (object->getPosition ().x == Approx (49.0f).margin (1e-2));
+    REQUIRE (object->getPosition ().y == Approx (55.0f));
+
+    object->move ({ 0.0, -10.0 });
+    REQUIRE (object->getPosition ().y == Approx (45.0f));
+
+    // Object slides past the end of wall and passes it after that
+    object->move ({ 5.0, 47.0 });
+    REQUIRE (object->getPosition ().x == Approx (49.0f).margin (1e-2));
+    REQUIRE (object->getPosition ().y == Approx (92.0f));
+
+    object->move ({ 10.0, 0.0 });
+    REQUIRE (object->getPosition ().x == Approx (59.0f).margin (1e-2));
+
+    // Object which touches wall can leave it
+    object->move ({ -8.0, -40.0 });
+    object->move ({ 10.0, 0.0 });
+    REQUIRE (object->getPosition ().x > 51.0f);
+    REQUIRE (wall->getCollision ().check (object->getCollision ()) == Collision::State::OUTSIDE);
+}
+
+TEST_CASE ("Test parallel movement step")
+{
+    auto simulate = [](std::vector<Vector2f>& positions, size_t& pending)
+    {
+        std::unordered_map<uint32_t, MapSectorDesc> sectors;
+        sectors[0].size = { 100, 100 };
+        sectors[0].sector = std::make_unique<MapSector> (Vector2u (100, 100));
+        sectors[1].pos = { 100, 0 };
+        sectors[1].size = { 100, 100 };
+        sectors[1].sector = std::make_unique<MapSector> (Vector2u (100, 100));
+        MapSector* first (sectors[0].sector.get ());
+        MapSector* second (sectors[1].sector.get ());
+
+        MapManager map;
+        map.setMapDescription (std::move (sectors));
+
+        std::mt19937 gen (5);
+        std::uniform_real_distribution<float> step (-1.5f, 1.5f);
+
+        // Grid of actors with space between them
+        std::vector<std::shared_ptr<InteractiveObject>> actors;
+        for (size_t i = 0; i < 40; ++i)
+        {
+            for (size_t j = 0; j < 20; ++j)
+            {
+                std::shared_ptr<InteractiveObject> actor (new InteractiveObject ());
+                Collision c;
+                c.setPoints ({ { -1.0, -1.0 }, { 1.0, -1.0 }, { 0.0, 1.0 } });
+                c.setPosition ({ 5.0f + i * 4.75f, 5.0f + j * 4.5f });
+                actor->setCollision (c);
+                (c.getPosition ().x < 100.0f ? first : second)->attachObject (actor);
+                actors.push_back (actor);
+            }
+        }
+
+        for (size_t tick = 0; tick < 5; ++tick)
+        {
+            for (const auto& actor : actors)
+            {
+                Vector2f position (actor->getPosition ());
+                Vector2f vector (step (gen), step (gen));
+                if (position.x + vector.x > 3.0f && position.x + vector.x < 197.0f &&
+                    position.y + vector.y > 3.0f && position.y + vector.y < 97.0f)
+                    map.requestMove (actor.get (), vector);
+            }
+
+            map.step ();
+            REQUIRE (map.getPendingMoves () == 0);
+
+            size_t overlaps (0);
+            for (size_t i = 0; i < actors.size (); ++i)
+            {
+                for (size_t j = i + 1; j < actors.size (); ++j)
+                {
+                    if (actors[i]->detectCollision (actors[j].get ()) != Collision::State::OUTSIDE ||
+                        actors[j]->detectCollision (actors[i].get ()) != Collision::State::OUTSIDE)
+                        ++overlaps;
+                }
+            }
+            REQUIRE (overlaps == 0);
+        }
+
+        // Request of removed object is dropped
+        map.requestMove (actors[0].get (), { 1.0, 0.0 });
+        map.requestMove (actors[1].get (), { 0.5, 0.0 });
+        map.requestMove (actors[1].get (), { 0.5, 0.0 });
+        pending = map.getPendingMoves ();
+        actors[0]->getSector ()->removeObject (actors[0].get ());
+        map.step ();
+
+        for (const auto& actor : actors)
+            positions.push_back (actor->getPosition ());
+    };
+
+    std::vector<Vector2f> positions;
+    std::vector<Vector2f> repeated;
+    size_t pending;
+    simulate (positions, pending);
+    simulate (repeated, pending);
+
+    REQUIRE (pending == 2);
+    REQUIRE (positions.size () == repeated.size ());
+    for (size_t i = 0; i < positions.size (); ++i)
+    {
+        REQUIRE (positions[i].x == repeated[i].x);
+        REQUIRE (positions[i].y == repeated[i].y);
+    }
+}
@@ -27,10 +27,15 @@
 /////////////////////////////////////////////////////////////////////
 
 
+#include <SFRPG/InteractiveObject.h>
 #include <SFRPG/MapManager.h>
 #include <SFRPG/MapSector.h>
 #include <SFRPG/MapLoader.h>
 #include <SFRPG/MapSaver.h>
+#include <SFRPG/SectorFormat.h>
+#include <SFRPG/SectorIndex.h>
+#include <SFRPG/StaticObject.h>
+#include <SFRPG/Way.h>
 
 #include <SFGE/ResourceManager.h>
 #include <SFGE/MemoryInputStream.h>
@@ -38,6 +43,8 @@
 
 #include <catch.hpp>
 
+#include <algorithm>
+
 
 using namespace sfge;
 
@@ -105,3 +112,568 @@ TEST_CASE ("Test saving and loading map")
 
     REQUIRE (sector1 == sector2);
 }
+
+TEST_CASE ("Test streaming of sectors")
+{
+    std::unordered_map<std::string, std::vector<char>> files;
+    files["stream.resm"] = append_literal (
+        "Map\n{\nname=\"stream\"\n"
+        "Sector 0\n{\npath=\"s0.ress\"\nx=0\ny=0\nwidth=50\nheight=50\n}\n"
+        "Sector 1\n{\npath=\"s1.ress\"\nx=50\ny=0\nwidth=50\nheight=50\n}\n"
+        "Sector 2\n{\npath=\"s2.ress\"\nx=100\ny=0\nwidth=50\nheight=50\n}\n"
+        "Sector 3\n{\npath=\"missing.ress\"\nx=0\ny=50\nwidth=50\nheight=50\n}\n"
+        "}\n"
+    );
+    files["s0.ress"] = append_literal ("Sector\n{\nname=\"first\"\n}\n");
+    files["s1.ress"] = append_literal ("Sector\n{\nname=\"second\"\n}\n");
+    files["s2.ress"] = append_literal ("Sector\n{\nname=\"third\"\n}\n");
+
+    MemoryInputStream stream (std::move (files));
+    MapLoader loader (&stream);
+
+    MapManager map;
+    REQUIRE (loader.loadMap (&map, "stream.resm"));
+    map.setStreaming (true);
+    map.setPrefetchTime (2.0f);
+
+    // Sector 1 is ahead of movement, sector 2 is too far
+    map.lookMap ({ UintRect (0, 0, 10, 10) }, { 30.0f, 0.0f });
+    REQUIRE (map.getStreamedSectors () == 2);
+
+    // Requested sector isn't requested twice
+    map.lookMap ({ UintRect (0, 0, 10, 10) });
+    REQUIRE (map.getStreamedSectors () == 2);
+
+    REQUIRE (map.update (true) == 2);
+    REQUIRE (map.getStreamedSectors () == 0);
+
+    MapSector* first (map.getSector ({ 0.0f, 0.0f }));
+    REQUIRE (first);
+    REQUIRE (first->getName () == "first");
+    REQUIRE (first->getOffset ().x == Approx (-5.0f));
+
+    MapSector* second (map.getSector ({ 50.0f, 0.0f }));
+    REQUIRE (second);
+    REQUIRE (second->getName () == "second");
+    REQUIRE (map.getSector ({ 100.0f, 0.0f }) == nullptr);
+
+    // Sector which can't be read is dropped and may be requested again
+    map.lookMap ({ UintRect (0, 40, 10, 20) });
+    REQUIRE (map.update (true) == 0);
+    REQUIRE (map.getStreamedSectors () == 0);
+
+    // Synchronous loading gives the same result
+    map.setStreaming (false);
+    map.lookMap ({ UintRect (90, 0, 30, 10) });
+    REQUIRE (map.getStreamedSectors () == 0);
+    MapSector* third (map.getSector ({ 45.0f, 0.0f }));
+    REQUIRE (third);
+    REQUIRE (third->getName () == "third");
+}
+
+TEST_CASE ("Test eviction of sectors")
+{
+    std::unordered_map<uint32_t, MapSectorDesc> sectors;
+
+    for (uint32_t i = 0; i < 3; ++i)
+    {
+        std::vector<WayPoint> way_points (3, WayPoint ());
+
+        for (auto& point : way_points)
+            point.setRadius (8.0);
+
+        way_points[0].setPosition ({ 5.0, 50.0 });
+        way_points[1].setPosition ({ 50.0, 50.0 });
+        way_points[2].setPosition ({ 95.0, 50.0 });
+
+        sectors[i].pos = { i * 100, 0 };
+        sectors[i].size = { 100, 100 };
+        sectors[i].sector = std::make_unique<MapSector> (Vector2u (100, 100));
+        sectors[i].sector->setWayPoints (way_points);
+        REQUIRE (sectors[i].sector->isModified ());
+        sectors[i].sector->setModified (false);
+    }
+
+    // Last sector has no file to be loaded from again
+    sectors[0].path = "first.ress";
+    sectors[1].path = "second.ress";
+
+    MapManager map;
+    map.setMapDescription (std::move (sectors));
+
+    MapSector* first (map.getSector ({ 50.0f, 50.0f }));
+    MapSector* second (map.getSector ({ 150.0f, 50.0f }));
+    MapSector* third (map.getSector ({ 250.0f, 50.0f }));
+    REQUIRE (first);
+    REQUIRE (second);
+    REQUIRE (third);
+    REQUIRE (map.getResidentSectors () == 3);
+
+    const WayPoint* border_point (second->getWayPoint (0));
+    size_t border_edges (border_point->getEdges ().size ());
+    size_t first_edges (0);
+    for (uint32_t i = 0; i < first->getWayPointsCount (); ++i)
+    {
+        if (border_point->hasEdge (first->getWayPoint (i)))
+            ++first_edges;
+    }
+    REQUIRE (first_edges > 0);
+    size_t budget (second->getMemoryUsage () + third->getMemoryUsage ());
+    REQUIRE (map.getResidentBytes () > budget);
+
+    // Sector which isn't looked at is unloaded with edges to it
+    map.lookMap ({ UintRect (150, 0, 100, 10) });
+    REQUIRE (map.getResidentSectors () == 3);
+    map.setMemoryBudget (budget);
+    REQUIRE (map.getResidentSectors () == 2);
+    REQUIRE (map.getEvictedSectors () == 1);
+    REQUIRE (map.getResidentBytes () <= budget);
+    REQUIRE (border_point->getEdges ().size () == border_edges - first_edges);
+
+    Vector2f offset (second->getOffset () - Vector2f (100.0f, 0.0f));
+    REQUIRE (map.getSector (offset + Vector2f (50.0f, 50.0f)) == nullptr);
+    REQUIRE (map.getWay (offset + Vector2f (151.0f, 50.0f), offset + Vector2f (250.0f, 52.0f)).getPoints () > 0);
+    REQUIRE (map.getWay (offset + Vector2f (151.0f, 50.0f), offset + Vector2f (50.0f, 50.0f)).isEmpty ());
+
+    // Changed sector and sector without path aren't lost without saver
+    second->setModified (true);
+    map.lookMap ({ UintRect (0, 0, 10, 10) });
+    map.setMemoryBudget (1);
+    REQUIRE (map.getResidentSectors () == 2);
+    REQUIRE (map.getEvictedSectors () == 1);
+    REQUIRE (map.getSavedSectors () == 0);
+
+    // Sector with interactive object isn't unloaded, objects held by
+    // game don't point to unloaded sector
+    Collision c;
+    c.setPoints ({ { 0.0, 0.0 }, { 4.0, 0.0 }, { 4.0, 4.0 }, { 0.0, 4.0 } });
+
+    std::shared_ptr<InteractiveObject> actor (new InteractiveObject ());
+    c.setPosition (third->getOffset () + Vector2f (50.0f, 80.0f));
+    actor->setCollision (c);
+    third->attachObject (actor);
+
+    std::shared_ptr<MapObject> obstacle (new StaticObject ());
+    c.setPosition (second->getOffset () + Vector2f (50.0f, 80.0f));
+    obstacle->setCollision (c);
+    second->attachObject (obstacle);
+    REQUIRE (obstacle->getSector () == second);
+
+    MemoryOutputStream stream;
+    map.setSaver (std::make_unique<MapSaver> (&stream));
+    map.setMemoryBudget (1);
+    REQUIRE (map.getResidentSectors () == 1);
+    REQUIRE (map.getEvictedSectors () == 2);
+    REQUIRE (map.getSavedSectors () == 1);
+    REQUIRE (actor->getSector () == third);
+    REQUIRE (obstacle->getSector () == nullptr);
+
+    actor->move ({ 1.0f, 1.0f });
+    REQUIRE (actor->getSector () == third);
+
+    third->removeObject (actor.get ());
+    map.setMemoryBudget (1);
+    REQUIRE (map.getResidentSectors () == 0);
+    REQUIRE (map.getResidentBytes () == 0);
+    REQUIRE (map.getEvictedSectors () == 3);
+    REQUIRE (map.getSavedSectors () == 2);
+    REQUIRE (!stream.getMemory ("second.ress").empty ());
+    REQUIRE (!stream.getMemory ("sector-2.ress").empty ());
+    REQUIRE (stream.getMemory ("first.ress").empty ());
+}
+
+TEST_CASE ("Test reloading of evicted sector")
+{
+    std::unordered_map<std::string, std::vector<char>> files;
+    files["evict.resm"] = append_literal (
+        "Map\n{\nname=\"evict\"\n"
+        "Sector 0\n{\npath=\"s0.ress\"\nx=0\ny=0\nwidth=50\nheight=50\n}\n"
+        "Sector 1\n{\npath=\"s1.ress\"\nx=50\ny=0\nwidth=50\nheight=50\n}\n"
+        "}\n"
+    );
+    files["s0.ress"] = append_literal ("Sector\n{\nname=\"first\"\n}\n");
+    files["s1.ress"] = append_literal (
+        "Sector\n{\nname=\"second\"\ntile_size=32\n"
+        "WayPoint\n{\nx=10\ny=25\nradius=8\n}\n"
+        "WayPoint\n{\nx=40\ny=25\nradius=6\n}\n"
+        "Object\n{\nx=20\ny=5\n"
+        "Point\n{\nx=0\ny=0\n}\nPoint\n{\nx=10\ny=0\n}\nPoint\n{\nx=10\ny=10\n}\n"
+        "}\n"
+        "}\n"
+    );
+
+    MemoryOutputStream output;
+    MemoryInputStream stream (files);
+    MapLoader loader (&stream);
+
+    {
+        MapManager map;
+        REQUIRE (loader.loadMap (&map, "evict.resm"));
+        map.lookMap ({ UintRect (0, 0, 100, 50) });
+        REQUIRE (map.getResidentSectors () == 2);
+
+        MapSector* second (map.getSector (Vector2f (75.0f, 25.0f) - Vector2f (50.0f, 25.0f)));
+        REQUIRE (second);
+        REQUIRE (second->getName () == "second");
+        Vector2f offset (second->getOffset ());
+        REQUIRE (offset != Vector2f ());
+
+        std::shared_ptr<MapObject> object (new StaticObject ());
+        Collision c;
+        c.setPoints ({ { 0.0, 0.0 }, { 5.0, 0.0 }, { 5.0, 5.0 }, { 0.0, 5.0 } });
+        c.setPosition (Vector2f (30.0f, 35.0f) + offset);
+        object->setCollision (c);
+        second->attachObject (object);
+
+        // Sector is saved to its own file, positions are kept relative to it
+        map.setSaver (std::make_unique<MapSaver> (&output));
+        map.lookMap ({ UintRect (0, 0, 10, 10) });
+        map.setMemoryBudget (1);
+        REQUIRE (map.getResidentSectors () == 1);
+        REQUIRE (map.getSavedSectors () == 1);
+    }
+
+    std::vector<char> saved (output.getMemory ("s1.ress"));
+    REQUIRE (!saved.empty ());
+    saved.push_back ('\0');
+
+    SectorData data;
+    REQUIRE (SectorFormat::readText (saved.data (), Vector2u (50, 50), data));
+    REQUIRE (data.name == "second");
+    REQUIRE (data.tile_size == 32);
+    REQUIRE (data.way_points.size () == 2);
+    REQUIRE (data.objects.size () == 2);
+
+    files["s1.ress"] = saved;
+    MemoryInputStream reloaded_stream (files);
+    MapLoader reloaded_loader (&reloaded_stream);
+
+    MapManager map;
+    REQUIRE (reloaded_loader.loadMap (&map, "evict.resm"));
+    map.lookMap ({ UintRect (50, 0, 50, 50) });
+
+    MapSector* second (map.getSector (Vector2f (75.0f, 25.0f) - Vector2f (50.0f, 25.0f)));
+    REQUIRE (second);
+    REQUIRE (second->getName () == "second");
+    REQUIRE (second->getTileSize () == 32);
+    REQUIRE_FALSE (second->isModified ());
+
+    Vector2f offset (second->getOffset ());
+    REQUIRE (second->getWayPointsCount () == 2);
+    REQUIRE (second->getWayPoint (0)->getPosition () - offset == Vector2f (10.0f, 25.0f));
+    REQUIRE (second->getWayPoint (0)->getRadius () == Approx (8.0f));
+    REQUIRE (second->getWayPoint (1)->getPosition () - offset == Vector2f (40.0f, 25.0f));
+    REQUIRE (second->getWayPoint (1)->getRadius () == Approx (6.0f));
+
+    std::vector<MapObject*> objects (map.queryRect (FloatRect (offset.x, offset.y, 50.0f, 50.0f)));
+    REQUIRE (objects.size () == 2);
+
+    std::vector<Vector2f> positions;
+    for (const MapObject* obj : objects)
+        positions.push_back (obj->getCollision ().getPosition () - offset);
+    std::sort (positions.begin (), positions.end (), [](Vector2f p1, Vector2f p2) { return p1.x < p2.x; });
+
+    REQUIRE (positions[0] == Vector2f (20.0f, 5.0f));
+    REQUIRE (positions[1] == Vector2f (30.0f, 35.0f));
+    REQUIRE_FALSE (second->checkPass (Vector2f (15.0f, 8.0f) + offset, Vector2f (35.0f, 8.0f) + offset));
+    REQUIRE_FALSE (second->checkPass (Vector2f (25.0f, 37.0f) + offset, Vector2f (40.0f, 37.0f) + offset));
+}
+
+TEST_CASE ("Test binary sector format")
+{
+    SectorData sector;
+    sector.name = "binary";
+    sector.size = { 4, 3 };
+    sector.tile_size = 32;
+    sector.palette.push_back ("tile.grass");
+    sector.palette.push_back ("tile.sand");
+    sector.tiles = { 1, 1, 2, 0, 0, 2, 2, 1, 1, 0, 0, 2 };
+
+    sector.way_points.resize (2);
+    sector.way_points[0].setPosition ({ 0.5f, 0.5f });
+    sector.way_points[0].setRadius (0.5f);
+    sector.way_points[1].setPosition ({ 3.25f, 2.5f });
+    sector.way_points[1].setRadius (0.75f);
+
+    sector.objects.emplace_back (Circuit { { 0.0f, 0.0f }, { 1.0f, 0.0f }, { 1.0f, 1.0f }, { 0.0f, 1.0f } });
+    sector.objects.back ().setPosition ({ 1.5f, 1.0f });
+
+    MemoryOutputStream stream;
+    REQUIRE (stream.open ("binary.ress"));
+    REQUIRE (SectorFormat::writeBinary (&stream, sector));
+    REQUIRE (stream.open ("text.ress"));
+    REQUIRE (SectorFormat::writeText (&stream, sector));
+
+    std::vector<char> binary_file (stream.getMemory ("binary.ress"));
+    std::vector<char> text_file (stream.getMemory ("text.ress"));
+    REQUIRE (SectorFormat::isBinary (binary_file.data (), binary_file.size ()));
+    REQUIRE (!SectorFormat::isBinary (text_file.data (), text_file.size ()));
+
+    BinarySector binary;
+    REQUIRE (binary.open (binary_file.data (), binary_file.size ()));
+    REQUIRE (std::string (binary.getName ()) == "binary");
+    REQUIRE (binary.getSize () == sector.size);
+    REQUIRE (binary.getTileSize () == 32);
+    REQUIRE (binary.getPaletteSize () == 3);
+    REQUIRE (std::string (binary.getTexture (2)) == "tile.sand");
+    REQUIRE (std::equal (sector.tiles.begin (), sector.tiles.end (), binary.getTiles ()));
+    REQUIRE (binary.getWayPointsCount () == 2);
+    REQUIRE (binary.getWayPoint (1).getPosition () == sector.way_points[1].getPosition ());
+    REQUIRE (binary.getObjectsCount () == 1);
+    REQUIRE (binary.getObject (0).getPoints () == sector.objects[0].getPoints ());
+    REQUIRE (binary.getObject (0).getPosition () == sector.objects[0].getPosition ());
+
+    // Truncated file is rejected
+    REQUIRE (!binary.open (binary_file.data (), binary_file.size () - 4));
+
+    // Text keeps the same content, size is found by tiles
+    text_file.push_back ('\0');
+    SectorData text;
+    REQUIRE (SectorFormat::readText (text_file.data (), Vector2u (), text));
+    REQUIRE (text.name == sector.name);
+    REQUIRE (text.size == sector.size);
+    REQUIRE (text.tile_size == sector.tile_size);
+    REQUIRE (text.palette == sector.palette);
+    REQUIRE (text.tiles == sector.tiles);
+    REQUIRE (text.way_points.size () == 2);
+    REQUIRE (text.way_points[1].getPosition ().x == Approx (3.25f));
+    REQUIRE (text.way_points[1].getRadius () == Approx (0.75f));
+    REQUIRE (text.objects.size () == 1);
+    REQUIRE (text.objects[0].getPoints () == sector.objects[0].getPoints ());
+    REQUIRE (text.objects[0].getPosition () == sector.objects[0].getPosition ());
+
+    // Map may mix sectors of both formats
+    std::unordered_map<std::string, std::vector<char>> files;
+    files["mixed.resm"] = append_literal (
+        "Map\n{\nname=\"mixed\"\n"
+        "Sector 0\n{\npath=\"text.ress\"\nx=0\ny=0\nwidth=4\nheight=3\n}\n"
+        "Sector 1\n{\npath=\"binary.ress\"\nx=4\ny=0\nwidth=4\nheight=3\n}\n"
+        "}\n"
+    );
+    files["text.ress"] = text_file;
+    files["binary.ress"] = binary_file;
+
+    MemoryInputStream input (std::move (files));
+    MapLoader loader (&input);
+
+    MapManager map;
+    REQUIRE (loader.loadMap (&map, "mixed.resm"));
+    map.lookMap ({ UintRect (0, 0, 8, 3) });
+    REQUIRE (map.getResidentSectors () == 2);
+
+    for (float x : { 0.5f, 4.5f })
+    {
+        MapSector* loaded (map.getSector (Vector2f (x - 4.0f, 0.5f - 1.0f)));
+        REQUIRE (loaded);
+        REQUIRE (loaded->getName () == "binary");
+        REQUIRE (loaded->getTileSize () == 32);
+        REQUIRE (loaded->getWayPointsCount () == 2);
+        REQUIRE (!loaded->isModified ());
+    }
+
+    REQUIRE (map.queryRect (FloatRect (-4.0f, -1.0f, 8.0f, 3.0f)).size () == 2);
+
+    // Single binary sector may be loaded as map
+    MapManager single;
+    REQUIRE (loader.loadMap (&single, "binary.ress"));
+    REQUIRE (single.getName () == "binary");
+    single.lookMap ({ UintRect (0, 0, 4, 3) });
+    REQUIRE (single.getResidentSectors () == 1);
+}
+
+TEST_CASE ("Test sector index")
+{
+    std::unordered_map<uint32_t, MapSectorDesc> sectors;
+
+    // Grid of sectors with a few holes and one large sector over the right part
+    for (uint32_t y = 0; y < 10; ++y)
+    {
+        for (uint32_t x = 0; x < 10; ++x)
+        {
+            if ((x + y * 10) % 7 == 3)
+                continue;
+
+            sectors[x + y * 10].pos = { x * 50, y * 50 };
+            sectors[x + y * 10].size = { 50, 50 };
+        }
+    }
+    sectors[100].pos = { 500, 0 };
+    sectors[100].size = { 300, 500 };
+
+    auto overlaps ([](const MapSectorDesc& desc, uint64_t left, uint64_t top, uint64_t right, uint64_t bottom)
+    {
+        return left < uint64_t (desc.pos.x) + desc.size.x && top < uint64_t (desc.pos.y) + desc.size.y && right > desc.pos.x && bottom > desc.pos.y;
+    });
+
+    auto touches ([](const MapSectorDesc& desc, uint64_t left, uint64_t top, uint64_t right, uint64_t bottom)
+    {
+        return left <= uint64_t (desc.pos.x) + desc.size.x && top <= uint64_t (desc.pos.y) + desc.size.y && right >= desc.pos.x && bottom >= desc.pos.y;
+    });
+
+    SectorIndex index;
+    index.build (sectors);
+    REQUIRE (index.getCellSize () > 50);
+
+    std::vector<uint32_t> ids;
+    std::vector<uint32_t> expected;
+
+    for (uint32_t left = 0; left < 900; left += 37)
+    {
+        for (uint32_t top = 0; top < 600; top += 41)
+        {
+            UintRect area (left, top, 60, 25);
+
+            expected.clear ();
+            for (const auto& sector : sectors)
+            {
+                if (overlaps (sector.second, area.left, area.top, area.left + area.width, area.top + area.height))
+                    expected.push_back (sector.first);
+            }
+            std::sort (expected.begin (), expected.end ());
+
+            index.queryRect (area, ids);
+            REQUIRE (ids == expected);
+
+            expected.clear ();
+            for (const auto& sector : sectors)
+            {
+                if (touches (sector.second, left, top, left, top))
+                    expected.push_back (sector.first);
+            }
+            std::sort (expected.begin (), expected.end ());
+
+            index.queryPoint (Vector2f (float (left), float (top)), ids);
+            REQUIRE (ids == expected);
+        }
+    }
+
+    for (const auto& sector : sectors)
+    {
+        const MapSectorDesc& desc (sector.second);
+
+        expected.clear ();
+        for (const auto& neighbour : sectors)
+        {
+            if (neighbour.first != sector.first &&
+                touches (neighbour.second, desc.pos.x, desc.pos.y, desc.pos.x + desc.size.x, desc.pos.y + desc.size.y))
+                expected.push_back (neighbour.first);
+        }
+        std::sort (expected.begin (), expected.end ());
+
+        index.queryNeighbours (sector.first, ids);
+        REQUIRE (ids == expected);
+    }
+
+    index.queryRect (FloatRect (-10.0f, -10.0f, 5.0f, 5.0f), ids);
+    REQUIRE (ids.empty ());
+    index.queryRect (FloatRect (-10.0f, -10.0f, 10.0f, 10.0f), ids);
+    REQUIRE (ids == std::vector<uint32_t> ({ 0 }));
+
+    // Manager finds loaded sectors through index
+    for (auto& sector : sectors)
+    {
+        if (sector.first % 2 == 0)
+            sector.second.sector = std::make_unique<MapSector> (Vector2u (sector.second.size));
+    }
+
+    MapManager map;
+    map.setMapDescription (std::move (sectors));
+
+    MapSector* origin (map.getSector ({ 25.0f, 25.0f }));
+    REQUIRE (origin);
+    Vector2f offset (origin->getOffset ());
+
+    REQUIRE (map.getSector (offset + Vector2f (75.0f, 25.0f)) == nullptr);
+    MapSector* large (map.getSector (offset + Vector2f (700.0f, 400.0f)));
+    REQUIRE (large);
+    REQUIRE (large->getOffset () == offset + Vector2f (500.0f, 0.0f));
+    REQUIRE (map.getSector (offset + Vector2f (900.0f, 400.0f)) == nullptr);
+}
+
+TEST_CASE ("Test loading block of sectors")
+{
+    std::unordered_map<std::string, std::vector<char>> files;
+
+    auto to_file ([](const std::string& text)
+    {
+        std::vector<char> file (text.begin (), text.end ());
+        file.push_back ('\0');
+        return file;
+    });
+
+    // Block of 5x5 sectors like at teleport, one of them can't be read
+    std::string map ("Map\n{\nname=\"block\"\n");
+    for (uint32_t y = 0; y < 5; ++y)
+    {
+        for (uint32_t x = 0; x < 5; ++x)
+        {
+            std::string id (std::to_string (x + y * 5));
+            std::string path (x == 4 && y == 0 ? "missing.ress" : "s" + id + ".ress");
+
+            map += "Sector " + id + "\n{\npath=\"" + path + "\"\nx=" + std::to_string (x * 50) + "\ny=" + std::to_string (y * 50) +
+                "\nwidth=50\nheight=50\n}\n";
+
+            files["s" + id + ".ress"] = to_file (
+                "Sector\n{\nname=\"s" + id + "\"\n"
+                "WayPoint\n{\nx=5\ny=25\nradius=8\n}\n"
+                "WayPoint\n{\nx=25\ny=25\nradius=8\n}\n"
+                "WayPoint\n{\nx=45\ny=25\nradius=8\n}\n"
+                "WayPoint\n{\nx=25\ny=5\nradius=8\n}\n"
+                "WayPoint\n{\nx=25\ny=45\nradius=8\n}\n"
+                "}\n"
+            );
+        }
+    }
+    map += "}\n";
+    files["block.resm"] = to_file (map);
+    files.erase ("s4.ress");
+
+    MemoryInputStream loaded_stream (files);
+    MapLoader loader (&loaded_stream);
+    MapManager loaded;
+    REQUIRE (loader.loadMap (&loaded, "block.resm"));
+
+    MemoryInputStream streamed_stream (std::move (files));
+    MapLoader stream_loader (&streamed_stream);
+    MapManager streamed;
+    REQUIRE (stream_loader.loadMap (&streamed, "block.resm"));
+    streamed.setStreaming (true);
+
+    loaded.lookMap ({ UintRect (0, 0, 250, 250) });
+    REQUIRE (loaded.getResidentSectors () == 24);
+    REQUIRE (loaded.getStreamedSectors () == 0);
+
+    streamed.lookMap ({ UintRect (0, 0, 250, 250) });
+    REQUIRE (streamed.update (true) == 24);
+
+    // Sectors are placed and connected like streamed ones
+    MapSector* origin (loaded.getSector ({ -100.0f, -100.0f }));
+    REQUIRE (origin);
+    REQUIRE (origin->getName () == "s0");
+    REQUIRE (origin->getOffset () == Vector2f (-125.0f, -125.0f));
+    REQUIRE (loaded.getSector ({ 100.0f, -100.0f }) == nullptr);
+
+    for (uint32_t y = 0; y < 5; ++y)
+    {
+        for (uint32_t x = 0; x < 5; ++x)
+        {
+            Vector2f position (x * 50.0f - 100.0f, y * 50.0f - 100.0f);
+            MapSector* sector (loaded.getSector (position));
+            MapSector* streamed_sector (streamed.getSector (position));
+            REQUIRE ((sector != nullptr) == (streamed_sector != nullptr));
+            if (!sector)
+                continue;
+
+            REQUIRE (sector->getName () == streamed_sector->getName ());
+            REQUIRE (sector->getOffset () == streamed_sector->getOffset ());
+            for (uint32_t i = 0; i < sector->getWayPointsCount (); ++i)
+                REQUIRE (sector->getWayPoint (i)->getEdges ().size () == streamed_sector->getWayPoint (i)->getEdges ().size ());
+        }
+    }
+
+    Way way (loaded.getWay ({ -100.0f, -100.0f }, { 100.0f, 100.0f }));
+    Way streamed_way (streamed.getWay ({ -100.0f, -100.0f }, { 100.0f, 100.0f }));
+    REQUIRE (!way.isEmpty ());
+    REQUIRE (way.getPoints () == streamed_way.getPoints ());
+    REQUIRE (way.getLength () == Approx (streamed_way.getLength ()));
+}
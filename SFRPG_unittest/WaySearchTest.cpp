@@ -31,9 +31,19 @@
 #include <SFRPG/MapSector.h>
 #include <SFRPG/Way.h>
 #include <SFRPG/StaticObject.h>
+#include <SFRPG/InteractiveObject.h>
+#include <SFRPG/PathCache.h>
+#include <SFRPG/PathRequest.h>
+#include <SFRPG/ReplanningPath.h>
+#include <SFRPG/JumpPointSearch.h>
+#include <SFRPG/WalkabilityGrid.h>
 
 #include <catch.hpp>
 
+#include <cfloat>
+#include <cmath>
+#include <queue>
+
 
 using namespace sfge;
 
@@ -103,4 +113,1192 @@ TEST_CASE ("Test way finding")
         position += way.getMovingVector (position, 1.0);
 
     REQUIRE (position == target);
-}
\ No newline at end of file
+}
+
+TEST_CASE ("Test way finding with equal estimations")
+{
+    std::unordered_map<uint32_t, MapSectorDesc> sectors;
+
+    std::vector<WayPoint> way_points (4, WayPoint ());
+
+    for (auto& point : way_points)
+        point.setRadius (8.0);
+
+    way_points[0].setPosition ({ 10.0, 50.0 });
+    way_points[1].setPosition ({ 50.0, 30.0 });
+    way_points[2].setPosition ({ 50.0, 70.0 });
+    way_points[3].setPosition ({ 90.0, 50.0 });
+
+    sectors[0].sector = std::make_unique<MapSector> (Vector2u (100, 100));
+    sectors[0].sector->setWayPoints (way_points);
+
+    std::shared_ptr<MapObject> obj (new StaticObject ());
+
+    Collision c;
+    c.setPoints ({ { 40.0, 40.0 }, { 60.0, 40.0 }, { 60.0, 60.0 }, { 40.0, 60.0 } });
+    obj->setCollision (c);
+
+    sectors[0].sector->attachObject (obj);
+
+    MapManager map;
+    map.setMapDescription (std::move (sectors));
+
+    MapSector* sector (map.getSector ({ 1.0, 1.0 }));
+    REQUIRE (sector);
+    REQUIRE (sector->getWayPoint (0)->getEdges ().size () == 2);
+    REQUIRE (sector->getWayPoint (1)->getEdges ().size () == 2);
+
+    Vector2f position (12.0, 50.0);
+    Vector2f target (88.0, 50.0);
+
+    Way way (map.getWay (position, target));
+
+    REQUIRE (way.getPoints () == 3);
+
+    for (size_t i = 0; i < 200; ++i)
+        position += way.getMovingVector (position, 1.0);
+
+    REQUIRE (position == target);
+}
+
+TEST_CASE ("Test hierarchical way finding")
+{
+    std::unordered_map<uint32_t, MapSectorDesc> sectors;
+
+    for (uint32_t i = 0; i < 3; ++i)
+    {
+        std::vector<WayPoint> way_points (3, WayPoint ());
+
+        for (auto& point : way_points)
+            point.setRadius (8.0);
+
+        way_points[0].setPosition ({ 5.0, 50.0 });
+        way_points[1].setPosition ({ 50.0, 50.0 });
+        way_points[2].setPosition ({ 95.0, 50.0 });
+
+        sectors[i].pos = { i * 100, 0 };
+        sectors[i].size = { 100, 100 };
+        sectors[i].sector = std::make_unique<MapSector> (Vector2u (100, 100));
+        sectors[i].sector->setWayPoints (way_points);
+    }
+
+    MapManager map;
+    map.setMapDescription (std::move (sectors));
+
+    MapSector* sector (map.getSector ({ 150.0, 50.0 }));
+    REQUIRE (sector);
+    REQUIRE (sector->getBorderWayPoints ().size () == 2);
+    REQUIRE (sector->getWayPoint (1)->getEdges ().size () == 2);
+
+    Vector2f departure (51.0, 50.0);
+    Vector2f target (250.0, 52.0);
+
+    Way flat_way (map.getWay (departure, target));
+
+    map.setHierarchicalSearch (true);
+    REQUIRE (map.isHierarchicalSearch ());
+
+    Way way (map.getWay (departure, target));
+
+    REQUIRE (way.getPoints () == flat_way.getPoints ());
+    REQUIRE (way.getLength () == Approx (flat_way.getLength ()));
+
+    Vector2f position (departure);
+    for (size_t i = 0; i < 300; ++i)
+        position += way.getMovingVector (position, 1.0);
+
+    REQUIRE (position.x == Approx (target.x));
+    REQUIRE (position.y == Approx (target.y));
+
+    // Ways follow sectors when map is centered on another area
+    for (bool hierarchical : { true, false })
+    {
+        map.setHierarchicalSearch (hierarchical);
+        map.lookMap ({ UintRect (hierarchical ? 140 : 40, 40, 20, 20) });
+
+        Vector2f shift (sector->getOffset () - Vector2f (100.0f, 0.0f));
+        REQUIRE (shift != Vector2f ());
+
+        Way moved_way (map.getWay (departure + shift, target + shift));
+        REQUIRE (moved_way.getPoints () == flat_way.getPoints ());
+        REQUIRE (moved_way.getLength () == Approx (flat_way.getLength ()));
+
+        position = departure + shift;
+        for (size_t i = 0; i < 300; ++i)
+            position += moved_way.getMovingVector (position, 1.0);
+
+        REQUIRE (position.x == Approx (target.x + shift.x));
+        REQUIRE (position.y == Approx (target.y + shift.y));
+    }
+}
+
+TEST_CASE ("Test way caching")
+{
+    std::unordered_map<uint32_t, MapSectorDesc> sectors;
+
+    std::vector<WayPoint> way_points (3, WayPoint ());
+
+    for (auto& point : way_points)
+        point.setRadius (8.0);
+
+    way_points[0].setPosition ({ 10.0, 10.0 });
+    way_points[1].setPosition ({ 50.0, 10.0 });
+    way_points[2].setPosition ({ 90.0, 10.0 });
+
+    sectors[0].size = { 100, 100 };
+    sectors[0].sector = std::make_unique<MapSector> (Vector2u (100, 100));
+    sectors[0].sector->setWayPoints (way_points);
+
+    MapManager map;
+    map.setMapDescription (std::move (sectors));
+
+    PathCache& cache (map.getPathCache ());
+    REQUIRE (cache.getSize () == 0);
+
+    Way way1 (map.getWay ({ 11.0, 10.0 }, { 89.0, 10.0 }));
+    REQUIRE (cache.getMisses () == 1);
+    REQUIRE (cache.getHits () == 0);
+    REQUIRE (cache.getSize () == 1);
+
+    Way way2 (map.getWay ({ 12.0, 11.0 }, { 88.0, 9.0 }));
+    REQUIRE (cache.getHits () == 1);
+    REQUIRE (way2.getPoints () == way1.getPoints ());
+
+    MapSector* sector (map.getSector ({ 50.0, 50.0 }));
+    REQUIRE (sector);
+
+    std::shared_ptr<MapObject> obj (new StaticObject ());
+    Collision c;
+    c.setPoints ({ { 60.0, 60.0 }, { 70.0, 60.0 }, { 70.0, 70.0 } });
+    obj->setCollision (c);
+    sector->attachObject (obj);
+
+    REQUIRE (cache.getSize () == 0);
+
+    map.getWay ({ 11.0, 10.0 }, { 89.0, 10.0 });
+    REQUIRE (cache.getMisses () == 2);
+    REQUIRE (cache.getSize () == 1);
+
+    // Ways of flat search aren't served in hierarchical mode
+    map.setHierarchicalSearch (true);
+    REQUIRE (cache.getSize () == 0);
+
+    map.getWay ({ 11.0, 10.0 }, { 89.0, 10.0 });
+    REQUIRE (cache.getMisses () == 3);
+    REQUIRE (cache.getSize () == 1);
+
+    map.setHierarchicalSearch (true);
+    REQUIRE (cache.getSize () == 1);
+
+    map.setHierarchicalSearch (false);
+    REQUIRE (cache.getSize () == 0);
+
+    cache.setCapacity (0);
+    REQUIRE (cache.getSize () == 0);
+}
+
+TEST_CASE ("Test batch way finding")
+{
+    std::unordered_map<uint32_t, MapSectorDesc> sectors;
+
+    std::vector<WayPoint> way_points;
+    for (size_t i = 0; i < 5; ++i)
+    {
+        for (size_t j = 0; j < 5; ++j)
+        {
+            WayPoint point;
+            point.setRadius (10.0);
+            point.setPosition ({ 10.0f + i * 20.0f, 10.0f + j * 20.0f });
+            way_points.push_back (point);
+        }
+    }
+
+    sectors[0].size = { 100, 100 };
+    sectors[0].sector = std::make_unique<MapSector> (Vector2u (100, 100));
+    sectors[0].sector->setWayPoints (way_points);
+
+    std::shared_ptr<MapObject> obj (new StaticObject ());
+    Collision c;
+    c.setPoints ({ { 25.0, 25.0 }, { 75.0, 25.0 }, { 75.0, 75.0 }, { 25.0, 75.0 } });
+    obj->setCollision (c);
+    sectors[0].sector->attachObject (obj);
+
+    MapManager map;
+    map.setMapDescription (std::move (sectors));
+    map.getPathCache ().setCapacity (0);
+
+    std::vector<std::pair<Vector2f, Vector2f>> queries;
+    for (size_t i = 0; i < 40; ++i)
+        queries.push_back ({ { 11.0f, 11.0f + (i % 5) * 20.0f }, { 89.0f, 91.0f - (i % 3) * 20.0f } });
+
+    std::vector<Way> ways (map.getWays (queries));
+    REQUIRE (ways.size () == queries.size ());
+    REQUIRE_FALSE (map.isNavigationFrozen ());
+
+    for (size_t i = 0; i < queries.size (); ++i)
+    {
+        Way way (map.getWay (queries[i].first, queries[i].second));
+        REQUIRE (ways[i].getPoints () == way.getPoints ());
+        REQUIRE (ways[i].getLength () == way.getLength ());
+    }
+}
+
+TEST_CASE ("Test time-sliced way finding")
+{
+    std::unordered_map<uint32_t, MapSectorDesc> sectors;
+
+    std::vector<WayPoint> way_points;
+    for (size_t i = 0; i < 5; ++i)
+    {
+        for (size_t j = 0; j < 5; ++j)
+        {
+            WayPoint point;
+            point.setRadius (10.0);
+            point.setPosition ({ 10.0f + i * 20.0f, 10.0f + j * 20.0f });
+            way_points.push_back (point);
+        }
+    }
+
+    sectors[0].size = { 100, 100 };
+    sectors[0].sector = std::make_unique<MapSector> (Vector2u (100, 100));
+    sectors[0].sector->setWayPoints (way_points);
+
+    MapManager map;
+    map.setMapDescription (std::move (sectors));
+    map.getPathCache ().setCapacity (0);
+
+    PathRequest request (&map, { 11.0f, 11.0f }, { 89.0f, 91.0f });
+    REQUIRE (request.getState () == PathRequest::State::PENDING);
+    REQUIRE (request.getWay ().getPoints () == 0);
+
+    size_t updates (0);
+    while (request.update (1) == PathRequest::State::PENDING)
+        ++updates;
+
+    REQUIRE (updates > 1);
+    REQUIRE (request.getState () == PathRequest::State::COMPLETE);
+
+    Way way (map.getWay ({ 11.0f, 11.0f }, { 89.0f, 91.0f }));
+    REQUIRE (request.getWay ().getPoints () == way.getPoints ());
+    REQUIRE (request.getWay ().getLength () == way.getLength ());
+}
+
+TEST_CASE ("Test time-sliced way finding on changing map")
+{
+    std::unordered_map<uint32_t, MapSectorDesc> sectors;
+
+    std::vector<WayPoint> way_points;
+    for (size_t i = 0; i < 5; ++i)
+    {
+        for (size_t j = 0; j < 5; ++j)
+        {
+            WayPoint point;
+            point.setRadius (10.0);
+            point.setPosition ({ 10.0f + i * 20.0f, 10.0f + j * 20.0f });
+            way_points.push_back (point);
+        }
+    }
+
+    // The second sector is far away, so its changes don't touch the search
+    for (uint32_t i = 0; i < 2; ++i)
+    {
+        sectors[i].pos = { i * 300, 0 };
+        sectors[i].size = { 100, 100 };
+        sectors[i].sector = std::make_unique<MapSector> (Vector2u (100, 100));
+        sectors[i].sector->setWayPoints (way_points);
+    }
+
+    MapManager map;
+    map.setMapDescription (std::move (sectors));
+    map.getPathCache ().setCapacity (0);
+
+    MapSector* first (map.getSector ({ 50.0f, 50.0f }));
+    MapSector* far (map.getSector ({ 350.0f, 50.0f }));
+    REQUIRE (first);
+    REQUIRE (far);
+
+    Way way (map.getWay ({ 11.0f, 11.0f }, { 89.0f, 91.0f }));
+
+    std::shared_ptr<MapObject> obstacle (new StaticObject ());
+    Collision c;
+    c.setPoints ({ { 15.0, 15.0 }, { 25.0, 15.0 }, { 25.0, 25.0 }, { 15.0, 25.0 } });
+    c.setPosition (far->getOffset ());
+    obstacle->setCollision (c);
+
+    auto run = [&](PathRequest& request)
+    {
+        size_t updates (0);
+        while (request.update (1) == PathRequest::State::PENDING && updates < 1000)
+        {
+            ++updates;
+
+            // Every frame something is changed in the other sector
+            if (obstacle->getSector ())
+                far->removeObject (obstacle.get ());
+            else
+                far->attachObject (obstacle);
+        }
+        return updates;
+    };
+
+    PathRequest request (&map, { 11.0f, 11.0f }, { 89.0f, 91.0f });
+    REQUIRE (run (request) < 100);
+    REQUIRE (request.getState () == PathRequest::State::COMPLETE);
+    REQUIRE (request.getWay ().getLength () == Approx (way.getLength ()));
+
+    // Corridor search is counted against budget of nodes too
+    map.setHierarchicalSearch (true);
+    PathRequest hierarchical (&map, { 11.0f, 11.0f }, { 89.0f, 91.0f });
+    REQUIRE (hierarchical.update (1) == PathRequest::State::PENDING);
+    REQUIRE (run (hierarchical) < 100);
+    REQUIRE (hierarchical.getState () == PathRequest::State::COMPLETE);
+    REQUIRE (hierarchical.getWay ().getLength () == Approx (way.getLength ()));
+
+    // Change of reached nodes starts search again with new edges
+    PathRequest changed (&map, { 11.0f, 11.0f }, { 89.0f, 91.0f });
+    for (size_t i = 0; i < 3; ++i)
+        REQUIRE (changed.update (1) == PathRequest::State::PENDING);
+
+    std::shared_ptr<MapObject> wall (new StaticObject ());
+    c.setPoints ({ { 0.0, 40.0 }, { 80.0, 40.0 }, { 80.0, 60.0 }, { 0.0, 60.0 } });
+    c.setPosition (first->getOffset ());
+    wall->setCollision (c);
+    first->attachObject (wall);
+
+    while (changed.update (1) == PathRequest::State::PENDING);
+    REQUIRE (changed.getState () == PathRequest::State::COMPLETE);
+
+    Way detour (map.getWay ({ 11.0f, 11.0f }, { 89.0f, 91.0f }));
+    REQUIRE (detour.getLength () > way.getLength ());
+    REQUIRE (changed.getWay ().getLength () == Approx (detour.getLength ()));
+}
+
+TEST_CASE ("Test unreachable way rejection")
+{
+    std::unordered_map<uint32_t, MapSectorDesc> sectors;
+
+    std::vector<WayPoint> way_points;
+    for (size_t i = 0; i < 5; ++i)
+    {
+        WayPoint point;
+        point.setRadius (10.0);
+        point.setPosition ({ 10.0f + i * 20.0f, 10.0f });
+        way_points.push_back (point);
+    }
+
+    sectors[0].size = { 100, 100 };
+    sectors[0].sector = std::make_unique<MapSector> (Vector2u (100, 100));
+    sectors[0].sector->setWayPoints (way_points);
+
+    std::shared_ptr<MapObject> obj (new StaticObject ());
+    Collision c;
+    c.setPoints ({ { 45.0, 0.0 }, { 55.0, 0.0 }, { 55.0, 100.0 }, { 45.0, 100.0 } });
+    obj->setCollision (c);
+    sectors[0].sector->attachObject (obj);
+    sectors[0].sector->connectWayPoints ();
+
+    MapManager map;
+    map.setMapDescription (std::move (sectors));
+
+    Way way (map.getWay ({ 11.0f, 11.0f }, { 89.0f, 11.0f }));
+    REQUIRE (way.isEmpty ());
+    REQUIRE (way.getLength () == 0.0f);
+    REQUIRE (map.getPathCache ().getMisses () == 0);
+
+    std::vector<Way> ways (map.getWays ({ { { 11.0f, 11.0f }, { 89.0f, 11.0f } }, { { 11.0f, 11.0f }, { 29.0f, 11.0f } } }));
+    REQUIRE (ways[0].isEmpty ());
+    REQUIRE_FALSE (ways[1].isEmpty ());
+
+    PathRequest request (&map, { 11.0f, 11.0f }, { 89.0f, 11.0f });
+    REQUIRE (request.getState () == PathRequest::State::FAILED);
+    REQUIRE (request.getWay ().isEmpty ());
+}
+
+TEST_CASE ("Test nearest way point index")
+{
+    std::vector<WayPoint> way_points;
+    for (size_t i = 0; i < 20; ++i)
+    {
+        for (size_t j = 0; j < 20; ++j)
+        {
+            WayPoint point;
+            point.setRadius (5.0f + (i * 7 + j * 3) % 11);
+            point.setPosition ({ 5.0f + i * 10.0f + (j % 3), 5.0f + j * 10.0f + (i % 4) });
+            way_points.push_back (point);
+        }
+    }
+
+    MapSector sector (Vector2u (200, 200));
+    sector.setWayPoints (way_points);
+
+    auto check_nearest = [&](Vector2f pos)
+    {
+        uint32_t nearest (0);
+        float min_distance (FLT_MAX);
+        for (uint32_t i = 0; i < sector.getWayPointsCount (); ++i)
+        {
+            float distance (sector.getWayPoint (i)->checkArea (pos));
+            if (distance < min_distance)
+            {
+                min_distance = distance;
+                nearest = i;
+            }
+        }
+        REQUIRE (sector.getNearestWayPoint (pos) == nearest);
+    };
+
+    for (size_t i = 0; i < 50; ++i)
+        check_nearest ({ -10.0f + i * 4.3f, 210.0f - i * 4.7f });
+
+    sector.setOffset ({ 1000.0f, -500.0f });
+
+    for (size_t i = 0; i < 50; ++i)
+        check_nearest ({ 990.0f + i * 4.3f, -290.0f - i * 4.7f });
+
+    std::vector<uint32_t> near_points (sector.getWayPointsInRadius ({ 1100.0f, -400.0f }, 25.0f));
+    std::vector<uint32_t> expected;
+    for (uint32_t i = 0; i < sector.getWayPointsCount (); ++i)
+    {
+        Vector2f dist (sector.getWayPoint (i)->getPosition () - Vector2f (1100.0f, -400.0f));
+        if (dist.x * dist.x + dist.y * dist.y <= 25.0f * 25.0f)
+            expected.push_back (i);
+    }
+
+    REQUIRE_FALSE (expected.empty ());
+    REQUIRE (near_points == expected);
+}
+
+TEST_CASE ("Test incremental way point edges update")
+{
+    std::vector<WayPoint> way_points;
+    for (size_t i = 0; i < 6; ++i)
+    {
+        for (size_t j = 0; j < 6; ++j)
+        {
+            WayPoint point;
+            point.setRadius (10.0);
+            point.setPosition ({ 10.0f + i * 16.0f, 10.0f + j * 16.0f });
+            way_points.push_back (point);
+        }
+    }
+
+    auto get_edges = [](const MapSector* sector)
+    {
+        std::vector<std::vector<size_t>> edges (sector->getWayPointsCount ());
+        for (uint32_t i = 0; i < sector->getWayPointsCount (); ++i)
+        {
+            for (const WayPoint* point : sector->getWayPoint (i)->getEdges ())
+                edges[i].push_back (point - sector->getWayPoint (0));
+            std::sort (edges[i].begin (), edges[i].end ());
+        }
+        return edges;
+    };
+
+    std::shared_ptr<MapObject> obj (new StaticObject ());
+    Collision c;
+    c.setPoints ({ { 30.0, 20.0 }, { 60.0, 25.0 }, { 55.0, 70.0 }, { 28.0, 60.0 } });
+    obj->setCollision (c);
+
+    std::unordered_map<uint32_t, MapSectorDesc> sectors;
+    sectors[0].size = { 100, 100 };
+    sectors[0].sector = std::make_unique<MapSector> (Vector2u (100, 100));
+    sectors[0].sector->setWayPoints (way_points);
+    MapSector* sector (sectors[0].sector.get ());
+
+    MapManager map;
+    map.setMapDescription (std::move (sectors));
+    auto free_edges (get_edges (sector));
+
+    Way free_way (map.getWay ({ 11.0f, 11.0f }, { 89.0f, 89.0f }));
+
+    sector->attachObject (obj);
+
+    MapSector reference (Vector2u (100, 100));
+    reference.setWayPoints (way_points);
+    reference.attachObject (obj);
+    reference.connectWayPoints ();
+
+    REQUIRE (get_edges (sector) == get_edges (&reference));
+    REQUIRE (get_edges (sector) != free_edges);
+
+    Way way (map.getWay ({ 11.0f, 11.0f }, { 89.0f, 89.0f }));
+    REQUIRE_FALSE (way.isEmpty ());
+    REQUIRE (way.getLength () > free_way.getLength ());
+
+    sector->removeObject (obj.get ());
+    REQUIRE (get_edges (sector) == free_edges);
+    REQUIRE (map.getWay ({ 11.0f, 11.0f }, { 89.0f, 89.0f }).getLength () == Approx (free_way.getLength ()));
+}
+
+TEST_CASE ("Test incremental navigation update on many sectors")
+{
+    uint32_t seed (12345);
+    auto random = [&seed](float min, float max)
+    {
+        seed = seed * 1103515245 + 12345;
+        return min + (max - min) * float ((seed >> 8) % 10000) / 10000.0f;
+    };
+
+    std::vector<std::vector<WayPoint>> way_points (4);
+    std::unordered_map<uint32_t, MapSectorDesc> sectors;
+    std::vector<std::unique_ptr<MapSector>> reference;
+
+    for (uint32_t s = 0; s < 4; ++s)
+    {
+        Vector2u pos ((s % 2) * 100, (s / 2) * 100);
+
+        for (size_t i = 0; i < 6; ++i)
+        {
+            for (size_t j = 0; j < 6; ++j)
+            {
+                WayPoint point;
+                point.setRadius (10.0);
+                point.setPosition ({ 10.0f + i * 16.0f + random (-3.0f, 3.0f), 10.0f + j * 16.0f + random (-3.0f, 3.0f) });
+                way_points[s].push_back (point);
+            }
+        }
+
+        sectors[s].pos = pos;
+        sectors[s].size = { 100, 100 };
+        sectors[s].sector = std::make_unique<MapSector> (Vector2u (100, 100));
+        sectors[s].sector->setWayPoints (way_points[s]);
+
+        reference.push_back (std::make_unique<MapSector> (Vector2u (100, 100)));
+        reference[s]->setWayPoints (way_points[s]);
+        reference[s]->setOffset (Vector2f (pos));
+    }
+
+    MapManager map;
+    map.setMapDescription (std::move (sectors));
+    map.getPathCache ().setCapacity (0);
+
+    // Edges of all sectors as pairs of sector and way point
+    auto get_edges = [](const std::vector<MapSector*>& map_sectors)
+    {
+        std::vector<std::vector<std::pair<size_t, size_t>>> edges;
+        for (const MapSector* sector : map_sectors)
+        {
+            for (uint32_t i = 0; i < sector->getWayPointsCount (); ++i)
+            {
+                edges.emplace_back ();
+                for (const WayPoint* point : sector->getWayPoint (i)->getEdges ())
+                {
+                    for (size_t s = 0; s < map_sectors.size (); ++s)
+                    {
+                        const WayPoint* first (map_sectors[s]->getWayPoint (0));
+                        if (point >= first && point < first + map_sectors[s]->getWayPointsCount ())
+                            edges.back ().push_back ({ s, size_t (point - first) });
+                    }
+                }
+                std::sort (edges.back ().begin (), edges.back ().end ());
+            }
+        }
+        return edges;
+    };
+
+    std::vector<MapSector*> map_sectors;
+    std::vector<MapSector*> reference_sectors;
+    for (uint32_t s = 0; s < 4; ++s)
+    {
+        map_sectors.push_back (map.getSector (Vector2f ((s % 2) * 100.0f + 50.0f, (s / 2) * 100.0f + 50.0f)));
+        reference_sectors.push_back (reference[s].get ());
+    }
+
+    std::vector<std::pair<std::shared_ptr<MapObject>, std::shared_ptr<MapObject>>> objects;
+    size_t changes (0);
+
+    auto check = [&](bool hierarchical)
+    {
+        for (uint32_t s = 0; s < 4; ++s)
+            reference[s]->connectWayPoints ();
+        for (uint32_t s = 0; s < 4; ++s)
+        {
+            for (uint32_t n = s + 1; n < 4; ++n)
+                reference[s]->connectWayPoints (reference[n].get ());
+        }
+
+        auto edges (get_edges (map_sectors));
+        REQUIRE (edges == get_edges (reference_sectors));
+
+        // Ways over updated graphs are the same as over rebuilt ones
+        const std::pair<Vector2f, Vector2f> requests[3] = {
+            { { 15.0f, 15.0f }, { 185.0f, 185.0f } },
+            { { 185.0f, 15.0f }, { 15.0f, 185.0f } },
+            { { 95.0f, 20.0f }, { 105.0f, 180.0f } }
+        };
+
+        std::vector<Way> ways;
+        for (const auto& request : requests)
+            ways.push_back (map.getWay (request.first, request.second));
+
+        map.setHierarchicalSearch (hierarchical);
+
+        for (size_t i = 0; i < 3; ++i)
+        {
+            Way way (map.getWay (requests[i].first, requests[i].second));
+            REQUIRE (way.getPoints () == ways[i].getPoints ());
+            REQUIRE (way.isEmpty () == ways[i].isEmpty ());
+        }
+
+        return edges;
+    };
+
+    auto edges (check (false));
+
+    for (size_t step = 0; step < 24; ++step)
+    {
+        bool hierarchical (step % 2 == 0);
+        map.setHierarchicalSearch (hierarchical);
+
+        if (step < 16)
+        {
+            Vector2f center (random (10.0f, 190.0f), random (10.0f, 190.0f));
+            Vector2f size (random (4.0f, 30.0f), random (4.0f, 30.0f));
+
+            Collision c;
+            c.setPoints ({
+                { center.x - size.x / 2, center.y - size.y / 2 },
+                { center.x + size.x / 2, center.y - size.y / 2 },
+                { center.x + size.x / 2, center.y + size.y / 2 },
+                { center.x - size.x / 2, center.y + size.y / 2 }
+            });
+
+            std::shared_ptr<MapObject> obj (new StaticObject ());
+            std::shared_ptr<MapObject> copy (new StaticObject ());
+            obj->setCollision (c);
+            copy->setCollision (c);
+
+            size_t s ((center.x < 100.0f ? 0 : 1) + (center.y < 100.0f ? 0 : 2));
+            map_sectors[s]->attachObject (obj);
+            reference[s]->attachObject (copy);
+            objects.push_back ({ obj, copy });
+        }
+        else
+        {
+            size_t i (size_t (random (0.0f, float (objects.size ()))));
+            for (uint32_t s = 0; s < 4; ++s)
+            {
+                map_sectors[s]->removeObject (objects[i].first.get ());
+                reference[s]->removeObject (objects[i].second.get ());
+            }
+            objects.erase (objects.begin () + i);
+        }
+
+        auto new_edges (check (hierarchical));
+        if (new_edges != edges)
+            ++changes;
+        edges = new_edges;
+    }
+
+    REQUIRE (changes > 12);
+}
+
+TEST_CASE ("Test flow field way finding")
+{
+    std::unordered_map<uint32_t, MapSectorDesc> sectors;
+
+    std::vector<WayPoint> way_points;
+    for (size_t i = 0; i < 5; ++i)
+    {
+        for (size_t j = 0; j < 5; ++j)
+        {
+            WayPoint point;
+            point.setRadius (10.0);
+            point.setPosition ({ 10.0f + i * 20.0f, 10.0f + j * 20.0f });
+            way_points.push_back (point);
+        }
+    }
+
+    sectors[0].size = { 100, 100 };
+    sectors[0].sector = std::make_unique<MapSector> (Vector2u (100, 100));
+    sectors[0].sector->setWayPoints (way_points);
+    MapSector* sector (sectors[0].sector.get ());
+
+    std::shared_ptr<MapObject> obj (new StaticObject ());
+    Collision c;
+    c.setPoints ({ { 25.0, 25.0 }, { 75.0, 25.0 }, { 75.0, 75.0 }, { 25.0, 75.0 } });
+    obj->setCollision (c);
+    sector->attachObject (obj);
+
+    MapManager map;
+    map.setMapDescription (std::move (sectors));
+
+    Vector2f goal (89.0f, 91.0f);
+    std::shared_ptr<const FlowField> field (map.getFlowField (goal));
+    REQUIRE (field);
+    REQUIRE (map.getFlowField (goal) == field);
+
+    for (size_t i = 0; i < 5; ++i)
+    {
+        Vector2f departure (11.0f, 11.0f + i * 20.0f);
+        Vector2f step;
+        Vector2f position (departure);
+        size_t steps (0);
+
+        while (steps < 25 && map.getFlowStep (position, goal, step) && step != goal)
+        {
+            if (steps > 0)
+                REQUIRE (obj->detectCollision (position, step) == Collision::State::OUTSIDE);
+            position = step;
+            ++steps;
+        }
+
+        REQUIRE (step == goal);
+        REQUIRE (steps < 25);
+    }
+
+    sector->removeObject (obj.get ());
+    REQUIRE (map.getFlowField (goal) != field);
+}
+
+TEST_CASE ("Test jump point search")
+{
+    const int32_t size (40);
+
+    // Dijkstra over all cells with the same moving rules
+    auto find_distance = [&](const WalkabilityGrid& grid, Vector2i departure, Vector2i target)
+    {
+        std::vector<float> distances (size * size, FLT_MAX);
+        typedef std::pair<float, int32_t> Item;
+        std::priority_queue<Item, std::vector<Item>, std::greater<Item>> opened;
+
+        distances[departure.y * size + departure.x] = 0.0f;
+        opened.push ({ 0.0f, departure.y * size + departure.x });
+
+        while (!opened.empty ())
+        {
+            Item item (opened.top ());
+            opened.pop ();
+            if (item.first > distances[item.second])
+                continue;
+
+            int32_t x (item.second % size);
+            int32_t y (item.second / size);
+
+            for (int32_t dy = -1; dy <= 1; ++dy)
+            {
+                for (int32_t dx = -1; dx <= 1; ++dx)
+                {
+                    if ((dx == 0 && dy == 0) || !grid.isWalkable (x + dx, y + dy))
+                        continue;
+                    if (dx != 0 && dy != 0 && (!grid.isWalkable (x + dx, y) || !grid.isWalkable (x, y + dy)))
+                        continue;
+
+                    float distance (item.first + (dx != 0 && dy != 0 ? std::sqrt (2.0f) : 1.0f));
+                    if (distance < distances[(y + dy) * size + x + dx])
+                    {
+                        distances[(y + dy) * size + x + dx] = distance;
+                        opened.push ({ distance, (y + dy) * size + x + dx });
+                    }
+                }
+            }
+        }
+
+        return distances[target.y * size + target.x];
+    };
+
+    uint32_t seed (12345);
+    auto random = [&seed]()
+    {
+        seed = seed * 1103515245 + 12345;
+        return (seed >> 16) & 0x7fff;
+    };
+
+    JumpPointSearch search;
+
+    for (size_t test = 0; test < 30; ++test)
+    {
+        WalkabilityGrid grid;
+        grid.reset ({ 0.0f, 0.0f }, size, size);
+
+        for (int32_t y = 0; y < size; ++y)
+        {
+            for (int32_t x = 0; x < size; ++x)
+            {
+                if (random () % 100 < 25)
+                    grid.setWalkable (x, y, false);
+            }
+        }
+
+        Vector2i departure (random () % size, random () % size);
+        Vector2i target (random () % size, random () % size);
+        grid.setWalkable (departure.x, departure.y, true);
+        grid.setWalkable (target.x, target.y, true);
+
+        std::vector<Vector2i> path;
+        float expected (find_distance (grid, departure, target));
+        bool found (search.findPath (grid, departure, target, path));
+
+        REQUIRE (found == (expected != FLT_MAX));
+        if (!found)
+            continue;
+
+        REQUIRE (path.front () == departure);
+        REQUIRE (path.back () == target);
+
+        float length (0.0f);
+        for (size_t i = 1; i < path.size (); ++i)
+        {
+            Vector2i step (path[i] - path[i - 1]);
+            Vector2i direction ((step.x > 0) - (step.x < 0), (step.y > 0) - (step.y < 0));
+            REQUIRE ((step.x == 0 || step.y == 0 || std::abs (step.x) == std::abs (step.y)));
+
+            for (Vector2i cell (path[i - 1]); cell != path[i]; cell += direction)
+            {
+                REQUIRE (grid.isWalkable (cell.x + direction.x, cell.y + direction.y));
+                if (direction.x != 0 && direction.y != 0)
+                    REQUIRE ((grid.isWalkable (cell.x + direction.x, cell.y) && grid.isWalkable (cell.x, cell.y + direction.y)));
+                length += (direction.x != 0 && direction.y != 0) ? std::sqrt (2.0f) : 1.0f;
+            }
+        }
+
+        REQUIRE (length == Approx (expected));
+    }
+}
+
+TEST_CASE ("Test grid way finding")
+{
+    std::unordered_map<uint32_t, MapSectorDesc> sectors;
+    for (uint32_t i = 0; i < 2; ++i)
+    {
+        sectors[i].pos = { i * 50, 0 };
+        sectors[i].size = { 50, 50 };
+        sectors[i].sector = std::make_unique<MapSector> (Vector2u (50, 50));
+    }
+
+    std::shared_ptr<MapObject> wall (new StaticObject ());
+    Collision c;
+    c.setPoints ({ { 20.0, 0.0 }, { 30.0, 0.0 }, { 30.0, 40.0 }, { 20.0, 40.0 } });
+    wall->setCollision (c);
+    sectors[0].sector->attachObject (wall);
+    MapSector* sector (sectors[0].sector.get ());
+
+    MapManager map;
+    map.setMapDescription (std::move (sectors));
+
+    REQUIRE_FALSE (sector->getWalkability ().isWalkable (25, 20));
+    REQUIRE (sector->getWalkability ().isWalkable (25, 45));
+    REQUIRE (sector->getWalkability ().isWalkable (35, 20));
+
+    Way way (map.getGridWay ({ 5.5f, 5.5f }, { 90.5f, 5.5f }));
+    REQUIRE_FALSE (way.isEmpty ());
+    REQUIRE (way.getLength () > 85.0f);
+
+    Vector2f position (5.5f, 5.5f);
+    Vector2f vec;
+    do
+    {
+        vec = way.getMovingVector (position, 1.0f);
+        REQUIRE (wall->detectCollision (position, position + vec) == Collision::State::OUTSIDE);
+        position += vec;
+    } while (vec != Vector2f ());
+
+    REQUIRE (position.x == Approx (90.5f));
+    REQUIRE (position.y == Approx (5.5f));
+
+    std::shared_ptr<MapObject> door (new StaticObject ());
+    c.setPoints ({ { 20.0, 40.0 }, { 30.0, 40.0 }, { 30.0, 50.0 }, { 20.0, 50.0 } });
+    door->setCollision (c);
+    sector->attachObject (door);
+
+    REQUIRE_FALSE (sector->getWalkability ().isWalkable (25, 45));
+    REQUIRE (map.getGridWay ({ 5.5f, 5.5f }, { 90.5f, 5.5f }).isEmpty ());
+
+    sector->removeObject (door.get ());
+    REQUIRE (sector->getWalkability ().isWalkable (25, 45));
+    REQUIRE_FALSE (sector->getWalkability ().isWalkable (25, 20));
+    REQUIRE (map.getGridWay ({ 5.5f, 5.5f }, { 90.5f, 5.5f }).getLength () == Approx (way.getLength ()));
+
+    // Actor doesn't block tiles where it stands or where it was
+    std::shared_ptr<InteractiveObject> actor (new InteractiveObject ());
+    c.setPoints ({ { -1.0, -1.0 }, { 1.0, -1.0 }, { 1.0, 1.0 }, { -1.0, 1.0 } });
+    c.setPosition ({ 5.5f, 5.5f });
+    actor->setCollision (c);
+    sector->attachObject (actor);
+    REQUIRE (sector->getWalkability ().isWalkable (5, 5));
+
+    actor->move ({ 5.0f, 10.0f });
+    REQUIRE (actor->getPosition () == Vector2f (10.5f, 15.5f));
+    REQUIRE (sector->getWalkability ().isWalkable (5, 5));
+    REQUIRE (sector->getWalkability ().isWalkable (10, 15));
+
+    Way actor_way (map.getGridWay (actor->getPosition (), { 90.5f, 5.5f }));
+    REQUIRE_FALSE (actor_way.isEmpty ());
+    REQUIRE (map.getGridWay ({ 5.5f, 5.5f }, { 90.5f, 5.5f }).getLength () == Approx (way.getLength ()));
+
+    sector->removeObject (actor.get ());
+    REQUIRE_FALSE (sector->getWalkability ().isWalkable (25, 20));
+
+    // Sector may hold the only reference to removed object
+    const MapObject* raw_door (door.get ());
+    sector->attachObject (door);
+    door.reset ();
+    REQUIRE_FALSE (sector->getWalkability ().isWalkable (25, 45));
+
+    sector->removeObject (raw_door);
+    REQUIRE (sector->getWalkability ().isWalkable (25, 45));
+
+    // Grid follows sectors when map is centered on another area
+    REQUIRE (map.getGridWay ({ 5.5f, 5.5f }, { 90.5f, 5.5f }).getLength () == Approx (way.getLength ()));
+    map.lookMap ({ UintRect (40, 0, 20, 20) });
+    Vector2f shift (sector->getOffset ());
+    REQUIRE (shift != Vector2f ());
+
+    Way moved_way (map.getGridWay (Vector2f (5.5f, 5.5f) + shift, Vector2f (90.5f, 5.5f) + shift));
+    REQUIRE (moved_way.getLength () == Approx (way.getLength ()));
+
+    position = Vector2f (5.5f, 5.5f) + shift;
+    do
+    {
+        vec = moved_way.getMovingVector (position, 1.0f);
+        REQUIRE (wall->detectCollision (position, position + vec) == Collision::State::OUTSIDE);
+        position += vec;
+    } while (vec != Vector2f ());
+
+    REQUIRE (position.x == Approx (90.5f + shift.x));
+    REQUIRE (position.y == Approx (5.5f + shift.y));
+}
+
+TEST_CASE ("Test replanning way finding")
+{
+    std::vector<WayPoint> way_points;
+    for (size_t i = 0; i < 7; ++i)
+    {
+        for (size_t j = 0; j < 7; ++j)
+        {
+            WayPoint point;
+            point.setRadius (8.0);
+            point.setPosition ({ 8.0f + i * 14.0f + (i * 7 + j) % 3, 8.0f + j * 14.0f + (i + j * 5) % 4 });
+            way_points.push_back (point);
+        }
+    }
+
+    std::shared_ptr<MapObject> obj (new StaticObject ());
+    Collision c;
+    c.setPoints ({ { 40.0, 0.0 }, { 52.0, 0.0 }, { 52.0, 70.0 }, { 40.0, 70.0 } });
+    obj->setCollision (c);
+
+    std::unordered_map<uint32_t, MapSectorDesc> sectors;
+    sectors[0].size = { 100, 100 };
+    sectors[0].sector = std::make_unique<MapSector> (Vector2u (100, 100));
+    sectors[0].sector->setWayPoints (way_points);
+    MapSector* sector (sectors[0].sector.get ());
+
+    MapManager map;
+    map.setMapDescription (std::move (sectors));
+    map.getPathCache ().setCapacity (0);
+
+    ReplanningPath path (&map);
+    path.setDeparture ({ 9.0f, 20.0f });
+    path.setTarget ({ 90.0f, 22.0f });
+
+    REQUIRE (path.update ());
+    Way free_way (map.getWay ({ 9.0f, 20.0f }, { 90.0f, 22.0f }));
+    REQUIRE (path.getWay ().getLength () == Approx (free_way.getLength ()));
+
+    sector->attachObject (obj);
+    REQUIRE (path.update ());
+    REQUIRE (path.getExpandedNodes () > 0);
+    Way way (map.getWay ({ 9.0f, 20.0f }, { 90.0f, 22.0f }));
+    REQUIRE (way.getLength () > free_way.getLength ());
+    REQUIRE (path.getWay ().getLength () == Approx (way.getLength ()));
+
+    path.setTarget ({ 90.0f, 60.0f });
+    REQUIRE (path.update ());
+    REQUIRE (path.getWay ().getLength () == Approx (map.getWay ({ 9.0f, 20.0f }, { 90.0f, 60.0f }).getLength ()));
+
+    path.setDeparture ({ 30.0f, 80.0f });
+    REQUIRE (path.update ());
+    REQUIRE (path.getWay ().getLength () == Approx (map.getWay ({ 30.0f, 80.0f }, { 90.0f, 60.0f }).getLength ()));
+
+    ReplanningPath fresh (&map);
+    fresh.setDeparture ({ 30.0f, 80.0f });
+    fresh.setTarget ({ 90.0f, 60.0f });
+    REQUIRE (fresh.update ());
+    REQUIRE (path.getExpandedNodes () <= fresh.getExpandedNodes ());
+
+    REQUIRE (path.update ());
+    REQUIRE (path.getExpandedNodes () == 0);
+
+    sector->removeObject (obj.get ());
+    REQUIRE (path.update ());
+    REQUIRE (path.getWay ().getLength () == Approx (map.getWay ({ 30.0f, 80.0f }, { 90.0f, 60.0f }).getLength ()));
+
+    path.setTarget ({ 45.0f, 120.0f });
+    REQUIRE_FALSE (path.update ());
+    REQUIRE (path.getWay ().isEmpty ());
+}
+
+TEST_CASE ("Test way smoothing")
+{
+    std::vector<WayPoint> way_points;
+    for (size_t i = 0; i < 10; ++i)
+    {
+        for (size_t j = 0; j < 10; ++j)
+        {
+            WayPoint point;
+            point.setRadius (8.0);
+            point.setPosition ({ 5.0f + i * 10.0f, 5.0f + j * 10.0f });
+            way_points.push_back (point);
+        }
+    }
+
+    std::unordered_map<uint32_t, MapSectorDesc> sectors;
+    sectors[0].size = { 100, 100 };
+    sectors[0].sector = std::make_unique<MapSector> (Vector2u (100, 100));
+    sectors[0].sector->setWayPoints (way_points);
+    MapSector* sector (sectors[0].sector.get ());
+
+    // Visibility is limited by walls, so way goes around their ends
+    std::shared_ptr<MapObject> wall1 (new StaticObject ());
+    Collision c1;
+    c1.setPoints ({ { 30.0, 0.0 }, { 33.0, 0.0 }, { 33.0, 70.0 }, { 30.0, 70.0 } });
+    wall1->setCollision (c1);
+    sector->attachObject (wall1);
+
+    std::shared_ptr<MapObject> wall2 (new StaticObject ());
+    Collision c2;
+    c2.setPoints ({ { 66.0, 30.0 }, { 69.0, 30.0 }, { 69.0, 100.0 }, { 66.0, 100.0 } });
+    wall2->setCollision (c2);
+    sector->attachObject (wall2);
+
+    MapManager map;
+    map.setMapDescription (std::move (sectors));
+    map.getPathCache ().setCapacity (0);
+
+    REQUIRE_FALSE (map.checkPass ({ 10.0f, 10.0f }, { 90.0f, 90.0f }));
+    REQUIRE (map.checkPass ({ 10.0f, 80.0f }, { 90.0f, 80.0f }) == false);
+    REQUIRE (map.checkPass ({ 10.0f, 80.0f }, { 50.0f, 80.0f }));
+
+    Vector2f departure (10.0f, 10.0f);
+    Vector2f target (90.0f, 90.0f);
+
+    Way way (map.getWay (departure, target));
+    Way smooth_way (map.getWay (departure, target, true));
+
+    REQUIRE_FALSE (smooth_way.isEmpty ());
+    REQUIRE (smooth_way.getPoints () < way.getPoints ());
+    REQUIRE (smooth_way.getLength () <= way.getLength ());
+
+    // Shortcuts are checked against obstacles, so smoothed way doesn't
+    // cross walls more often than segments between way points do
+    auto follow = [&](Way way, Vector2f& position)
+    {
+        size_t blocked (0);
+        position = departure;
+        for (size_t i = 0; i < 1000; ++i)
+        {
+            Vector2f next (position + way.getMovingVector (position, 2.0f));
+            if (next == position)
+                break;
+
+            if (!map.checkPass (position, next))
+                ++blocked;
+            position = next;
+        }
+        return blocked;
+    };
+
+    Vector2f end;
+    size_t blocked (follow (way, end));
+    REQUIRE (follow (smooth_way, end) <= blocked);
+    REQUIRE (end.x == Approx (target.x));
+    REQUIRE (end.y == Approx (target.y));
+
+    std::vector<Way> ways (map.getWays ({ { departure, target } }, true));
+    REQUIRE (ways[0].getPoints () == smooth_way.getPoints ());
+    REQUIRE (ways[0].getLength () == Approx (smooth_way.getLength ()));
+}
+
+TEST_CASE ("Test batched pass checking")
+{
+    std::mt19937 gen (13);
+    std::uniform_real_distribution<float> place (0.0f, 200.0f);
+    std::uniform_real_distribution<float> size (1.0f, 6.0f);
+
+    std::unordered_map<uint32_t, MapSectorDesc> sectors;
+    sectors[0].size = { 100, 100 };
+    sectors[0].sector = std::make_unique<MapSector> (Vector2u (100, 100));
+    sectors[1].pos = { 100, 0 };
+    sectors[1].size = { 100, 100 };
+    sectors[1].sector = std::make_unique<MapSector> (Vector2u (100, 100));
+
+    MapManager map;
+    map.setMapDescription (std::move (sectors));
+
+    std::vector<std::shared_ptr<MapObject>> objects;
+    for (size_t i = 0; i < 100; ++i)
+    {
+        Vector2f pos (place (gen), place (gen) / 2.0f);
+        float radius (size (gen));
+
+        std::shared_ptr<MapObject> obj (new StaticObject ());
+        Collision c;
+        c.setPoints ({ { -radius, 0.0f }, { 0.0f, -radius }, { radius, 0.0f }, { radius, radius }, { 0.0f, radius } });
+        c.setPosition (pos);
+        obj->setCollision (c);
+        map.getSector (pos)->attachObject (obj);
+        objects.push_back (obj);
+    }
+
+    Vector2f shift;
+    auto check = [&]()
+    {
+        std::vector<Segment> segments;
+        for (size_t i = 0; i < 300; ++i)
+            segments.emplace_back (Vector2f (place (gen), place (gen) / 2.0f) + shift, Vector2f (place (gen), place (gen) / 2.0f) + shift);
+
+        std::vector<uint64_t> blocked;
+        map.checkPass (segments, blocked);
+        REQUIRE (blocked.size () == (segments.size () + 63) / 64);
+
+        size_t blocked_count (0);
+        for (size_t i = 0; i < segments.size (); ++i)
+        {
+            bool is_blocked ((blocked[i / 64] >> (i % 64)) & 1);
+
+            bool expected (false);
+            for (const auto& obj : objects)
+            {
+                if (obj->detectCollision (segments[i].first, segments[i].second) != Collision::State::OUTSIDE)
+                    expected = true;
+            }
+
+            REQUIRE (is_blocked == expected);
+            REQUIRE (map.checkPass (segments[i].first, segments[i].second) == !expected);
+
+            if (is_blocked)
+                ++blocked_count;
+        }
+
+        REQUIRE (blocked_count > 0);
+        REQUIRE (blocked_count < segments.size ());
+    };
+
+    check ();
+
+    // Edges of moved objects are updated in place
+    for (size_t i = 0; i < 10; ++i)
+    {
+        objects[i]->setPosition (objects[i]->getPosition () + Vector2f (3.0f, 2.0f));
+        objects[i]->getSector ()->updateObject (objects[i].get ());
+    }
+
+    check ();
+
+    objects.back ()->getSector ()->removeObject (objects.back ().get ());
+    objects.pop_back ();
+
+    check ();
+
+    // Built edges follow objects when map is recentred
+    Vector2f center (objects.front ()->getPosition ());
+    REQUIRE (!map.checkPass (center - Vector2f (10.0f, 0.0f), center + Vector2f (10.0f, 0.0f)));
+
+    map.lookMap ({ UintRect (0, 0, 100, 100) });
+    shift = Vector2f (-50.0f, -50.0f);
+    REQUIRE (objects.front ()->getPosition () == center + shift);
+    REQUIRE (!map.checkPass (center + shift - Vector2f (10.0f, 0.0f), center + shift + Vector2f (10.0f, 0.0f)));
+
+    check ();
+}
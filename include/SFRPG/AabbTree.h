@@ -0,0 +1,213 @@
+/////////////////////////////////////////////////////////////////////
+//
+// SFGE - Simple and Fast Game Engine
+//
+// Copyright (c) 2016-2017 DonRumata710 
+// 
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation
+// files (the "Software"), to deal in the Software without
+// restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+// WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+// 
+/////////////////////////////////////////////////////////////////////
+
+
+#pragma once
+
+
+#include <SFML/Graphics/Rect.hpp>
+#include <SFML/System/Vector2.hpp>
+
+#include <vector>
+#include <functional>
+#include <cstdint>
+
+
+namespace sfge
+{
+
+
+    using sf::Vector2f;
+    using sf::FloatRect;
+
+
+    /////////////////////////////////////////////////////////////////////
+    /// AabbTree - dynamic bounding volume hierarchy of moving items
+    ///
+    /// Every item is stored in leaf with fattened bounds: bounds are
+    /// enlarged by margin and stretched in direction of last movement.
+    /// Item which stays inside its fat bounds is moved for free, other
+    /// ones are reinserted and only their ancestors are refitted. Tree is
+    /// kept balanced by rotations, so queries take logarithmic time.
+    /////////////////////////////////////////////////////////////////////
+    class AabbTree
+    {
+    public:
+        static const uint32_t NULL_NODE = UINT32_MAX;
+
+        /////////////////////////////////////////////////////////////////////
+        /// Constructor
+        ///
+        /// @param margin - enlargement of bounds on every side
+        /// @param prediction - multiplier of last displacement which is
+        /// added to fat bounds
+        /////////////////////////////////////////////////////////////////////
+        explicit AabbTree (float margin = 0.1f, float prediction = 2.0f);
+
+        /////////////////////////////////////////////////////////////////////
+        /// clear - remove all items
+        /////////////////////////////////////////////////////////////////////
+        void clear ();
+
+        /////////////////////////////////////////////////////////////////////
+        /// insert - add item to the tree
+        ///
+        /// @param bounds - bounding rectangle of item
+        /// @param data - user data of item
+        ///
+        /// @return - proxy of item
+        /////////////////////////////////////////////////////////////////////
+        uint32_t insert (const FloatRect& bounds, void* data);
+
+        /////////////////////////////////////////////////////////////////////
+        /// remove - remove item from the tree
+        ///
+        /// @param proxy - proxy of item
+        /////////////////////////////////////////////////////////////////////
+        void remove (uint32_t proxy);
+
+        /////////////////////////////////////////////////////////////////////
+        /// move - set new bounds of item
+        ///
+        /// @param proxy - proxy of item
+        /// @param bounds - new bounding rectangle of item
+        ///
+        /// @return - true if item left its fat bounds and was reinserted
+        /////////////////////////////////////////////////////////////////////
+        bool move (uint32_t proxy, const FloatRect& bounds);
+
+        void* getData (uint32_t proxy) const;
+
+        /////////////////////////////////////////////////////////////////////
+        /// getFatBounds - get enlarged bounds which are stored in the tree
+        ///
+        /// @param proxy - proxy of item
+        ///
+        /// @return - fat bounds
+        /////////////////////////////////////////////////////////////////////
+        const FloatRect& getFatBounds (uint32_t proxy) const;
+
+        /////////////////////////////////////////////////////////////////////
+        /// getBounds - get the last bounds which were passed for item
+        ///
+        /// @param proxy - proxy of item
+        ///
+        /// @return - bounds
+        /////////////////////////////////////////////////////////////////////
+        const FloatRect& getBounds (uint32_t proxy) const;
+
+        /////////////////////////////////////////////////////////////////////
+        /// getSize - get number of items
+        ///
+        /// @return - number of items
+        /////////////////////////////////////////////////////////////////////
+        size_t getSize () const;
+
+        /////////////////////////////////////////////////////////////////////
+        /// getHeight - get height of the tree
+        ///
+        /// @return - zero for empty tree or tree with one item
+        /////////////////////////////////////////////////////////////////////
+        uint32_t getHeight () const;
+
+        /////////////////////////////////////////////////////////////////////
+        /// query - get items which fat bounds overlap rectangle
+        ///
+        /// Items are candidates only: their real bounds may be far from
+        /// rectangle by margin of the tree.
+        ///
+        /// @param rect - rectangle
+        /// @param proxies - proxies of items in order of traversal
+        /////////////////////////////////////////////////////////////////////
+        void query (const FloatRect& rect, std::vector<uint32_t>& proxies) const;
+
+        /////////////////////////////////////////////////////////////////////
+        /// raycast - visit items which fat bounds are crossed by segment
+        ///
+        /// Callback gets proxy and the current max fraction of segment and
+        /// returns fraction of hit with item. Segment is clipped by the
+        /// returned value, so far items aren't visited after near hit.
+        /// Return value greater or equal to max fraction to skip item and
+        /// zero to stop traversal.
+        ///
+        /// @param p1 - the first point of segment
+        /// @param p2 - the second point of segment
+        /// @param callback - precise test of item
+        /////////////////////////////////////////////////////////////////////
+        void raycast (Vector2f p1, Vector2f p2, const std::function<float (uint32_t, float)>& callback) const;
+
+    private:
+        struct Node
+        {
+            FloatRect fat_bounds;
+            FloatRect bounds;
+            void* data = nullptr;
+
+            // Parent of node in the tree or next free node in the pool
+            uint32_t parent = NULL_NODE;
+            uint32_t left = NULL_NODE;
+            uint32_t right = NULL_NODE;
+            int32_t height = -1;
+
+            bool isLeaf () const { return left == NULL_NODE; }
+        };
+
+        uint32_t allocateNode ();
+
+        void freeNode (uint32_t id);
+
+        void insertLeaf (uint32_t leaf);
+
+        void removeLeaf (uint32_t leaf);
+
+        void refit (uint32_t id);
+
+        uint32_t balance (uint32_t id);
+
+        FloatRect getFatBounds (const FloatRect& bounds, Vector2f displacement) const;
+
+        static FloatRect combine (const FloatRect& first, const FloatRect& second);
+
+        static float getPerimeter (const FloatRect& rect);
+
+        static bool contains (const FloatRect& outer, const FloatRect& inner);
+
+        static bool overlap (const FloatRect& first, const FloatRect& second);
+
+    private:
+        std::vector<Node> m_nodes;
+        uint32_t m_root = NULL_NODE;
+        uint32_t m_free = NULL_NODE;
+        size_t m_size = 0;
+
+        float m_margin;
+        float m_prediction;
+    };
+
+
+}
@@ -30,6 +30,7 @@
 #pragma once
 
 
+#include <SFML/Graphics/Rect.hpp>
 #include <SFML/System/Vector2.hpp>
 
 #include <vector>
@@ -41,11 +42,21 @@ namespace sfge
 
     
     using sf::Vector2f;
+    using sf::FloatRect;
 
     typedef Vector2f Point;
     typedef std::vector<Point> Circuit;
 
 
+    /////////////////////////////////////////////////////////////////////
+    /// Collision - polygon which is used to detect collisions of objects
+    ///
+    /// Bounding box and bounding circle of polygon are computed when
+    /// points are set. Every check rejects far shapes by them before
+    /// edges of polygon are tested. Concave polygon is split into convex
+    /// parts when points are set, so near shapes are separated by axes
+    /// of these parts before edges are crossed.
+    /////////////////////////////////////////////////////////////////////
     class Collision
     {
     public:
@@ -70,22 +81,118 @@ namespace sfge
 
         void setPoints (const Circuit& points);
 
+        const Circuit& getPoints () const;
+
+        /////////////////////////////////////////////////////////////////////
+        /// getBounds - get bounding box of polygon
+        ///
+        /// @return - bounding box in coordinates of map
+        /////////////////////////////////////////////////////////////////////
+        FloatRect getBounds () const;
+
+        /////////////////////////////////////////////////////////////////////
+        /// getCenter - get center of bounding circle
+        ///
+        /// @return - center in coordinates of map
+        /////////////////////////////////////////////////////////////////////
+        Point getCenter () const;
+
+        /////////////////////////////////////////////////////////////////////
+        /// getRadius - get radius of bounding circle
+        ///
+        /// @return - radius
+        /////////////////////////////////////////////////////////////////////
+        float getRadius () const;
+
         State check (const Collision& collision) const;
 
         State check (const Point p1, const Point p2) const;
 
         State check (const Point point) const;
 
+        /////////////////////////////////////////////////////////////////////
+        /// getDistance - get distance from point to polygon
+        ///
+        /// @param point - point
+        ///
+        /// @return - zero if point is inside of polygon or distance to the
+        /// closest edge otherwise
+        /////////////////////////////////////////////////////////////////////
+        float getDistance (const Point point) const;
+
+        /////////////////////////////////////////////////////////////////////
+        /// raycast - find the first point where segment enters polygon
+        ///
+        /// @param p1 - the first point of segment
+        /// @param p2 - the second point of segment
+        /// @param fraction - position of hit on segment from 0 at p1 to 1
+        /// at p2, zero if p1 is inside of polygon
+        ///
+        /// @return - true if segment touches polygon
+        /////////////////////////////////////////////////////////////////////
+        bool raycast (const Point p1, const Point p2, float& fraction) const;
+
+        /////////////////////////////////////////////////////////////////////
+        /// sweep - find time of impact of polygon moved by vector
+        ///
+        /// Polygon stops at distance of skin from other one, so it doesn't
+        /// touch obstacle after movement. Polygon which already overlaps
+        /// other one is hit at once only when it moves deeper, so it can
+        /// slide along obstacle or leave it.
+        ///
+        /// @param collision - static polygon
+        /// @param vector - movement of this polygon
+        /// @param time - part of vector which can be passed, from 0 to 1
+        /// @param normal - unit normal of contact which points from other
+        /// polygon to this one
+        ///
+        /// @return - true if polygon hits other one during movement
+        /////////////////////////////////////////////////////////////////////
+        bool sweep (const Collision& collision, Vector2f vector, float& time, Vector2f& normal) const;
+
     private:
-        bool segmentCollision (const Point a, const Point b, const Point c, const Point d) const;
+        /////////////////////////////////////////////////////////////////////
+        /// Polygon - vertices and edge normals in structure-of-arrays form
+        ///
+        /// The first vertex is repeated after the last one, so edge i
+        /// always goes from vertex i to vertex i + 1.
+        /////////////////////////////////////////////////////////////////////
+        struct Polygon
+        {
+            std::vector<float> xs;
+            std::vector<float> ys;
+            std::vector<float> normal_xs;
+            std::vector<float> normal_ys;
+        };
 
-        bool isPointInside (Point p) const;
+        void updateBounds ();
+
+        void updatePolygons ();
+
+        static void setPolygon (const Circuit& points, Polygon& polygon);
 
-        static float sign (Point p1, Point p2, Point p3);
+        bool overlapBounds (const Collision& collision) const;
+
+        bool overlapParts (const Collision& collision) const;
+
+        bool sweepPart (const Polygon& part, const Polygon& other, Vector2f offset, Vector2f vector, float& time, Vector2f& normal) const;
+
+        bool crossEdges (Point p1, Point p2) const;
+
+        bool isPointInside (Point p) const;
 
     private:
         Circuit m_points;
         Point m_position;
+
+        // Bounds are stored relative to position, so moving is free
+        Point m_min;
+        Point m_max;
+        Point m_center;
+        float m_radius = 0.0f;
+
+        Polygon m_boundary;
+        std::vector<Polygon> m_parts;
     };
 
 
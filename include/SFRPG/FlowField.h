@@ -0,0 +1,124 @@
+/////////////////////////////////////////////////////////////////////
+//
+// SFGE - Simple and Fast Game Engine
+//
+// Copyright (c) 2016-2017 DonRumata710 
+// 
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation
+// files (the "Software"), to deal in the Software without
+// restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+// WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+// 
+/////////////////////////////////////////////////////////////////////
+
+
+#pragma once
+
+
+#include "WayPoint.h"
+
+#include <unordered_map>
+#include <vector>
+#include <cstdint>
+
+
+namespace sfge
+{
+
+
+    class NavigationGraph;
+
+
+    /////////////////////////////////////////////////////////////////////
+    /// FlowField - shortest distances from all way points to one goal
+    ///
+    /// Field is computed once by Dijkstra search from the goal and then
+    /// gives next way point to the goal for any reachable way point in
+    /// constant time. Field is addressed by ids of way points, so it
+    /// stays valid while way points of covered sectors aren't changed.
+    /// Edges of navigation graph are expected to be symmetric.
+    /////////////////////////////////////////////////////////////////////
+    class FlowField
+    {
+    public:
+        /////////////////////////////////////////////////////////////////////
+        /// build - compute field
+        ///
+        /// @param graph - navigation graph
+        /// @param goal - index of goal node
+        /////////////////////////////////////////////////////////////////////
+        void build (const NavigationGraph& graph, uint32_t goal);
+
+        /////////////////////////////////////////////////////////////////////
+        /// getGoal - get goal way point
+        ///
+        /// @return - id of way point
+        /////////////////////////////////////////////////////////////////////
+        WayPointID getGoal () const;
+
+        /////////////////////////////////////////////////////////////////////
+        /// isReachable - check if goal can be reached from way point
+        ///
+        /// @param point - id of way point
+        ///
+        /// @return - true if there is way to goal
+        /////////////////////////////////////////////////////////////////////
+        bool isReachable (const WayPointID& point) const;
+
+        /////////////////////////////////////////////////////////////////////
+        /// getDistance - get length of the shortest way to goal
+        ///
+        /// @param point - id of reachable way point
+        ///
+        /// @return - distance between centers of way points along the way
+        /////////////////////////////////////////////////////////////////////
+        float getDistance (const WayPointID& point) const;
+
+        /////////////////////////////////////////////////////////////////////
+        /// getNext - get next way point on the way to goal
+        ///
+        /// @param point - id of reachable way point
+        ///
+        /// @return - id of next way point, goal for goal itself
+        /////////////////////////////////////////////////////////////////////
+        WayPointID getNext (const WayPointID& point) const;
+
+        /////////////////////////////////////////////////////////////////////
+        /// getSectors - get sectors which have reachable way points
+        ///
+        /// @return - sorted ids of sectors
+        /////////////////////////////////////////////////////////////////////
+        const std::vector<uint32_t>& getSectors () const;
+
+    private:
+        struct Cell
+        {
+            float distance;
+            WayPointID next;
+        };
+
+        const Cell* findCell (const WayPointID& point) const;
+
+    private:
+        WayPointID m_goal;
+        std::vector<uint32_t> m_sectors;
+        std::unordered_map<uint32_t, std::vector<Cell>> m_cells;
+    };
+
+
+}
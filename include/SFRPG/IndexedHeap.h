@@ -0,0 +1,258 @@
+/////////////////////////////////////////////////////////////////////
+//
+// SFGE - Simple and Fast Game Engine
+//
+// Copyright (c) 2016-2017 DonRumata710 
+// 
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation
+// files (the "Software"), to deal in the Software without
+// restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+// WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+// 
+/////////////////////////////////////////////////////////////////////
+
+
+#pragma once
+
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+
+namespace sfge
+{
+
+
+    /////////////////////////////////////////////////////////////////////
+    /// IndexedHeap - binary min-heap of dense node indices
+    ///
+    /// Every node may be stored in the heap only once. Position of each
+    /// node is tracked, so key of stored node can be decreased in place.
+    /// Nodes are ordered by key, then by optional second key. Memory is
+    /// reused between searches: clear does not free buffers.
+    /////////////////////////////////////////////////////////////////////
+    class IndexedHeap
+    {
+    public:
+        enum : uint32_t { NOT_IN_HEAP = UINT32_MAX };
+
+        /////////////////////////////////////////////////////////////////////
+        /// reset - prepare heap for nodes with indices in [0, count)
+        ///
+        /// @param count - number of nodes
+        /////////////////////////////////////////////////////////////////////
+        void reset (size_t count)
+        {
+            if (m_position.size () < count)
+                m_position.resize (count, uint32_t (NOT_IN_HEAP));
+
+            clear ();
+        }
+
+        /////////////////////////////////////////////////////////////////////
+        /// clear - remove all nodes from heap
+        /////////////////////////////////////////////////////////////////////
+        void clear ()
+        {
+            for (const Entry& entry : m_heap)
+                m_position[entry.node] = NOT_IN_HEAP;
+            m_heap.clear ();
+        }
+
+        bool empty () const
+        {
+            return m_heap.empty ();
+        }
+
+        size_t size () const
+        {
+            return m_heap.size ();
+        }
+
+        bool contains (uint32_t node) const
+        {
+            return node < m_position.size () && m_position[node] != NOT_IN_HEAP;
+        }
+
+        uint32_t top () const
+        {
+            return m_heap.front ().node;
+        }
+
+        float topKey () const
+        {
+            return m_heap.front ().key;
+        }
+
+        float topSecondKey () const
+        {
+            return m_heap.front ().second_key;
+        }
+
+        float getKey (uint32_t node) const
+        {
+            return m_heap[m_position[node]].key;
+        }
+
+        /////////////////////////////////////////////////////////////////////
+        /// push - insert node or update its key
+        ///
+        /// @param node - index of node
+        /// @param key - priority of node
+        /// @param second_key - priority of node among nodes with equal keys
+        /////////////////////////////////////////////////////////////////////
+        void push (uint32_t node, float key, float second_key = 0.0f)
+        {
+            if (contains (node))
+            {
+                update (node, key, second_key);
+                return;
+            }
+
+            m_position[node] = static_cast<uint32_t> (m_heap.size ());
+            m_heap.push_back ({ node, key, second_key });
+            siftUp (m_heap.size () - 1);
+        }
+
+        /////////////////////////////////////////////////////////////////////
+        /// update - change key of node which is stored in heap
+        ///
+        /// @param node - index of node
+        /// @param key - new priority of node
+        /// @param second_key - new priority among nodes with equal keys
+        /////////////////////////////////////////////////////////////////////
+        void update (uint32_t node, float key, float second_key = 0.0f)
+        {
+            size_t pos (m_position[node]);
+            Entry old_entry (m_heap[pos]);
+            m_heap[pos].key = key;
+            m_heap[pos].second_key = second_key;
+
+            if (less (m_heap[pos], old_entry))
+                siftUp (pos);
+            else
+                siftDown (pos);
+        }
+
+        /////////////////////////////////////////////////////////////////////
+        /// pop - remove node with the smallest key
+        ///
+        /// @return - index of removed node
+        /////////////////////////////////////////////////////////////////////
+        uint32_t pop ()
+        {
+            uint32_t node (m_heap.front ().node);
+            erase (node);
+            return node;
+        }
+
+        /////////////////////////////////////////////////////////////////////
+        /// erase - remove node from any place of heap
+        ///
+        /// @param node - index of node
+        /////////////////////////////////////////////////////////////////////
+        void erase (uint32_t node)
+        {
+            size_t pos (m_position[node]);
+            m_position[node] = NOT_IN_HEAP;
+
+            if (pos + 1 == m_heap.size ())
+            {
+                m_heap.pop_back ();
+                return;
+            }
+
+            Entry old_entry (m_heap[pos]);
+            m_heap[pos] = m_heap.back ();
+            m_heap.pop_back ();
+            m_position[m_heap[pos].node] = static_cast<uint32_t> (pos);
+
+            if (less (m_heap[pos], old_entry))
+                siftUp (pos);
+            else
+                siftDown (pos);
+        }
+
+    private:
+        struct Entry
+        {
+            uint32_t node;
+            float key;
+            float second_key;
+        };
+
+        // Equal keys are ordered by node index, so ties are resolved
+        // identically by every search over the same graph.
+        static bool less (const Entry& a, const Entry& b)
+        {
+            if (a.key != b.key)
+                return a.key < b.key;
+            if (a.second_key != b.second_key)
+                return a.second_key < b.second_key;
+            return a.node < b.node;
+        }
+
+        void siftUp (size_t pos)
+        {
+            Entry entry (m_heap[pos]);
+            while (pos > 0)
+            {
+                size_t parent ((pos - 1) / 2);
+                if (!less (entry, m_heap[parent]))
+                    break;
+
+                m_heap[pos] = m_heap[parent];
+                m_position[m_heap[pos].node] = static_cast<uint32_t> (pos);
+                pos = parent;
+            }
+            m_heap[pos] = entry;
+            m_position[entry.node] = static_cast<uint32_t> (pos);
+        }
+
+        void siftDown (size_t pos)
+        {
+            Entry entry (m_heap[pos]);
+            size_t count (m_heap.size ());
+            while (true)
+            {
+                size_t child (pos * 2 + 1);
+                if (child >= count)
+                    break;
+
+                if (child + 1 < count && less (m_heap[child + 1], m_heap[child]))
+                    ++child;
+
+                if (!less (m_heap[child], entry))
+                    break;
+
+                m_heap[pos] = m_heap[child];
+                m_position[m_heap[pos].node] = static_cast<uint32_t> (pos);
+                pos = child;
+            }
+            m_heap[pos] = entry;
+            m_position[entry.node] = static_cast<uint32_t> (pos);
+        }
+
+    private:
+        std::vector<Entry> m_heap;
+        std::vector<uint32_t> m_position;
+    };
+
+
+}
@@ -66,6 +66,28 @@ namespace sfge
             m_reactions[id_action] = action;
         }
 
+        /////////////////////////////////////////////////////////////////////
+        /// getMovement - find how object would be moved by vector
+        ///
+        /// Object itself isn't moved, so movements of many objects can be
+        /// found in parallel.
+        ///
+        /// @param vector - movement
+        /// @param hit - true if object hits obstacle
+        ///
+        /// @return - displacement of object after stops and slides
+        /////////////////////////////////////////////////////////////////////
+        Vector2f getMovement (Vector2f vector, bool& hit) const;
+
+        /////////////////////////////////////////////////////////////////////
+        /// move - move object and stop it before obstacles
+        ///
+        /// Path of object is swept, so fast object can't pass through thin
+        /// obstacle. Object which hits obstacle slides along it by the rest
+        /// of vector and runs CollisionAction.
+        ///
+        /// @param vector - movement
+        /////////////////////////////////////////////////////////////////////
         void move (Vector2f vector);
 
     private:
@@ -0,0 +1,96 @@
+/////////////////////////////////////////////////////////////////////
+//
+// SFGE - Simple and Fast Game Engine
+//
+// Copyright (c) 2016-2017 DonRumata710 
+// 
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation
+// files (the "Software"), to deal in the Software without
+// restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+// WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+// 
+/////////////////////////////////////////////////////////////////////
+
+
+#pragma once
+
+
+#include "IndexedHeap.h"
+
+#include <SFML/System/Vector2.hpp>
+
+#include <vector>
+#include <cstdint>
+
+
+namespace sfge
+{
+
+
+    using sf::Vector2i;
+
+    class WalkabilityGrid;
+
+
+    /////////////////////////////////////////////////////////////////////
+    /// JumpPointSearch - search of the shortest way over walkability grid
+    ///
+    /// Objects move in 8 directions and can't cut corners of blocked
+    /// cells. Straight and diagonal runs without branches are skipped
+    /// by jumps, so only few cells are placed into open list. Scratch
+    /// buffers are kept between searches.
+    /////////////////////////////////////////////////////////////////////
+    class JumpPointSearch
+    {
+    public:
+        /////////////////////////////////////////////////////////////////////
+        /// findPath - find the shortest way between two cells
+        ///
+        /// @param grid - walkability grid
+        /// @param departure - departure cell
+        /// @param target - target cell
+        /// @param path - jump points from departure to target, both
+        /// included; cells between them lie on straight or diagonal lines
+        ///
+        /// @return - true if way was found, false otherwise
+        /////////////////////////////////////////////////////////////////////
+        bool findPath (const WalkabilityGrid& grid, Vector2i departure, Vector2i target, std::vector<Vector2i>& path);
+
+    private:
+        void getDirections (const WalkabilityGrid& grid, Vector2i cell, Vector2i parent, std::vector<Vector2i>& directions) const;
+
+        bool jump (const WalkabilityGrid& grid, Vector2i cell, Vector2i direction, Vector2i& jump_point) const;
+
+        bool jumpStraight (const WalkabilityGrid& grid, Vector2i cell, Vector2i direction, Vector2i& jump_point) const;
+
+        static float getDistance (Vector2i from, Vector2i to);
+
+    private:
+        IndexedHeap m_opened;
+        std::vector<float> m_costs;
+        std::vector<uint32_t> m_parents;
+        std::vector<uint32_t> m_visit_marks;
+        std::vector<uint32_t> m_close_marks;
+        std::vector<Vector2i> m_directions;
+        uint32_t m_generation = 0;
+
+        Vector2i m_target;
+    };
+
+
+}
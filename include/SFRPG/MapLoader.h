@@ -70,12 +70,15 @@ namespace sfge
         /// loadMap - load map
         ///
         /// @param map - map manager
-        /// @param path - path where description of map can be found
+        /// @param path - path where description of map can be found, it
+        /// may be a file of single sector in text or binary format
         /////////////////////////////////////////////////////////////////////
         bool loadMap (MapManager* map, const std::string& path);
 
     private:
-        const char* loadScript (const std::string& path);
+        bool loadScript (const std::string& path, std::vector<char>& script);
+
+        bool loadBinarySector (MapManager* manager, const std::string& path, const std::vector<char>& data);
 
         std::string parseMap (TextParser* tp, std::unordered_map<uint32_t, MapSectorDesc>*);
 
@@ -30,7 +30,16 @@
 #pragma once
 
 
+#include "AabbTree.h"
+#include "FlowField.h"
+#include "JumpPointSearch.h"
 #include "MapSectorDesc.h"
+#include "NavigationGraph.h"
+#include "PathFinder.h"
+#include "PortalGraph.h"
+#include "PathCache.h"
+#include "SectorIndex.h"
+#include "WalkabilityGrid.h"
 
 #include <SFML/System/Vector2.hpp>
 
@@ -39,6 +48,8 @@
 #include <vector>
 #include <unordered_map>
 #include <deque>
+#include <atomic>
+#include <utility>
 
 
 namespace sfge
@@ -47,12 +58,15 @@ namespace sfge
 
     using sf::Vector2f;
     using sf::Vector2i;
+    using sf::FloatRect;
     typedef sf::Rect<uint32_t> UintRect;
 
+    class InteractiveObject;
     class MapLoader;
     class MapSaver;
     class SectorLoader;
     class Way;
+    class WorkerPool;
 
 
     /////////////////////////////////////////////////////////////////////
@@ -60,6 +74,10 @@ namespace sfge
     /////////////////////////////////////////////////////////////////////
     class MapManager : public Drawable
     {
+        friend class MapSector;
+        friend class PathRequest;
+        friend class ReplanningPath;
+
     public:
 
         /////////////////////////////////////////////////////////////////////
@@ -106,12 +124,120 @@ namespace sfge
         /// lookMap - load all sectors which contain current areas
         ///
         /// This method describe the manager what sectors should be loaded to
-        /// the memory from resource files.
+        /// the memory from resource files. In streaming mode sectors are
+        /// only requested here and they appear on map after update.
         ///
         /// @param areas - areas on the  map
         /////////////////////////////////////////////////////////////////////
         void lookMap (const std::vector<UintRect>& areas);
 
+        /////////////////////////////////////////////////////////////////////
+        /// lookMap - load sectors of areas and sectors ahead of movement
+        ///
+        /// Every area is stretched by distance which is passed with velocity
+        /// during prefetch time. Sectors of areas themselves are requested
+        /// before prefetched ones.
+        ///
+        /// @param areas - areas on the map
+        /// @param velocity - movement of areas in units per second
+        /////////////////////////////////////////////////////////////////////
+        void lookMap (const std::vector<UintRect>& areas, Vector2f velocity);
+
+        /////////////////////////////////////////////////////////////////////
+        /// setStreaming - enable or disable loading of sectors in background
+        ///
+        /// In streaming mode files of sectors are read and parsed on worker
+        /// threads, so lookMap never waits for loading.
+        ///
+        /// @param enable - true to load sectors in background
+        /////////////////////////////////////////////////////////////////////
+        void setStreaming (bool enable);
+
+        bool isStreaming () const;
+
+        /////////////////////////////////////////////////////////////////////
+        /// setPrefetchTime - set how far ahead of movement sectors are loaded
+        ///
+        /// @param time - time in seconds
+        /////////////////////////////////////////////////////////////////////
+        void setPrefetchTime (float time);
+
+        float getPrefetchTime () const;
+
+        /////////////////////////////////////////////////////////////////////
+        /// update - add sectors which were loaded in background to the map
+        ///
+        /// Method should be called once per frame on the thread which owns
+        /// the map, so sectors appear only between frames.
+        ///
+        /// @param wait - wait for all requested sectors before adding them
+        ///
+        /// @return - number of added sectors
+        /////////////////////////////////////////////////////////////////////
+        size_t update (bool wait = false);
+
+        /////////////////////////////////////////////////////////////////////
+        /// getStreamedSectors - get number of sectors which are being loaded
+        /// in background or wait for update
+        ///
+        /// @return - number of sectors
+        /////////////////////////////////////////////////////////////////////
+        size_t getStreamedSectors () const;
+
+        /////////////////////////////////////////////////////////////////////
+        /// setSaver - set saver of changed sectors which are unloaded
+        ///
+        /// @param saver - pointer to saver
+        /////////////////////////////////////////////////////////////////////
+        void setSaver (std::unique_ptr<MapSaver>&& saver);
+
+        /////////////////////////////////////////////////////////////////////
+        /// setMemoryBudget - set max number of bytes held by loaded sectors
+        ///
+        /// When budget is exceeded, sectors which weren't looked at by the
+        /// last lookMap are unloaded: least recently looked ones first and
+        /// the farthest from view among them. Sectors with interactive
+        /// objects stay loaded. Changed sectors and sectors without path
+        /// are saved before unloading, they are kept if there is no saver
+        /// or saving fails. Zero budget disables unloading.
+        ///
+        /// @param bytes - number of bytes
+        /////////////////////////////////////////////////////////////////////
+        void setMemoryBudget (size_t bytes);
+
+        size_t getMemoryBudget () const;
+
+        /////////////////////////////////////////////////////////////////////
+        /// getResidentSectors - get number of loaded sectors
+        ///
+        /// @return - number of sectors
+        /////////////////////////////////////////////////////////////////////
+        size_t getResidentSectors () const;
+
+        /////////////////////////////////////////////////////////////////////
+        /// getResidentBytes - get approximate number of bytes held by loaded
+        /// sectors
+        ///
+        /// @return - number of bytes
+        /////////////////////////////////////////////////////////////////////
+        size_t getResidentBytes () const;
+
+        /////////////////////////////////////////////////////////////////////
+        /// getEvictedSectors - get number of sectors unloaded to fit budget
+        /// since description of map was set
+        ///
+        /// @return - number of sectors
+        /////////////////////////////////////////////////////////////////////
+        uint64_t getEvictedSectors () const;
+
+        /////////////////////////////////////////////////////////////////////
+        /// getSavedSectors - get number of changed sectors saved before
+        /// unloading since description of map was set
+        ///
+        /// @return - number of sectors
+        /////////////////////////////////////////////////////////////////////
+        uint64_t getSavedSectors () const;
+
         /////////////////////////////////////////////////////////////////////
         /// save - save map
         ///
@@ -131,10 +257,215 @@ namespace sfge
         ///
         /// @param departure - departure point
         /// @param target - target point
+        /// @param smooth - remove points which can be skipped by straight
+        /// movement without crossing obstacles
+        ///
+        /// Way points of departure and target are checked to be placed in
+        /// one connected component before search, so unreachable target
+        /// is rejected without search.
+        ///
+        /// @return way from one point to another or empty way if there is
+        /// no path
+        /////////////////////////////////////////////////////////////////////
+        Way getWay (Vector2f departure, Vector2f target, bool smooth = false) const;
+
+        /////////////////////////////////////////////////////////////////////
+        /// getWays - find ways for many pairs of points
+        ///
+        /// Ways are searched in parallel on worker threads. Navigation
+        /// graph is frozen while ways are searched: any attempt to change
+        /// edges of way points throws std::logic_error. Result for every
+        /// pair is the same as result of getWay.
+        ///
+        /// @param queries - pairs of departure and target points
+        /// @param smooth - smooth found ways like getWay does
+        ///
+        /// @return ways in the same order as queries
+        /////////////////////////////////////////////////////////////////////
+        std::vector<Way> getWays (const std::vector<std::pair<Vector2f, Vector2f>>& queries, bool smooth = false) const;
+
+        /////////////////////////////////////////////////////////////////////
+        /// getGridWay - find way over tiles of loaded sectors
+        ///
+        /// Tiles covered by objects are blocked, way points aren't used.
+        /// Way is searched by jump point search and contains only points
+        /// where direction of movement changes.
+        ///
+        /// @param departure - departure point
+        /// @param target - target point
+        ///
+        /// @return way from one point to another or empty way if there is
+        /// no path
+        /////////////////////////////////////////////////////////////////////
+        Way getGridWay (Vector2f departure, Vector2f target) const;
+
+        /////////////////////////////////////////////////////////////////////
+        /// isNavigationFrozen - check are edges of way points read-only now
+        ///
+        /// @return - true if batch of ways is being searched
+        /////////////////////////////////////////////////////////////////////
+        bool isNavigationFrozen () const;
+
+        /////////////////////////////////////////////////////////////////////
+        /// checkPass - check that segment doesn't cross objects of loaded
+        /// sectors
+        ///
+        /// @param p1 - the first point of segment
+        /// @param p2 - the second point of segment
+        ///
+        /// @return - true if there are no obstacles between points
+        /////////////////////////////////////////////////////////////////////
+        bool checkPass (Vector2f p1, Vector2f p2) const;
+
+        /////////////////////////////////////////////////////////////////////
+        /// checkPass - check many segments against objects of loaded sectors
         ///
-        /// @return way from one point to another
+        /// Useful for line of sight checks of many objects at once.
+        ///
+        /// @param segments - segments
+        /// @param blocked - bit i is set if segment i crosses any object
         /////////////////////////////////////////////////////////////////////
-        Way getWay (Vector2f departure, Vector2f target) const;
+        void checkPass (const std::vector<Segment>& segments, std::vector<uint64_t>& blocked) const;
+
+        /////////////////////////////////////////////////////////////////////
+        /// queryRect - find objects of loaded sectors in rectangle
+        ///
+        /// @param rect - rectangle
+        ///
+        /// @return - objects which bounds intersect rectangle
+        /////////////////////////////////////////////////////////////////////
+        std::vector<MapObject*> queryRect (const FloatRect& rect) const;
+
+        /////////////////////////////////////////////////////////////////////
+        /// queryRadius - find objects of loaded sectors near point
+        ///
+        /// @param center - center of circle
+        /// @param radius - radius of circle
+        ///
+        /// @return - objects which polygons are not farther than radius
+        /////////////////////////////////////////////////////////////////////
+        std::vector<MapObject*> queryRadius (Vector2f center, float radius) const;
+
+        /////////////////////////////////////////////////////////////////////
+        /// raycast - find the first object of loaded sectors on segment
+        ///
+        /// @param p1 - the first point of segment
+        /// @param p2 - the second point of segment
+        /// @param hit - point where segment enters object
+        ///
+        /// @return - the closest object to p1 or nullptr if segment is free
+        /////////////////////////////////////////////////////////////////////
+        MapObject* raycast (Vector2f p1, Vector2f p2, Vector2f& hit) const;
+
+        /////////////////////////////////////////////////////////////////////
+        /// requestMove - add movement of object to the next step
+        ///
+        /// Vectors of many requests for one object are summed. Request is
+        /// dropped if object is removed from map before step.
+        ///
+        /// @param object - object of loaded sector
+        /// @param vector - movement
+        /////////////////////////////////////////////////////////////////////
+        void requestMove (InteractiveObject* object, Vector2f vector);
+
+        /////////////////////////////////////////////////////////////////////
+        /// step - move all objects which requested movement
+        ///
+        /// Movements are found in parallel against positions of objects at
+        /// start of step, then they are applied in order of requests. Object
+        /// which would overlap object moved earlier in the same step stays
+        /// on its place. CollisionAction of objects which hit obstacles is
+        /// run after all objects are moved, so result of step doesn't depend
+        /// on number of threads.
+        /////////////////////////////////////////////////////////////////////
+        void step ();
+
+        /////////////////////////////////////////////////////////////////////
+        /// getPendingMoves - get number of objects which requested movement
+        ///
+        /// @return - number of objects
+        /////////////////////////////////////////////////////////////////////
+        size_t getPendingMoves () const;
+
+        /////////////////////////////////////////////////////////////////////
+        /// setHierarchicalSearch - enable or disable hierarchical search
+        ///
+        /// In hierarchical mode way is searched over portals between
+        /// sectors first and then it is refined only inside sectors of
+        /// found corridor. Found ways may be a bit longer than optimal ones.
+        /// Cached ways are dropped when mode is changed.
+        ///
+        /// @param enable - true to enable hierarchical search
+        /////////////////////////////////////////////////////////////////////
+        void setHierarchicalSearch (bool enable);
+
+        /////////////////////////////////////////////////////////////////////
+        /// isHierarchicalSearch - check is hierarchical search enabled
+        ///
+        /// @return - true if hierarchical search is enabled
+        /////////////////////////////////////////////////////////////////////
+        bool isHierarchicalSearch () const;
+
+        /////////////////////////////////////////////////////////////////////
+        /// getPathCache - get cache of found ways
+        ///
+        /// Cache can be resized and its hit and miss counters can be read
+        /// through returned reference.
+        ///
+        /// @return - cache of ways
+        /////////////////////////////////////////////////////////////////////
+        PathCache& getPathCache ();
+
+        const PathCache& getPathCache () const;
+
+        /////////////////////////////////////////////////////////////////////
+        /// updateSector - notify manager that obstacles of sector were changed
+        ///
+        /// Only edges of way points which cross changed area are checked
+        /// again, including edges to neighbour sectors. Navigation and
+        /// portal graphs are updated for changed edges without rebuild.
+        ///
+        /// @param sector - changed sector
+        /// @param area - area where obstacles were changed
+        /////////////////////////////////////////////////////////////////////
+        void updateSector (MapSector* sector, const FloatRect& area);
+
+        /////////////////////////////////////////////////////////////////////
+        /// getFlowStep - get next point of way to goal from flow field
+        ///
+        /// Flow field of goal is computed once and cached, so every next
+        /// step of all objects which move to the same goal is found in
+        /// constant time. Cached fields are dropped when obstacles of
+        /// covered sectors are changed.
+        ///
+        /// @param position - current position
+        /// @param goal - goal point
+        /// @param step - center of next way point or goal itself if
+        /// position is placed in area of goal way point
+        ///
+        /// @return - false if goal can't be reached from position
+        /////////////////////////////////////////////////////////////////////
+        bool getFlowStep (Vector2f position, Vector2f goal, Vector2f& step) const;
+
+        /////////////////////////////////////////////////////////////////////
+        /// getFlowField - get flow field of goal
+        ///
+        /// @param goal - goal point
+        ///
+        /// @return - flow field or nullptr if goal is outside of loaded sectors
+        /////////////////////////////////////////////////////////////////////
+        std::shared_ptr<const FlowField> getFlowField (Vector2f goal) const;
+
+        /////////////////////////////////////////////////////////////////////
+        /// setFlowFieldCapacity - set max number of cached flow fields
+        ///
+        /// Zero capacity disables cache.
+        ///
+        /// @param capacity - max number of flow fields
+        /////////////////////////////////////////////////////////////////////
+        void setFlowFieldCapacity (size_t capacity);
+
+        size_t getFlowFieldCapacity () const;
 
         /////////////////////////////////////////////////////////////////////
         /// getSector - get sector of current point
@@ -146,24 +477,130 @@ namespace sfge
         MapSector* getSector (Vector2f position);
 
     private:
+        struct SearchContext
+        {
+            PathFinder path_finder;
+            PortalGraph::Search portal_search;
+            std::vector<uint32_t> path;
+            std::vector<uint32_t> corridor;
+        };
+
+        struct PendingMove
+        {
+            InteractiveObject* object;
+            Vector2f vector;
+            Vector2f movement;
+            bool hit;
+        };
+
+        struct FlowFieldEntry
+        {
+            std::shared_ptr<const FlowField> field;
+            uint64_t last_use;
+        };
+
         void setOffset (int32_t x, int32_t y);
 
-        void findWayPointsEdges (MapSector* sector);
+        void findSectors (const UintRect& area, std::vector<uint32_t>& sector_ids) const;
+
+        void touchSectors (const UintRect& area);
+
+        void evictSectors ();
+
+        bool unloadSector (uint32_t id);
+
+        UintRect getPrefetchArea (const UintRect& area, Vector2f velocity) const;
+
+        void insertObject (MapObject* object);
+
+        void removeObject (const MapObject* object);
+
+        void moveObject (const MapObject* object);
 
-        std::deque<Vector2f> findWay (const WayPointID& departure, const WayPointID& target) const;
+        void growObjectMargin (const FloatRect& bounds);
 
-        static float getDistance (Vector2f p1, Vector2f p2);
+        void findWayPointsEdges (const std::vector<uint32_t>& sectors);
 
-        static Vector2f getWayStep (const WayPoint* p1, const WayPoint* p2);
+        void findSegmentSectors (Vector2f p1, Vector2f p2, std::vector<uint32_t>& sector_ids) const;
+
+        void invalidateWays (const std::vector<uint32_t>& sectors);
+
+        void invalidateSector (uint32_t id);
+
+        void updateNavigation ();
+
+        void updateNavigation (const std::vector<const WayPoint*>& points, const std::vector<uint32_t>& sectors);
+
+        void updateWalkability () const;
+
+        void checkNavigationFrozen () const;
+
+        WayPointID findWayPoint (Vector2f position) const;
+
+        bool findWay (const WayPointID& departure, const WayPointID& target, std::deque<Vector2f>& points) const;
+
+        bool searchWay (
+            uint32_t departure,
+            uint32_t target,
+            SearchContext& context,
+            std::deque<Vector2f>& points,
+            std::vector<uint32_t>& sectors
+        ) const;
+
+        std::shared_ptr<const FlowField> findFlowField (const WayPointID& goal) const;
+
+        void evictFlowFields (size_t count) const;
+
+        void fillWay (const std::vector<uint32_t>& path, std::deque<Vector2f>& points, std::vector<uint32_t>& sectors) const;
+
+        void smoothWay (Vector2f departure, std::deque<Vector2f>& points) const;
+
+        static Vector2f getWayStep (Vector2f start, Vector2f end, float radius);
 
         virtual void draw (RenderTarget& target, RenderStates states) const override;
 
     private:
         std::string m_name = "map";
         std::unique_ptr<SectorLoader> m_loader;
+        bool m_streaming = false;
+        float m_prefetch_time = 1.0f;
+        std::unique_ptr<MapSaver> m_saver;
         std::unordered_map<uint32_t, MapSectorDesc> m_sectors;
+        SectorIndex m_sector_index;
         std::string m_map_path;
         Vector2i m_offset;
+
+        size_t m_memory_budget = 0;
+        uint64_t m_look_count = 0;
+        std::unordered_map<uint32_t, uint64_t> m_sector_uses;
+        uint64_t m_evicted_sectors = 0;
+        uint64_t m_saved_sectors = 0;
+
+        AabbTree m_object_tree;
+        float m_object_margin = 0.0f;
+        std::unordered_map<const MapObject*, uint32_t> m_object_proxies;
+
+        std::vector<PendingMove> m_pending_moves;
+        std::unordered_map<const MapObject*, size_t> m_pending_ids;
+
+        NavigationGraph m_navigation;
+        PortalGraph m_portals;
+        bool m_hierarchical_search = false;
+
+        mutable SearchContext m_search;
+        mutable PathCache m_path_cache;
+
+        mutable WalkabilityGrid m_walkability;
+        mutable JumpPointSearch m_jump_point_search;
+        mutable bool m_walkability_changed = true;
+
+        mutable std::unordered_map<uint64_t, FlowFieldEntry> m_flow_fields;
+        mutable uint64_t m_flow_field_uses = 0;
+        size_t m_flow_field_capacity = 16;
+
+        mutable std::unique_ptr<WorkerPool> m_workers;
+        mutable std::vector<SearchContext> m_batch_search;
+        mutable std::atomic<bool> m_navigation_frozen { false };
     };
 
 
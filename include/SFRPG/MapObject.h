@@ -67,6 +67,10 @@ namespace sfge
 
         void setCollision (const Collision& collision);
 
+        const Collision& getCollision () const;
+
+        FloatRect getBounds () const;
+
         Collision::State detectCollision (const MapObject* object) const;
 
         Collision::State detectCollision (const Vector2f p1, const Vector2f p2) const;
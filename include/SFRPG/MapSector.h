@@ -31,12 +31,15 @@
 
 
 #include "MapObject.h"
+#include "UniformGrid.h"
+#include "WalkabilityGrid.h"
 #include "WayPoint.h"
 
 #include <SFGE/Panel.h>
 
 #include <SFML/Graphics/Drawable.hpp>
 
+#include <unordered_map>
 #include <unordered_set>
 
 
@@ -50,9 +53,11 @@ namespace sfge
     using sf::Drawable;
 
     class MapManager;
-    class MapSaver;
     class InteractiveObject;
     class Way;
+    struct SectorData;
+
+    typedef std::pair<Vector2f, Vector2f> Segment;
 
 
     /////////////////////////////////////////////////////////////////////
@@ -74,12 +79,17 @@ namespace sfge
 
         /////////////////////////////////////////////////////////////////////
         /// Destructor
+        ///
+        /// Objects which are held outside of sector are detached from it.
         /////////////////////////////////////////////////////////////////////
-        ~MapSector () = default;
+        ~MapSector ();
 
         /////////////////////////////////////////////////////////////////////
         /// setMapManager - set manager of map where this sector placed
         ///
+        /// Objects of sector are moved from object tree of previous
+        /// manager to the tree of new one.
+        ///
         /// @param manager - map manager
         /////////////////////////////////////////////////////////////////////
         void setMapManager (MapManager* manager);
@@ -91,6 +101,8 @@ namespace sfge
         /////////////////////////////////////////////////////////////////////
         void setTileSize (Uint32 size);
 
+        Uint32 getTileSize () const;
+
         /////////////////////////////////////////////////////////////////////
         /// setTiles - set tiles to sector
         ///
@@ -98,6 +110,17 @@ namespace sfge
         /////////////////////////////////////////////////////////////////////
         void setTiles (const std::vector<std::pair<uint32_t, std::string>>& tiles);
 
+        /////////////////////////////////////////////////////////////////////
+        /// setTiles - set tiles to sector from palette of textures
+        ///
+        /// Every texture of palette is found once, so it is cheaper than
+        /// setting of tiles one by one.
+        ///
+        /// @param palette - names of textures, the first one means no texture
+        /// @param tiles - index in palette for every tile, row by row
+        /////////////////////////////////////////////////////////////////////
+        void setTiles (const std::vector<std::string>& palette, const uint16_t* tiles);
+
         /////////////////////////////////////////////////////////////////////
         /// setTileTexture - set texture of tile
         /////////////////////////////////////////////////////////////////////
@@ -155,21 +178,79 @@ namespace sfge
         Vector2u getSize () const;
 
         /////////////////////////////////////////////////////////////////////
-        /// save - save static elements of sector
+        /// setModified - mark sector as changed since it was loaded or saved
+        ///
+        /// Tiles set by setTileTexture, way points set by setWayPoints and
+        /// objects attached or removed through sector mark it automatically,
+        /// moving objects don't.
         ///
-        /// @param saver - saver
+        /// @param modified - true if sector should be saved before unloading
         /////////////////////////////////////////////////////////////////////
-        bool save (MapSaver* saver);
+        void setModified (bool modified);
+
+        bool isModified () const;
+
+        /////////////////////////////////////////////////////////////////////
+        /// getMemoryUsage - get approximate number of bytes held by sector
+        ///
+        /// Tiles, objects, way points and indices are counted. Textures
+        /// belong to resource manager, so they aren't counted.
+        ///
+        /// @return - number of bytes
+        /////////////////////////////////////////////////////////////////////
+        size_t getMemoryUsage () const;
+
+        /////////////////////////////////////////////////////////////////////
+        /// getSectorData - get content of sector which is kept in its file
+        ///
+        /// Positions of way points and obstacles are relative to sector.
+        /// Interactive objects aren't static, so they aren't written.
+        ///
+        /// @param data - content of sector
+        /////////////////////////////////////////////////////////////////////
+        void getSectorData (SectorData& data) const;
 
         /////////////////////////////////////////////////////////////////////
         /// checkMovement - check can object stay on its new place or not
         ///
+        /// Only objects which bounds overlap bounds of moved object are
+        /// checked precisely. Object which left the sector is passed to
+        /// the sector where it is placed now.
+        ///
         /// @param object - map object
         ///
         /// @return - true if object can stay on its place, false otherwise
         /////////////////////////////////////////////////////////////////////
         bool checkMovement (InteractiveObject* object);
 
+        /////////////////////////////////////////////////////////////////////
+        /// sweepMovement - find the first obstacle on the way of object
+        ///
+        /// Objects of all loaded sectors which are near the path are
+        /// checked if manager is set, only objects of this sector otherwise.
+        /// Method doesn't change anything, so it can be called from many
+        /// threads while objects aren't moved.
+        ///
+        /// @param object - moved object, it is skipped
+        /// @param collision - polygon of object at start of movement
+        /// @param vector - movement of object
+        /// @param time - part of vector which object can pass
+        /// @param normal - unit normal of contact with obstacle
+        ///
+        /// @return - true if object hits obstacle
+        /////////////////////////////////////////////////////////////////////
+        bool sweepMovement (const MapObject* object, const Collision& collision, Vector2f vector, float& time, Vector2f& normal) const;
+
+        /////////////////////////////////////////////////////////////////////
+        /// passObject - pass object to sector where it is placed now
+        ///
+        /// @param object - moved object of this sector
+        ///
+        /// @return - sector of object or nullptr if object left loaded
+        /// part of map
+        /////////////////////////////////////////////////////////////////////
+        MapSector* passObject (InteractiveObject* object);
+
         /////////////////////////////////////////////////////////////////////
         /// getNearestWayPoint - get nearest to position way point
         ///
@@ -179,6 +260,17 @@ namespace sfge
         /////////////////////////////////////////////////////////////////////
         uint32_t getNearestWayPoint (Vector2f pos) const;
 
+        /////////////////////////////////////////////////////////////////////
+        /// getWayPointsInRadius - get way points which centers are placed
+        /// near position
+        ///
+        /// @param pos - position on map
+        /// @param radius - max distance from position
+        ///
+        /// @return - sorted ids of way points
+        /////////////////////////////////////////////////////////////////////
+        std::vector<uint32_t> getWayPointsInRadius (Vector2f pos, float radius) const;
+
         /////////////////////////////////////////////////////////////////////
         /// getWayPoint - get way point by id
         ///
@@ -188,6 +280,13 @@ namespace sfge
         /////////////////////////////////////////////////////////////////////
         const WayPoint* getWayPoint (uint32_t id) const;
 
+        /////////////////////////////////////////////////////////////////////
+        /// getWayPointsCount - get number of way points in sector
+        ///
+        /// @return - number of way points
+        /////////////////////////////////////////////////////////////////////
+        uint32_t getWayPointsCount () const;
+
         /////////////////////////////////////////////////////////////////////
         /// attachObject - attach new object to sector
         ///
@@ -204,6 +303,35 @@ namespace sfge
         /////////////////////////////////////////////////////////////////////
         void removeObject (const MapObject* object);
 
+        /////////////////////////////////////////////////////////////////////
+        /// hasInteractiveObjects - check are there objects which can move
+        /// by themselves
+        ///
+        /// @return - true if interactive object is attached to sector
+        /////////////////////////////////////////////////////////////////////
+        bool hasInteractiveObjects () const;
+
+        /////////////////////////////////////////////////////////////////////
+        /// updateObject - update bounds of moved object in broadphase
+        ///
+        /// Object is moved only between cells which were entered or left.
+        ///
+        /// @param object - map object
+        /////////////////////////////////////////////////////////////////////
+        void updateObject (const MapObject* object);
+
+        /////////////////////////////////////////////////////////////////////
+        /// getWalkability - get bitmap of tiles which aren't covered by
+        /// static objects
+        ///
+        /// Bitmap is built on the first call and then it is updated when
+        /// objects are attached or removed. Interactive objects move, so
+        /// they never block tiles.
+        ///
+        /// @return - walkability grid with one cell per tile
+        /////////////////////////////////////////////////////////////////////
+        const WalkabilityGrid& getWalkability () const;
+
         /////////////////////////////////////////////////////////////////////
         /// isObjectInSector - check is object placed in this sector or not
         ///
@@ -213,6 +341,40 @@ namespace sfge
         /////////////////////////////////////////////////////////////////////
         bool isObjectInSector (Vector2f pos) const;
 
+        /////////////////////////////////////////////////////////////////////
+        /// checkPass - check that segment doesn't cross objects of sector
+        ///
+        /// @param p1 - the first point of segment
+        /// @param p2 - the second point of segment
+        ///
+        /// @return - true if there are no obstacles between points
+        /////////////////////////////////////////////////////////////////////
+        bool checkPass (Vector2f p1, Vector2f p2) const;
+
+        /////////////////////////////////////////////////////////////////////
+        /// checkPass - check that segment doesn't cross objects of sector
+        ///
+        /// @param p1 - the first point of segment
+        /// @param p2 - the second point of segment
+        /// @param candidates - buffer for ids of objects which are checked
+        ///
+        /// @return - true if there are no obstacles between points
+        /////////////////////////////////////////////////////////////////////
+        bool checkPass (Vector2f p1, Vector2f p2, std::vector<uint32_t>& candidates) const;
+
+        /////////////////////////////////////////////////////////////////////
+        /// checkPass - check many segments against objects of sector
+        ///
+        /// Edges of objects are kept in flat arrays. Candidate objects of all
+        /// segments are collected first, then every candidate is checked
+        /// against all its segments at once without calls to objects.
+        /// Result is the same as result of checkPass for every segment.
+        ///
+        /// @param segments - segments
+        /// @param blocked - bit i is set if segment i crosses any object
+        /////////////////////////////////////////////////////////////////////
+        void checkPass (const std::vector<Segment>& segments, std::vector<uint64_t>& blocked) const;
+
         /////////////////////////////////////////////////////////////////////
         /// connectWayPoints - create connections between way points of this sector
         /////////////////////////////////////////////////////////////////////
@@ -221,10 +383,65 @@ namespace sfge
         /////////////////////////////////////////////////////////////////////
         /// connectWayPoints - create connections between way points of two sectors
         ///
+        /// Only border way points of both sectors are compared. Found edges
+        /// are added to existing edges of way points.
+        ///
         /// @param map_sector - another sector
         /////////////////////////////////////////////////////////////////////
         void connectWayPoints (MapSector* map_sector);
 
+        /////////////////////////////////////////////////////////////////////
+        /// disconnectWayPoints - remove edges from way points of this sector
+        /// to way points of another sector
+        ///
+        /// Edges of another sector aren't changed.
+        ///
+        /// @param map_sector - another sector
+        /////////////////////////////////////////////////////////////////////
+        void disconnectWayPoints (const MapSector* map_sector);
+
+        /////////////////////////////////////////////////////////////////////
+        /// updateEdges - check again connections between way points of this
+        /// sector which segments cross area
+        ///
+        /// Edges are added or removed according to current obstacles, other
+        /// edges are kept. Only way points which are hidden by area from
+        /// each other are compared, they are found through index.
+        ///
+        /// @param area - area where obstacles were changed
+        /// @param changed - way points which edges were changed are added here
+        /////////////////////////////////////////////////////////////////////
+        void updateEdges (const FloatRect& area, std::vector<const WayPoint*>& changed);
+
+        /////////////////////////////////////////////////////////////////////
+        /// updateEdges - check again connections between border way points
+        /// of two sectors which segments cross area
+        ///
+        /// @param map_sector - another sector
+        /// @param area - area where obstacles were changed
+        /// @param changed - way points of both sectors which edges were
+        /// changed are added here
+        /////////////////////////////////////////////////////////////////////
+        void updateEdges (MapSector* map_sector, const FloatRect& area, std::vector<const WayPoint*>& changed);
+
+        /////////////////////////////////////////////////////////////////////
+        /// setBorderWidth - set width of sector border
+        ///
+        /// Way point is a border one if its area is closer to the edge of
+        /// sector than this width. Only border way points are connected
+        /// with way points of neighbour sectors.
+        ///
+        /// @param width - width of border
+        /////////////////////////////////////////////////////////////////////
+        void setBorderWidth (float width);
+
+        /////////////////////////////////////////////////////////////////////
+        /// getBorderWayPoints - get ids of border way points
+        ///
+        /// @return - ids of way points
+        /////////////////////////////////////////////////////////////////////
+        std::vector<uint32_t> getBorderWayPoints () const;
+
         /////////////////////////////////////////////////////////////////////
         /// attachNeighbours - find way points which has visual contack with current way point
         ///
@@ -235,7 +452,25 @@ namespace sfge
     private:
         virtual void draw (RenderTarget& target, RenderStates states) const override;
 
-        bool checkPass (Vector2f p1, Vector2f p2) const;
+        static bool isObstacle (const MapObject* object);
+
+        void checkNavigationFrozen () const;
+
+        void placeTexture (Uint32 pos, const std::shared_ptr<const Texture>& texture);
+
+        FloatRect getWayPointsArea () const;
+
+        void indexWayPoints ();
+
+        void indexObject (const MapObject* object);
+
+        void unindexObject (const MapObject* object);
+
+        void transferObject (InteractiveObject* object, MapSector* map_sector);
+
+        void updateObstacleEdges () const;
+
+        void setObstacleEdges (uint32_t id) const;
 
     private:
         MapManager* m_manager;
@@ -244,12 +479,32 @@ namespace sfge
         std::vector<Panel> m_tiles;
         std::vector<std::shared_ptr<MapObject>> m_objects;
 
+        UniformGrid m_object_index;
+        std::vector<const MapObject*> m_indexed_objects;
+        std::vector<FloatRect> m_object_bounds;
+        std::vector<uint32_t> m_free_object_ids;
+        std::vector<uint32_t> m_movement_candidates;
+
+        // Edges of indexed objects in coordinates of map, one range per id
+        mutable std::vector<float> m_edge_xs;
+        mutable std::vector<float> m_edge_ys;
+        mutable std::vector<std::pair<uint32_t, uint32_t>> m_edge_ranges;
+        mutable bool m_edges_changed = true;
+        std::unordered_map<const MapObject*, uint32_t> m_object_ids;
+
+        mutable WalkabilityGrid m_walkability;
+        mutable bool m_walkability_built = false;
+
         std::vector<WayPoint> m_way_points;
+        UniformGrid m_way_point_index;
 
         Vector2f m_offset;
         Vector2u m_size;
 
         Uint32 m_tile_size = 0;
+        float m_border_width = 0.0f;
+
+        bool m_modified = false;
 
         std::string m_name;
     };
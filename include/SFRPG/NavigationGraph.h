@@ -0,0 +1,239 @@
+/////////////////////////////////////////////////////////////////////
+//
+// SFGE - Simple and Fast Game Engine
+//
+// Copyright (c) 2016-2017 DonRumata710 
+// 
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation
+// files (the "Software"), to deal in the Software without
+// restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+// WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+// 
+/////////////////////////////////////////////////////////////////////
+
+
+#pragma once
+
+
+#include "MapSectorDesc.h"
+#include "WayPoint.h"
+
+#include <SFML/System/Vector2.hpp>
+
+#include <unordered_map>
+#include <vector>
+#include <utility>
+#include <cstdint>
+
+
+namespace sfge
+{
+
+
+    using sf::Vector2f;
+
+
+    /////////////////////////////////////////////////////////////////////
+    /// NavigationGraph - compact snapshot of way point graph
+    ///
+    /// Way points of all loaded sectors get dense indices. Edges are
+    /// stored in compressed sparse rows: edges of node i are placed in
+    /// range [getEdgeBegin (i), getEdgeEnd (i)) of contiguous arrays.
+    /// Graph should be rebuilt or updated after edges of way points are
+    /// changed.
+    /////////////////////////////////////////////////////////////////////
+    class NavigationGraph
+    {
+    public:
+        enum : uint32_t { INVALID_NODE = UINT32_MAX };
+
+        /////////////////////////////////////////////////////////////////////
+        /// build - collect way points and edges of loaded sectors
+        ///
+        /// @param sectors - sectors of map
+        /////////////////////////////////////////////////////////////////////
+        void build (const std::unordered_map<uint32_t, MapSectorDesc>& sectors);
+
+        /////////////////////////////////////////////////////////////////////
+        /// updateEdges - read again edges of some way points
+        ///
+        /// Indices of nodes are kept, edges of other nodes are copied.
+        /// Way points should be placed in the same sectors which were used
+        /// for the last build.
+        ///
+        /// @param points - way points which edges were changed
+        ///
+        /// @return - false if some way point isn't found in graph, graph
+        /// should be rebuilt then
+        /////////////////////////////////////////////////////////////////////
+        bool updateEdges (const std::vector<const WayPoint*>& points);
+
+        /////////////////////////////////////////////////////////////////////
+        /// clear - remove all nodes and edges
+        /////////////////////////////////////////////////////////////////////
+        void clear ();
+
+        /////////////////////////////////////////////////////////////////////
+        /// move - shift positions of all nodes
+        ///
+        /// Edges and their costs aren't changed by shift, so version of
+        /// graph is kept and started searches stay valid.
+        ///
+        /// @param offset - shift
+        /////////////////////////////////////////////////////////////////////
+        void move (Vector2f offset);
+
+        /////////////////////////////////////////////////////////////////////
+        /// getNodeCount - get number of nodes in graph
+        ///
+        /// @return - number of nodes
+        /////////////////////////////////////////////////////////////////////
+        size_t getNodeCount () const;
+
+        /////////////////////////////////////////////////////////////////////
+        /// getVersion - get number of graph rebuilds
+        ///
+        /// Indices of nodes and edges are valid only while version is
+        /// the same.
+        ///
+        /// @return - version of graph
+        /////////////////////////////////////////////////////////////////////
+        uint32_t getVersion () const;
+
+        /////////////////////////////////////////////////////////////////////
+        /// getLayoutVersion - get version when indices of nodes were changed
+        ///
+        /// Rebuilds which change only edges keep indices of nodes.
+        ///
+        /// @return - version of graph
+        /////////////////////////////////////////////////////////////////////
+        uint32_t getLayoutVersion () const;
+
+        /////////////////////////////////////////////////////////////////////
+        /// getChangedNodes - get nodes which edges or positions were changed
+        /// after version
+        ///
+        /// @param version - version of graph which was seen by caller
+        /// @param nodes - sorted indices of changed nodes
+        ///
+        /// @return - false if changes are unknown because layout of nodes
+        /// was changed after version
+        /////////////////////////////////////////////////////////////////////
+        bool getChangedNodes (uint32_t version, std::vector<uint32_t>& nodes) const;
+
+        /////////////////////////////////////////////////////////////////////
+        /// getNode - get dense index of way point
+        ///
+        /// @param id - id of way point
+        ///
+        /// @return - index of node or INVALID_NODE if sector is not loaded
+        /////////////////////////////////////////////////////////////////////
+        uint32_t getNode (const WayPointID& id) const;
+
+        /////////////////////////////////////////////////////////////////////
+        /// getWayPointID - get id of way point which is placed in node
+        ///
+        /// @param node - index of node
+        ///
+        /// @return - id of way point
+        /////////////////////////////////////////////////////////////////////
+        WayPointID getWayPointID (uint32_t node) const;
+
+        uint32_t getSectorID (uint32_t node) const;
+
+        /////////////////////////////////////////////////////////////////////
+        /// getComponent - get label of connected component of node
+        ///
+        /// Nodes with different labels can't be connected by any way.
+        ///
+        /// @param node - index of node
+        ///
+        /// @return - label of component
+        /////////////////////////////////////////////////////////////////////
+        uint32_t getComponent (uint32_t node) const;
+
+        /////////////////////////////////////////////////////////////////////
+        /// isConnected - check if nodes are placed in one component
+        ///
+        /// @param first - index of the first node
+        /// @param second - index of the second node
+        ///
+        /// @return - false if there is no way between nodes
+        /////////////////////////////////////////////////////////////////////
+        bool isConnected (uint32_t first, uint32_t second) const;
+
+        /////////////////////////////////////////////////////////////////////
+        /// getSectorBegin - get index of the first node of sector
+        ///
+        /// Nodes of one sector have consecutive indices
+        /// [getSectorBegin (id), getSectorEnd (id)).
+        ///
+        /// @param sector_id - id of sector
+        ///
+        /// @return - index of node
+        /////////////////////////////////////////////////////////////////////
+        uint32_t getSectorBegin (uint32_t sector_id) const;
+
+        uint32_t getSectorEnd (uint32_t sector_id) const;
+
+        Vector2f getPosition (uint32_t node) const;
+
+        float getRadius (uint32_t node) const;
+
+        uint32_t getEdgeBegin (uint32_t node) const;
+
+        uint32_t getEdgeEnd (uint32_t node) const;
+
+        uint32_t getEdgeTarget (uint32_t edge) const;
+
+        float getEdgeCost (uint32_t edge) const;
+
+    private:
+        void reset ();
+
+        void findComponents ();
+
+        uint32_t findNode (const WayPoint* point) const;
+
+        void recordChanges (
+            const std::vector<uint32_t>& old_offsets,
+            const std::vector<uint32_t>& old_targets,
+            const std::vector<Vector2f>& old_positions,
+            const std::unordered_map<uint32_t, std::pair<uint32_t, uint32_t>>& old_ranges
+        );
+
+    private:
+        std::vector<uint32_t> m_edge_offsets;
+        std::vector<uint32_t> m_edge_targets;
+        std::vector<float> m_edge_costs;
+
+        std::vector<Vector2f> m_positions;
+        std::vector<float> m_radiuses;
+        std::vector<uint32_t> m_node_sectors;
+        std::vector<uint32_t> m_components;
+
+        std::unordered_map<uint32_t, std::pair<uint32_t, uint32_t>> m_sector_ranges;
+        std::vector<std::pair<const WayPoint*, uint32_t>> m_point_ranges;
+
+        uint32_t m_version = 0;
+        uint32_t m_layout_version = 0;
+        std::vector<std::pair<uint32_t, uint32_t>> m_changes;
+    };
+
+
+}
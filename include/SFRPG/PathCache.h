@@ -0,0 +1,168 @@
+/////////////////////////////////////////////////////////////////////
+//
+// SFGE - Simple and Fast Game Engine
+//
+// Copyright (c) 2016-2017 DonRumata710 
+// 
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation
+// files (the "Software"), to deal in the Software without
+// restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+// WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+// 
+/////////////////////////////////////////////////////////////////////
+
+
+#pragma once
+
+
+#include "WayPoint.h"
+
+#include <SFML/System/Vector2.hpp>
+
+#include <deque>
+#include <list>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <cstdint>
+
+
+namespace sfge
+{
+
+
+    using sf::Vector2f;
+
+
+    /////////////////////////////////////////////////////////////////////
+    /// PathCache - LRU cache of found ways between way points
+    ///
+    /// Every stored way remembers sectors which it passes through, so
+    /// changes of one sector drop only ways which depend on it.
+    /////////////////////////////////////////////////////////////////////
+    class PathCache
+    {
+    public:
+        typedef std::deque<Vector2f> WayPoints;
+
+        /////////////////////////////////////////////////////////////////////
+        /// Constructor
+        ///
+        /// @param capacity - max number of stored ways
+        /////////////////////////////////////////////////////////////////////
+        explicit PathCache (size_t capacity = 256);
+
+        /////////////////////////////////////////////////////////////////////
+        /// setCapacity - set max number of stored ways
+        ///
+        /// Zero capacity disables cache.
+        ///
+        /// @param capacity - max number of stored ways
+        /////////////////////////////////////////////////////////////////////
+        void setCapacity (size_t capacity);
+
+        size_t getCapacity () const;
+
+        size_t getSize () const;
+
+        /////////////////////////////////////////////////////////////////////
+        /// find - find stored way and mark it as recently used
+        ///
+        /// @param departure - departure way point
+        /// @param target - target way point
+        ///
+        /// @return - pointer to way or nullptr if there is no such way
+        /////////////////////////////////////////////////////////////////////
+        const WayPoints* find (const WayPointID& departure, const WayPointID& target);
+
+        /////////////////////////////////////////////////////////////////////
+        /// insert - store way
+        ///
+        /// @param departure - departure way point
+        /// @param target - target way point
+        /// @param points - points of way
+        /// @param sectors - ids of sectors which way passes through
+        /////////////////////////////////////////////////////////////////////
+        void insert (const WayPointID& departure, const WayPointID& target, const WayPoints& points, const std::vector<uint32_t>& sectors);
+
+        /////////////////////////////////////////////////////////////////////
+        /// invalidateSector - remove ways which pass through sector
+        ///
+        /// @param sector_id - id of sector
+        /////////////////////////////////////////////////////////////////////
+        void invalidateSector (uint32_t sector_id);
+
+        /////////////////////////////////////////////////////////////////////
+        /// clear - remove all ways
+        /////////////////////////////////////////////////////////////////////
+        void clear ();
+
+        /////////////////////////////////////////////////////////////////////
+        /// getHits - get number of successful searches in cache
+        ///
+        /// @return - number of hits
+        /////////////////////////////////////////////////////////////////////
+        uint64_t getHits () const;
+
+        /////////////////////////////////////////////////////////////////////
+        /// getMisses - get number of failed searches in cache
+        ///
+        /// @return - number of misses
+        /////////////////////////////////////////////////////////////////////
+        uint64_t getMisses () const;
+
+        void resetCounters ();
+
+    private:
+        struct Key
+        {
+            WayPointID departure;
+            WayPointID target;
+
+            bool operator== (const Key& key) const;
+        };
+
+        struct KeyHash
+        {
+            size_t operator() (const Key& key) const;
+        };
+
+        struct Entry
+        {
+            Key key;
+            WayPoints points;
+            std::vector<uint32_t> sectors;
+        };
+
+        typedef std::list<Entry>::iterator EntryIterator;
+
+        void erase (EntryIterator entry);
+
+    private:
+        size_t m_capacity;
+
+        std::list<Entry> m_entries;
+        std::unordered_map<Key, EntryIterator, KeyHash> m_index;
+        std::unordered_map<uint32_t, std::unordered_set<Key, KeyHash>> m_sector_ways;
+
+        uint64_t m_hits = 0;
+        uint64_t m_misses = 0;
+    };
+
+
+}
@@ -0,0 +1,170 @@
+/////////////////////////////////////////////////////////////////////
+//
+// SFGE - Simple and Fast Game Engine
+//
+// Copyright (c) 2016-2017 DonRumata710 
+// 
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation
+// files (the "Software"), to deal in the Software without
+// restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+// WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+// 
+/////////////////////////////////////////////////////////////////////
+
+
+#pragma once
+
+
+#include "IndexedHeap.h"
+
+#include <SFML/System/Vector2.hpp>
+
+#include <vector>
+#include <cstdint>
+
+
+namespace sfge
+{
+
+
+    using sf::Vector2f;
+
+    class NavigationGraph;
+
+
+    /////////////////////////////////////////////////////////////////////
+    /// PathFinder - A* search over navigation graph
+    ///
+    /// Object keeps scratch buffers between queries, so repeated
+    /// searches over graph of the same size don't allocate memory.
+    /// Search can be run to completion by findPath or step by step:
+    /// start it and then expand limited number of nodes per call.
+    /// One object should be used by one thread at a time.
+    /////////////////////////////////////////////////////////////////////
+    class PathFinder
+    {
+    public:
+        enum class State
+        {
+            PENDING,
+            COMPLETE,
+            FAILED
+        };
+
+        /////////////////////////////////////////////////////////////////////
+        /// findPath - find the shortest path between two nodes
+        ///
+        /// @param graph - navigation graph
+        /// @param departure - index of departure node
+        /// @param target - index of target node
+        /// @param path - nodes of found path from departure to target
+        ///
+        /// @return - true if path was found, false otherwise
+        /////////////////////////////////////////////////////////////////////
+        bool findPath (const NavigationGraph& graph, uint32_t departure, uint32_t target, std::vector<uint32_t>& path);
+
+        /////////////////////////////////////////////////////////////////////
+        /// findPath - find the shortest path which lies in given sectors
+        ///
+        /// @param graph - navigation graph
+        /// @param departure - index of departure node
+        /// @param target - index of target node
+        /// @param sectors - sorted ids of sectors which can be passed
+        /// @param path - nodes of found path from departure to target
+        ///
+        /// @return - true if path was found, false otherwise
+        /////////////////////////////////////////////////////////////////////
+        bool findPath (
+            const NavigationGraph& graph,
+            uint32_t departure,
+            uint32_t target,
+            const std::vector<uint32_t>& sectors,
+            std::vector<uint32_t>& path
+        );
+
+        /////////////////////////////////////////////////////////////////////
+        /// start - start step by step search
+        ///
+        /// @param graph - navigation graph
+        /// @param departure - index of departure node
+        /// @param target - index of target node
+        /////////////////////////////////////////////////////////////////////
+        void start (const NavigationGraph& graph, uint32_t departure, uint32_t target);
+
+        /////////////////////////////////////////////////////////////////////
+        /// start - start step by step search inside given sectors
+        ///
+        /// @param graph - navigation graph
+        /// @param departure - index of departure node
+        /// @param target - index of target node
+        /// @param sectors - sorted ids of sectors which can be passed
+        /////////////////////////////////////////////////////////////////////
+        void start (const NavigationGraph& graph, uint32_t departure, uint32_t target, const std::vector<uint32_t>& sectors);
+
+        /////////////////////////////////////////////////////////////////////
+        /// expand - continue started search
+        ///
+        /// Graph must be the same as graph which search was started for.
+        ///
+        /// @param graph - navigation graph
+        /// @param max_nodes - max number of nodes which can be expanded
+        ///
+        /// @return - state of search
+        /////////////////////////////////////////////////////////////////////
+        State expand (const NavigationGraph& graph, size_t max_nodes);
+
+        State getState () const;
+
+        /////////////////////////////////////////////////////////////////////
+        /// isVisited - check is node in open or closed set of search
+        ///
+        /// @param node - index of node
+        ///
+        /// @return - true if node was reached by current search
+        /////////////////////////////////////////////////////////////////////
+        bool isVisited (uint32_t node) const;
+
+        /////////////////////////////////////////////////////////////////////
+        /// getPath - get path found by completed search
+        ///
+        /// @param path - nodes of path from departure to target
+        /////////////////////////////////////////////////////////////////////
+        void getPath (std::vector<uint32_t>& path) const;
+
+    private:
+        void prepare (const NavigationGraph& graph, uint32_t departure, uint32_t target);
+
+    private:
+        IndexedHeap m_opened;
+
+        std::vector<float> m_passed_dist;
+        std::vector<uint32_t> m_parents;
+        std::vector<uint32_t> m_visit_marks;
+        std::vector<uint32_t> m_close_marks;
+
+        uint32_t m_generation = 0;
+
+        State m_state = State::FAILED;
+        uint32_t m_target = UINT32_MAX;
+        Vector2f m_target_pos;
+        bool m_use_sectors = false;
+        std::vector<uint32_t> m_sectors;
+    };
+
+
+}
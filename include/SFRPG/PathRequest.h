@@ -0,0 +1,138 @@
+/////////////////////////////////////////////////////////////////////
+//
+// SFGE - Simple and Fast Game Engine
+//
+// Copyright (c) 2016-2017 DonRumata710 
+// 
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation
+// files (the "Software"), to deal in the Software without
+// restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+// WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+// 
+/////////////////////////////////////////////////////////////////////
+
+
+#pragma once
+
+
+#include "PathFinder.h"
+#include "PortalGraph.h"
+#include "WayPoint.h"
+
+#include <SFML/System/Time.hpp>
+#include <SFML/System/Vector2.hpp>
+
+#include <deque>
+#include <vector>
+#include <cstdint>
+
+
+namespace sfge
+{
+
+
+    using sf::Vector2f;
+
+    class MapManager;
+    class Way;
+
+
+    /////////////////////////////////////////////////////////////////////
+    /// PathRequest - way search which is spread over several frames
+    ///
+    /// Request keeps state of search between calls of update and
+    /// expands only limited number of nodes per call. Search is started
+    /// again only if navigation graph is changed in nodes which search
+    /// has already reached or in sectors of its corridor.
+    /////////////////////////////////////////////////////////////////////
+    class PathRequest
+    {
+    public:
+        typedef PathFinder::State State;
+
+        /////////////////////////////////////////////////////////////////////
+        /// Constructor
+        ///
+        /// @param manager - map manager where way is searched
+        /// @param departure - departure point
+        /// @param target - target point
+        /////////////////////////////////////////////////////////////////////
+        PathRequest (const MapManager* manager, Vector2f departure, Vector2f target);
+
+        /////////////////////////////////////////////////////////////////////
+        /// update - continue search
+        ///
+        /// Corridor of hierarchical search is found by the first update
+        /// after start and expanded portals and way points are counted
+        /// against max_nodes.
+        ///
+        /// @param max_nodes - max number of nodes which can be expanded
+        /// @param max_time - max time of search, zero means no limit
+        ///
+        /// @return - state of request
+        /////////////////////////////////////////////////////////////////////
+        State update (size_t max_nodes, sf::Time max_time = sf::Time::Zero);
+
+        /////////////////////////////////////////////////////////////////////
+        /// getState - get state of request
+        ///
+        /// @return - PENDING while search isn't finished, COMPLETE if way
+        /// was found and FAILED if there is no way
+        /////////////////////////////////////////////////////////////////////
+        State getState () const;
+
+        /////////////////////////////////////////////////////////////////////
+        /// getWay - get found way
+        ///
+        /// @return - found way or empty way if request isn't complete
+        /////////////////////////////////////////////////////////////////////
+        Way getWay () const;
+
+    private:
+        void restart ();
+
+        bool isSearchChanged ();
+
+        bool findCorridor ();
+
+        void finish ();
+
+    private:
+        const MapManager* m_manager;
+
+        Vector2f m_departure;
+        Vector2f m_target;
+        WayPointID m_departure_point;
+        WayPointID m_target_point;
+
+        uint32_t m_graph_version = 0;
+        std::vector<uint32_t> m_changed_nodes;
+        uint32_t m_departure_node = 0;
+        uint32_t m_target_node = 0;
+        bool m_corridor_pending = false;
+        State m_state = State::PENDING;
+
+        PathFinder m_path_finder;
+        PortalGraph::Search m_portal_search;
+        std::vector<uint32_t> m_corridor;
+        std::vector<uint32_t> m_path;
+        std::deque<Vector2f> m_points;
+    };
+
+
+}
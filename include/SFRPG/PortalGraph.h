@@ -0,0 +1,168 @@
+/////////////////////////////////////////////////////////////////////
+//
+// SFGE - Simple and Fast Game Engine
+//
+// Copyright (c) 2016-2017 DonRumata710 
+// 
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation
+// files (the "Software"), to deal in the Software without
+// restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+// WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+// 
+/////////////////////////////////////////////////////////////////////
+
+
+#pragma once
+
+
+#include "IndexedHeap.h"
+
+#include <vector>
+#include <utility>
+#include <cstdint>
+
+
+namespace sfge
+{
+
+
+    class NavigationGraph;
+
+
+    /////////////////////////////////////////////////////////////////////
+    /// PortalGraph - abstract graph of sectors for hierarchical search
+    ///
+    /// Portals are way points which have edges to way points of another
+    /// sectors. Portals of one sector are connected with each other by
+    /// precomputed shortest distances inside the sector. Search over
+    /// portals gives corridor of sectors which should be refined by
+    /// search over navigation graph.
+    /////////////////////////////////////////////////////////////////////
+    class PortalGraph
+    {
+    public:
+        /////////////////////////////////////////////////////////////////////
+        /// Search - scratch buffers of corridor search
+        ///
+        /// One object should be used by one thread at a time. Many threads
+        /// can search corridors over the same portal graph with their own
+        /// Search objects.
+        /////////////////////////////////////////////////////////////////////
+        class Search
+        {
+        public:
+            /////////////////////////////////////////////////////////////////////
+            /// getExpandedNodes - get number of way points and portals which
+            /// were expanded by the last search
+            ///
+            /// @return - number of nodes
+            /////////////////////////////////////////////////////////////////////
+            size_t getExpandedNodes () const;
+
+        private:
+            friend class PortalGraph;
+
+            void findSectorDistances (const NavigationGraph& graph, uint32_t source);
+
+            float getSectorDistance (uint32_t node) const;
+
+            uint32_t nextGeneration ();
+
+        private:
+            IndexedHeap m_heap;
+            uint32_t m_generation = 0;
+            size_t m_expanded = 0;
+            uint32_t m_sector_begin = 0;
+
+            std::vector<float> m_distances;
+            std::vector<uint32_t> m_marks;
+
+            std::vector<float> m_costs;
+            std::vector<uint32_t> m_cost_marks;
+            std::vector<uint32_t> m_parents;
+
+            std::vector<std::pair<uint32_t, float>> m_start_edges;
+            std::vector<float> m_goal_distances;
+            std::vector<uint32_t> m_goal_marks;
+        };
+
+        /////////////////////////////////////////////////////////////////////
+        /// build - find portals and distances between them
+        ///
+        /// @param graph - navigation graph
+        /////////////////////////////////////////////////////////////////////
+        void build (const NavigationGraph& graph);
+
+        /////////////////////////////////////////////////////////////////////
+        /// update - find portals again after edges of some sectors were
+        /// changed
+        ///
+        /// Distances between portals are found again only in changed
+        /// sectors, distances of other sectors are copied. Graph is built
+        /// from scratch if layout of nodes was changed.
+        ///
+        /// @param graph - navigation graph
+        /// @param sectors - ids of sectors which edges were changed
+        /////////////////////////////////////////////////////////////////////
+        void update (const NavigationGraph& graph, const std::vector<uint32_t>& sectors);
+
+        /////////////////////////////////////////////////////////////////////
+        /// clear - remove all portals
+        /////////////////////////////////////////////////////////////////////
+        void clear ();
+
+        /////////////////////////////////////////////////////////////////////
+        /// getPortalCount - get number of portals
+        ///
+        /// @return - number of portals
+        /////////////////////////////////////////////////////////////////////
+        size_t getPortalCount () const;
+
+        /////////////////////////////////////////////////////////////////////
+        /// findCorridor - find sectors which way between two nodes passes
+        ///
+        /// @param graph - navigation graph which portal graph was built for
+        /// @param departure - index of departure node
+        /// @param target - index of target node
+        /// @param sectors - sorted ids of sectors
+        /// @param search - scratch buffers
+        ///
+        /// @return - true if nodes are connected, false otherwise
+        /////////////////////////////////////////////////////////////////////
+        bool findCorridor (
+            const NavigationGraph& graph,
+            uint32_t departure,
+            uint32_t target,
+            std::vector<uint32_t>& sectors,
+            Search& search
+        ) const;
+
+    private:
+        void connectPortals (const NavigationGraph& graph, const std::vector<uint32_t>* sectors);
+
+    private:
+        std::vector<uint32_t> m_portal_nodes;
+        std::vector<uint32_t> m_node_portals;
+
+        std::vector<uint32_t> m_edge_offsets;
+        std::vector<uint32_t> m_edge_targets;
+        std::vector<float> m_edge_costs;
+    };
+
+
+}
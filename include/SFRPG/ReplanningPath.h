@@ -0,0 +1,159 @@
+/////////////////////////////////////////////////////////////////////
+//
+// SFGE - Simple and Fast Game Engine
+//
+// Copyright (c) 2016-2017 DonRumata710 
+// 
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation
+// files (the "Software"), to deal in the Software without
+// restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+// WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+// 
+/////////////////////////////////////////////////////////////////////
+
+
+#pragma once
+
+
+#include "IndexedHeap.h"
+#include "WayPoint.h"
+
+#include <SFML/System/Vector2.hpp>
+
+#include <vector>
+#include <cstdint>
+
+
+namespace sfge
+{
+
+
+    using sf::Vector2f;
+
+    class MapManager;
+    class NavigationGraph;
+    class Way;
+
+
+    /////////////////////////////////////////////////////////////////////
+    /// ReplanningPath - way which is repaired after changes of map
+    ///
+    /// Way is searched by D* Lite from target to departure. Distances
+    /// to target are kept between updates, so after obstacles of
+    /// sectors are changed only nodes affected by changed edges are
+    /// expanded again. Departure may be moved along the way and target
+    /// may be moved to any point without full search.
+    /////////////////////////////////////////////////////////////////////
+    class ReplanningPath
+    {
+    public:
+        /////////////////////////////////////////////////////////////////////
+        /// Constructor
+        ///
+        /// @param manager - map manager where way is searched
+        /////////////////////////////////////////////////////////////////////
+        ReplanningPath (const MapManager* manager);
+
+        /////////////////////////////////////////////////////////////////////
+        /// setDeparture - set departure point
+        ///
+        /// @param departure - current position of object
+        /////////////////////////////////////////////////////////////////////
+        void setDeparture (Vector2f departure);
+
+        Vector2f getDeparture () const;
+
+        /////////////////////////////////////////////////////////////////////
+        /// setTarget - set target point
+        ///
+        /// @param target - target point
+        /////////////////////////////////////////////////////////////////////
+        void setTarget (Vector2f target);
+
+        Vector2f getTarget () const;
+
+        /////////////////////////////////////////////////////////////////////
+        /// update - repair way after changes of map, departure or target
+        ///
+        /// Search starts from scratch only if sectors of map were loaded
+        /// or unloaded since previous update.
+        ///
+        /// @return - false if there is no way
+        /////////////////////////////////////////////////////////////////////
+        bool update ();
+
+        /////////////////////////////////////////////////////////////////////
+        /// getWay - get way from departure to target
+        ///
+        /// @return - way found by last update or empty way if there is
+        /// no path
+        /////////////////////////////////////////////////////////////////////
+        Way getWay () const;
+
+        /////////////////////////////////////////////////////////////////////
+        /// getExpandedNodes - get number of nodes expanded by last update
+        ///
+        /// @return - number of nodes
+        /////////////////////////////////////////////////////////////////////
+        size_t getExpandedNodes () const;
+
+    private:
+        struct Key
+        {
+            float first;
+            float second;
+
+            bool operator< (const Key& other) const;
+        };
+
+        void restart (const NavigationGraph& graph);
+
+        void applyChanges (const NavigationGraph& graph, const std::vector<uint32_t>& nodes);
+
+        void updateNode (const NavigationGraph& graph, uint32_t node);
+
+        void computeShortestPath (const NavigationGraph& graph);
+
+        Key calculateKey (const NavigationGraph& graph, uint32_t node) const;
+
+        float getHeuristic (const NavigationGraph& graph, uint32_t node) const;
+
+    private:
+        const MapManager* m_manager;
+
+        Vector2f m_departure;
+        Vector2f m_target;
+
+        uint32_t m_start = UINT32_MAX;
+        uint32_t m_last_start = UINT32_MAX;
+        uint32_t m_goal = UINT32_MAX;
+        bool m_found = false;
+
+        uint32_t m_graph_version = 0;
+        bool m_initialized = false;
+        float m_key_modifier = 0.0f;
+        size_t m_expanded_nodes = 0;
+
+        std::vector<float> m_distances;
+        std::vector<float> m_estimations;
+        IndexedHeap m_opened;
+        std::vector<uint32_t> m_changed_nodes;
+    };
+
+
+}
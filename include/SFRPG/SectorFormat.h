@@ -0,0 +1,251 @@
+/////////////////////////////////////////////////////////////////////
+//
+// SFGE - Simple and Fast Game Engine
+//
+// Copyright (c) 2016-2017 DonRumata710 
+// 
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation
+// files (the "Software"), to deal in the Software without
+// restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+// WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+// 
+/////////////////////////////////////////////////////////////////////
+
+
+#pragma once
+
+
+#include "Collision.h"
+#include "WayPoint.h"
+
+#include <SFGE/DataOutputStream.h>
+
+#include <SFML/System/Vector2.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+namespace sfge
+{
+
+
+    using sf::Vector2u;
+
+
+    /////////////////////////////////////////////////////////////////////
+    /// SectorData - content of sector file which doesn't need textures
+    /////////////////////////////////////////////////////////////////////
+    struct SectorData
+    {
+        std::string name;                                       // name of sector
+        Vector2u size;                                          // size of sector in tiles
+        uint32_t tile_size = 0;                                 // size of tile in pixels
+        std::vector<std::string> palette { std::string () };    // textures of tiles, the first one means no texture
+        std::vector<uint16_t> tiles;                            // index in palette for every tile, row by row
+        std::vector<WayPoint> way_points;                       // positions are relative to sector
+        std::vector<Collision> objects;                         // static obstacles, positions are relative to sector
+    };
+
+
+    /////////////////////////////////////////////////////////////////////
+    /// SectorFormat - read and write files of sectors
+    ///
+    /// Sector can be kept in text file which is parsed by tokens or in
+    /// binary file which is used in place without parsing. Both formats
+    /// have the same sections, so they can be converted to each other.
+    ///
+    /// Binary file is a header followed by sections. Offsets of sections
+    /// are counted from the start of file and aligned by 4 bytes, all
+    /// numbers are little endian:
+    ///     palette     - offsets of texture names in string table
+    ///     strings     - null-terminated names of sector and textures
+    ///     tiles       - 16 bit palette index of every tile, row by row
+    ///     way points  - x, y and radius of every way point
+    ///     objects     - position and range of points of every obstacle
+    ///     points      - x and y of every point of obstacles
+    /////////////////////////////////////////////////////////////////////
+    class SectorFormat
+    {
+    public:
+        static const uint32_t VERSION = 1;
+
+        struct Header
+        {
+            char magic[4];
+            uint32_t version;
+            uint32_t width;
+            uint32_t height;
+            uint32_t tile_size;
+            uint32_t name;
+            uint32_t palette_count;
+            uint32_t palette_offset;
+            uint32_t strings_size;
+            uint32_t strings_offset;
+            uint32_t tiles_offset;
+            uint32_t way_points_count;
+            uint32_t way_points_offset;
+            uint32_t objects_count;
+            uint32_t objects_offset;
+            uint32_t points_count;
+            uint32_t points_offset;
+        };
+
+        struct WayPointRecord
+        {
+            float x;
+            float y;
+            float radius;
+        };
+
+        struct ObjectRecord
+        {
+            float x;
+            float y;
+            uint32_t first_point;
+            uint32_t points_count;
+        };
+
+        struct PointRecord
+        {
+            float x;
+            float y;
+        };
+
+        /////////////////////////////////////////////////////////////////////
+        /// isBinary - check does memory start with header of binary sector
+        ///
+        /// @param data - content of file
+        /// @param size - size of content
+        ///
+        /// @return - true if content should be read as binary sector
+        /////////////////////////////////////////////////////////////////////
+        static bool isBinary (const char* data, size_t size);
+
+        /////////////////////////////////////////////////////////////////////
+        /// readText - parse text file of sector
+        ///
+        /// @param text - null-terminated content of file
+        /// @param size - size of sector, it is found by positions of tiles
+        /// if it is empty
+        /// @param sector - content of sector
+        ///
+        /// @return - false if text can't be parsed
+        /////////////////////////////////////////////////////////////////////
+        static bool readText (const char* text, Vector2u size, SectorData& sector);
+
+        /////////////////////////////////////////////////////////////////////
+        /// writeText - write text file of sector
+        ///
+        /// @param stream - opened output stream
+        /// @param sector - content of sector
+        ///
+        /// @return - false if writing failed
+        /////////////////////////////////////////////////////////////////////
+        static bool writeText (iDataOutputStream* stream, const SectorData& sector);
+
+        /////////////////////////////////////////////////////////////////////
+        /// writeBinary - write binary file of sector
+        ///
+        /// @param stream - opened output stream
+        /// @param sector - content of sector
+        ///
+        /// @return - false if sector doesn't fit format or writing failed
+        /////////////////////////////////////////////////////////////////////
+        static bool writeBinary (iDataOutputStream* stream, const SectorData& sector);
+    };
+
+
+    /////////////////////////////////////////////////////////////////////
+    /// BinarySector - view of binary file of sector
+    ///
+    /// View doesn't copy memory, so memory must live while view is used.
+    /// Layout has no pointers, so file may be mapped to memory and used
+    /// as it is.
+    /////////////////////////////////////////////////////////////////////
+    class BinarySector
+    {
+    public:
+        /////////////////////////////////////////////////////////////////////
+        /// open - check header and sections of file
+        ///
+        /// Memory must be aligned by 4 bytes.
+        ///
+        /// @param data - content of file
+        /// @param size - size of content
+        ///
+        /// @return - false if memory doesn't contain valid binary sector
+        /////////////////////////////////////////////////////////////////////
+        bool open (const char* data, size_t size);
+
+        const char* getName () const;
+
+        Vector2u getSize () const;
+
+        uint32_t getTileSize () const;
+
+        uint32_t getPaletteSize () const;
+
+        /////////////////////////////////////////////////////////////////////
+        /// getTexture - get name of texture from palette
+        ///
+        /// @param id - index in palette
+        ///
+        /// @return - name of texture, empty for the first index
+        /////////////////////////////////////////////////////////////////////
+        const char* getTexture (uint32_t id) const;
+
+        /////////////////////////////////////////////////////////////////////
+        /// getTiles - get palette indices of tiles
+        ///
+        /// Indices aren't checked by open, so they should be compared with
+        /// size of palette.
+        ///
+        /// @return - index of every tile, row by row
+        /////////////////////////////////////////////////////////////////////
+        const uint16_t* getTiles () const;
+
+        uint32_t getWayPointsCount () const;
+
+        WayPoint getWayPoint (uint32_t id) const;
+
+        uint32_t getObjectsCount () const;
+
+        Collision getObject (uint32_t id) const;
+
+        /////////////////////////////////////////////////////////////////////
+        /// read - copy content of file
+        ///
+        /// @param sector - content of sector
+        /////////////////////////////////////////////////////////////////////
+        void read (SectorData& sector) const;
+
+    private:
+        bool checkSection (uint32_t offset, uint64_t size) const;
+
+        template <typename T> const T* getSection (uint32_t offset) const;
+
+    private:
+        const char* m_data = nullptr;
+        size_t m_size = 0;
+        SectorFormat::Header m_header;
+    };
+
+
+}
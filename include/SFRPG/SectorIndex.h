@@ -0,0 +1,134 @@
+/////////////////////////////////////////////////////////////////////
+//
+// SFGE - Simple and Fast Game Engine
+//
+// Copyright (c) 2016-2017 DonRumata710 
+// 
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation
+// files (the "Software"), to deal in the Software without
+// restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+// WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+// 
+/////////////////////////////////////////////////////////////////////
+
+
+#pragma once
+
+
+#include "MapSectorDesc.h"
+
+#include <SFML/Graphics/Rect.hpp>
+#include <SFML/System/Vector2.hpp>
+
+#include <unordered_map>
+#include <vector>
+#include <cstdint>
+
+
+namespace sfge
+{
+
+
+    using sf::Vector2f;
+    using sf::FloatRect;
+    typedef sf::Rect<uint32_t> UintRect;
+
+
+    /////////////////////////////////////////////////////////////////////
+    /// SectorIndex - spatial index of sector descriptions
+    ///
+    /// Sectors are stored in cells of unbounded hashed grid, so sparse
+    /// worlds don't pay for empty space. Side of cell is the mean side of
+    /// sectors, so usual sector covers a few cells. Queries use
+    /// coordinates of map description and return sorted ids of sectors
+    /// whether they are loaded or not.
+    /////////////////////////////////////////////////////////////////////
+    class SectorIndex
+    {
+    public:
+        /////////////////////////////////////////////////////////////////////
+        /// build - index descriptions of sectors
+        ///
+        /// @param sectors - sectors of map
+        /////////////////////////////////////////////////////////////////////
+        void build (const std::unordered_map<uint32_t, MapSectorDesc>& sectors);
+
+        /////////////////////////////////////////////////////////////////////
+        /// clear - remove all sectors
+        /////////////////////////////////////////////////////////////////////
+        void clear ();
+
+        uint32_t getCellSize () const;
+
+        /////////////////////////////////////////////////////////////////////
+        /// queryPoint - find sectors which contain point
+        ///
+        /// @param point - point in coordinates of map description
+        /// @param ids - ids of sectors which contain point or have it on
+        /// border
+        /////////////////////////////////////////////////////////////////////
+        void queryPoint (Vector2f point, std::vector<uint32_t>& ids) const;
+
+        /////////////////////////////////////////////////////////////////////
+        /// queryRect - find sectors which overlap area
+        ///
+        /// @param area - area in coordinates of map description
+        /// @param ids - ids of sectors which have common inner part with area
+        /////////////////////////////////////////////////////////////////////
+        void queryRect (const UintRect& area, std::vector<uint32_t>& ids) const;
+
+        /////////////////////////////////////////////////////////////////////
+        /// queryRect - find sectors which touch area
+        ///
+        /// @param area - area in coordinates of map description
+        /// @param ids - ids of sectors which overlap area or touch its border
+        /////////////////////////////////////////////////////////////////////
+        void queryRect (const FloatRect& area, std::vector<uint32_t>& ids) const;
+
+        /////////////////////////////////////////////////////////////////////
+        /// queryNeighbours - find sectors which touch sector
+        ///
+        /// @param id - id of sector
+        /// @param ids - ids of sectors which overlap sector or have common
+        /// border with it, sector itself isn't included
+        /////////////////////////////////////////////////////////////////////
+        void queryNeighbours (uint32_t id, std::vector<uint32_t>& ids) const;
+
+    private:
+        struct Bounds
+        {
+            uint64_t left;
+            uint64_t top;
+            uint64_t right;
+            uint64_t bottom;
+        };
+
+        template <typename Check> void query (const Bounds& cells, Check check, std::vector<uint32_t>& ids) const;
+
+        Bounds getCells (const Bounds& bounds) const;
+
+        static uint64_t getKey (uint64_t column, uint64_t row);
+
+    private:
+        uint32_t m_cell_size = 1;
+        std::unordered_map<uint32_t, Bounds> m_bounds;
+        std::unordered_map<uint64_t, std::vector<uint32_t>> m_cells;
+    };
+
+
+}
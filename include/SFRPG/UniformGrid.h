@@ -0,0 +1,161 @@
+/////////////////////////////////////////////////////////////////////
+//
+// SFGE - Simple and Fast Game Engine
+//
+// Copyright (c) 2016-2017 DonRumata710 
+// 
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation
+// files (the "Software"), to deal in the Software without
+// restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+// WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+// 
+/////////////////////////////////////////////////////////////////////
+
+
+#pragma once
+
+
+#include <SFML/Graphics/Rect.hpp>
+#include <SFML/System/Vector2.hpp>
+
+#include <vector>
+#include <cstdint>
+
+
+namespace sfge
+{
+
+
+    using sf::Vector2f;
+    using sf::FloatRect;
+
+
+    /////////////////////////////////////////////////////////////////////
+    /// UniformGrid - spatial index which splits area into square cells
+    ///
+    /// Every item is stored in all cells which are overlapped by its
+    /// bounds. Items and queries outside area are clamped to border
+    /// cells, so nothing is lost.
+    /////////////////////////////////////////////////////////////////////
+    class UniformGrid
+    {
+    public:
+        /////////////////////////////////////////////////////////////////////
+        /// reset - remove all items and set new area
+        ///
+        /// @param area - covered area
+        /// @param cell_size - size of cell side
+        /// @param max_cells - max number of cells along one side
+        /////////////////////////////////////////////////////////////////////
+        void reset (const FloatRect& area, float cell_size, uint32_t max_cells = 256);
+
+        /////////////////////////////////////////////////////////////////////
+        /// clear - remove all items and keep area
+        /////////////////////////////////////////////////////////////////////
+        void clear ();
+
+        /////////////////////////////////////////////////////////////////////
+        /// move - shift area with all items
+        ///
+        /// @param offset - shift
+        /////////////////////////////////////////////////////////////////////
+        void move (Vector2f offset);
+
+        FloatRect getArea () const;
+
+        float getCellSize () const;
+
+        /////////////////////////////////////////////////////////////////////
+        /// getMemoryUsage - get number of bytes allocated by cells
+        ///
+        /// @return - number of bytes
+        /////////////////////////////////////////////////////////////////////
+        size_t getMemoryUsage () const;
+
+        /////////////////////////////////////////////////////////////////////
+        /// insert - add item to all cells overlapped by bounds
+        ///
+        /// @param id - id of item
+        /// @param bounds - bounding rectangle of item
+        /////////////////////////////////////////////////////////////////////
+        void insert (uint32_t id, const FloatRect& bounds);
+
+        /////////////////////////////////////////////////////////////////////
+        /// remove - remove item from cells
+        ///
+        /// @param id - id of item
+        /// @param bounds - the same bounds which were used for insert
+        /////////////////////////////////////////////////////////////////////
+        void remove (uint32_t id, const FloatRect& bounds);
+
+        /////////////////////////////////////////////////////////////////////
+        /// update - move item to cells overlapped by new bounds
+        ///
+        /// Only cells which are covered by one of bounds are changed, so
+        /// small movement inside the same cells is cheap.
+        ///
+        /// @param id - id of item
+        /// @param old_bounds - the same bounds which were used for insert
+        /// @param new_bounds - new bounding rectangle of item
+        /////////////////////////////////////////////////////////////////////
+        void update (uint32_t id, const FloatRect& old_bounds, const FloatRect& new_bounds);
+
+        /////////////////////////////////////////////////////////////////////
+        /// getCell - get items of cell which contains point
+        ///
+        /// Items are placed in order of insertion.
+        ///
+        /// @param point - point
+        ///
+        /// @return - ids of items
+        /////////////////////////////////////////////////////////////////////
+        const std::vector<uint32_t>& getCell (Vector2f point) const;
+
+        /////////////////////////////////////////////////////////////////////
+        /// query - get items of all cells overlapped by rectangle
+        ///
+        /// @param rect - rectangle
+        /// @param ids - sorted ids of items without duplicates
+        /////////////////////////////////////////////////////////////////////
+        void query (const FloatRect& rect, std::vector<uint32_t>& ids) const;
+
+        /////////////////////////////////////////////////////////////////////
+        /// querySegment - get items of all cells crossed by segment
+        ///
+        /// @param p1 - the first point of segment
+        /// @param p2 - the second point of segment
+        /// @param ids - sorted ids of items without duplicates
+        /////////////////////////////////////////////////////////////////////
+        void querySegment (Vector2f p1, Vector2f p2, std::vector<uint32_t>& ids) const;
+
+    private:
+        uint32_t getColumn (float x) const;
+
+        uint32_t getRow (float y) const;
+
+    private:
+        FloatRect m_area;
+        float m_cell_size = 1.0f;
+        uint32_t m_columns = 0;
+        uint32_t m_rows = 0;
+
+        std::vector<std::vector<uint32_t>> m_cells;
+    };
+
+
+}
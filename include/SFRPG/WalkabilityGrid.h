@@ -0,0 +1,146 @@
+/////////////////////////////////////////////////////////////////////
+//
+// SFGE - Simple and Fast Game Engine
+//
+// Copyright (c) 2016-2017 DonRumata710 
+// 
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation
+// files (the "Software"), to deal in the Software without
+// restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+// WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+// 
+/////////////////////////////////////////////////////////////////////
+
+
+#pragma once
+
+
+#include <SFML/Graphics/Rect.hpp>
+#include <SFML/System/Vector2.hpp>
+
+#include <vector>
+#include <cstdint>
+
+
+namespace sfge
+{
+
+
+    using sf::Vector2f;
+    using sf::Vector2i;
+    using sf::FloatRect;
+
+    class Collision;
+
+
+    /////////////////////////////////////////////////////////////////////
+    /// WalkabilityGrid - bitmap of cells which can be passed
+    ///
+    /// Cells are squares placed from origin of grid. All cells outside
+    /// of grid are blocked.
+    /////////////////////////////////////////////////////////////////////
+    class WalkabilityGrid
+    {
+    public:
+        /////////////////////////////////////////////////////////////////////
+        /// reset - set new size and state of all cells
+        ///
+        /// @param origin - position of left top corner of grid
+        /// @param width - number of cells along x axis
+        /// @param height - number of cells along y axis
+        /// @param cell_size - size of cell side
+        /// @param walkable - initial state of cells
+        /////////////////////////////////////////////////////////////////////
+        void reset (Vector2f origin, uint32_t width, uint32_t height, float cell_size = 1.0f, bool walkable = true);
+
+        /////////////////////////////////////////////////////////////////////
+        /// move - shift grid
+        ///
+        /// @param offset - shift
+        /////////////////////////////////////////////////////////////////////
+        void move (Vector2f offset);
+
+        Vector2f getOrigin () const;
+
+        uint32_t getWidth () const;
+
+        uint32_t getHeight () const;
+
+        float getCellSize () const;
+
+        size_t getMemoryUsage () const;
+
+        bool isWalkable (int32_t x, int32_t y) const;
+
+        void setWalkable (int32_t x, int32_t y, bool walkable);
+
+        /////////////////////////////////////////////////////////////////////
+        /// getCell - get cell which contains point
+        ///
+        /// @param point - position on map
+        ///
+        /// @return - coordinates of cell, may be outside of grid
+        /////////////////////////////////////////////////////////////////////
+        Vector2i getCell (Vector2f point) const;
+
+        /////////////////////////////////////////////////////////////////////
+        /// getCellCenter - get position of center of cell
+        ///
+        /// @param cell - coordinates of cell
+        ///
+        /// @return - position on map
+        /////////////////////////////////////////////////////////////////////
+        Vector2f getCellCenter (Vector2i cell) const;
+
+        /////////////////////////////////////////////////////////////////////
+        /// rasterize - block all cells which are touched by collision
+        ///
+        /// @param collision - collision polygon
+        /////////////////////////////////////////////////////////////////////
+        void rasterize (const Collision& collision);
+
+        /////////////////////////////////////////////////////////////////////
+        /// clear - make all cells overlapped by area walkable
+        ///
+        /// @param area - area on map
+        /////////////////////////////////////////////////////////////////////
+        void clear (const FloatRect& area);
+
+        /////////////////////////////////////////////////////////////////////
+        /// copy - copy cells of another grid with the same cell size
+        ///
+        /// @param grid - source grid
+        /////////////////////////////////////////////////////////////////////
+        void copy (const WalkabilityGrid& grid);
+
+    private:
+        bool isInside (int32_t x, int32_t y) const;
+
+        void getCellRange (const FloatRect& area, Vector2i& first, Vector2i& last) const;
+
+    private:
+        Vector2f m_origin;
+        uint32_t m_width = 0;
+        uint32_t m_height = 0;
+        float m_cell_size = 1.0f;
+
+        std::vector<uint64_t> m_blocked;
+    };
+
+
+}
@@ -49,6 +49,14 @@ namespace sfge
 
         Way (WayPoints&& points);
 
+        Way (const Way& way);
+
+        Way (Way&& way);
+
+        Way& operator= (const Way& way);
+
+        Way& operator= (Way&& way);
+
         void clear ();
 
         void pushPointFront (Vector2f);
@@ -60,6 +68,8 @@ namespace sfge
 
         size_t getPoints () const;
 
+        bool isEmpty () const;
+
     protected:
         WayPoints m_points;
         WayIterator m_current_point;
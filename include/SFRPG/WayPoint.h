@@ -60,6 +60,16 @@ namespace sfge
 
         void assignEdges (const EdgeList& edges);
 
+        void addEdges (const EdgeList& edges);
+
+        void addEdge (const WayPoint* point);
+
+        void removeEdge (const WayPoint* point);
+
+        void removeEdges (const WayPoint* first, const WayPoint* last);
+
+        bool hasEdge (const WayPoint* point) const;
+
         const EdgeList& getEdges () const;
 
         void setPosition (Vector2f pos);
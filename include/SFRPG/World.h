@@ -48,6 +48,7 @@ namespace sfge
     using sf::Vector2f;
 
     class MapManager;
+    class iResourceInputStream;
 
 
     class World : public iWidget
@@ -86,6 +87,9 @@ namespace sfge
     private:
         std::shared_ptr<MapManager> m_map;
 
+        // Sectors of map are read from this stream after map is loaded
+        std::shared_ptr<iResourceInputStream> m_stream;
+
         RenderRect m_render_rect;
         Panel m_panel;
         sf::View m_view;